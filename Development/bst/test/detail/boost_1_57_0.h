@@ -43,6 +43,8 @@ PRAGMA_WARNING_POP
 //- Break BOOST_CHECK_THROW_IMPL in two so the statement can contain commas, etc.
 
 #define BST_TEST_CASE(symbol) BOOST_AUTO_TEST_CASE(symbol)
+// test case decorators are not available before Boost 1.59, so performance test cases are run by default
+#define BST_TEST_CASE_PERFORMANCE(symbol) BOOST_AUTO_TEST_CASE(symbol)
 #define BST_CHECK(expr) BOOST_CHECK(expr)
 #define BST_CHECK_EQUAL(expected, actual) BOOST_CHECK_EQUAL(expected, actual)
 #define BST_CHECK_NE(expected, actual) BOOST_CHECK_NE(expected, actual)
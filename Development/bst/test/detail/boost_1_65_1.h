@@ -48,6 +48,8 @@ do {
 //- Break BOOST_CHECK_THROW_IMPL in two so the statement can contain commas, etc.
 
 #define BST_TEST_CASE(symbol) BOOST_AUTO_TEST_CASE(symbol)
+// disabled, so only run when selected explicitly, e.g. by --run_test=@performance
+#define BST_TEST_CASE_PERFORMANCE(symbol) BOOST_AUTO_TEST_CASE(symbol, *boost::unit_test::label("performance") *boost::unit_test::disabled())
 #define BST_CHECK(expr) BOOST_CHECK(expr)
 #define BST_CHECK_EQUAL(expected, actual) BOOST_CHECK_EQUAL(expected, actual)
 #define BST_CHECK_NE(expected, actual) BOOST_CHECK_NE(expected, actual)
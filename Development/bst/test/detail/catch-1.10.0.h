@@ -227,6 +227,8 @@ PRAGMA_WARNING_POP
 //- Add "test templates" for Catch
 
 #define BST_TEST_CASE(symbol) CATCH_TEST_CASE(#symbol)
+// hidden, so only run when selected explicitly, e.g. by the "[performance]" tag
+#define BST_TEST_CASE_PERFORMANCE(symbol) CATCH_TEST_CASE(#symbol, "[.][performance]")
 #define BST_CHECK(expr) CATCH_CHECK(expr)
 #define BST_CHECK_EQUAL(expected, actual) CATCH_CHECK((expected) == (actual))
 #define BST_CHECK_NE(expected, actual) CATCH_CHECK((expected) != (actual))
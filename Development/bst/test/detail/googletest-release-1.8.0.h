@@ -79,6 +79,8 @@
 //- Tweak TYPED_TEST so we can give a custom name to the type parameter
 
 #define BST_TEST_CASE(symbol) TEST(bstTestCase, symbol)
+// disabled, so only run when selected explicitly, e.g. by --gtest_also_run_disabled_tests
+#define BST_TEST_CASE_PERFORMANCE(symbol) TEST(bstTestCase, DISABLED_##symbol)
 #define BST_CHECK(expr) EXPECT_TRUE(expr)
 #define BST_CHECK_EQUAL(expected, actual) EXPECT_EQ(expected, actual)
 #define BST_CHECK_NE(expected, actual) EXPECT_NE(expected, actual)
@@ -23,6 +23,7 @@
 
 // BST_TEST_CASE(symbol) - define and register a test case
 // BST_TEST_CASE_PRIVATE(symbol) - define and register a test case that requires private access
+// BST_TEST_CASE_PERFORMANCE(symbol) - define and register a test case that is not run by default, e.g. a benchmark
 // BST_TEMPLATE_TEST_CASE_{1..8}(symbol, T, T1, ...) - define and register a templated test case
 
 ////////////////////////////////////////////////////////////////////////////////////////////
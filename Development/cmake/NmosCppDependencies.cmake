@@ -162,6 +162,15 @@ if(${CMAKE_SYSTEM_NAME} STREQUAL "Linux" OR ${CMAKE_SYSTEM_NAME} STREQUAL "Darwi
         )
 endif()
 
+# zlib is required by the websocketpp permessage-deflate extension
+find_package(ZLIB REQUIRED)
+if(NOT ZLIB_VERSION_STRING)
+    message(STATUS "Found ZLIB unknown version")
+else()
+    message(STATUS "Found ZLIB version " ${ZLIB_VERSION_STRING})
+endif()
+target_link_libraries(websocketpp INTERFACE ZLIB::ZLIB)
+
 list(APPEND NMOS_CPP_TARGETS websocketpp)
 add_library(nmos-cpp::websocketpp ALIAS websocketpp)
 
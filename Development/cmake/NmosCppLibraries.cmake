@@ -707,6 +707,7 @@ set(NMOS_CPP_CPPREST_SOURCES
     cpprest/json_utils.cpp
     cpprest/json_validator_impl.cpp
     cpprest/json_visit.cpp
+    cpprest/regex_utils.cpp
     cpprest/ws_listener_impl.cpp
     )
 
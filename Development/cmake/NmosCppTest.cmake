@@ -39,16 +39,28 @@ set(NMOS_CPP_TEST_MDNS_TEST_HEADERS
     )
 
 set(NMOS_CPP_TEST_NMOS_TEST_SOURCES
+    nmos/test/activation_utils_test.cpp
+    nmos/test/api_downgrade_test.cpp
     nmos/test/api_utils_test.cpp
     nmos/test/capabilities_test.cpp
     nmos/test/channels_test.cpp
+    nmos/test/connection_api_test.cpp
+    nmos/test/connection_events_activation_test.cpp
     nmos/test/did_sdid_test.cpp
     nmos/test/event_type_test.cpp
+    nmos/test/events_ws_api_test.cpp
     nmos/test/json_validator_test.cpp
+    nmos/test/model_test.cpp
+    nmos/test/node_behaviour_test.cpp
     nmos/test/paging_utils_test.cpp
     nmos/test/query_api_test.cpp
+    nmos/test/query_utils_test.cpp
+    nmos/test/query_ws_api_test.cpp
+    nmos/test/resources_test.cpp
     nmos/test/sdp_utils_test.cpp
+    nmos/test/settings_test.cpp
     nmos/test/system_resources_test.cpp
+    nmos/test/thread_utils_test.cpp
     nmos/test/video_jxsv_test.cpp
     )
 set(NMOS_CPP_TEST_NMOS_TEST_HEADERS
@@ -1,4 +1,8 @@
 #include "cpprest/api_router.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
 #include "cpprest/http_utils.h"
 
 namespace web
@@ -16,9 +20,19 @@ namespace web
                     {
                     public:
                         typedef std::pair<utility::regex_t, utility::named_sub_matches_t> regex_named_sub_matches_type;
-                        struct route { match_flag_type flags; regex_named_sub_matches_type route_pattern; web::http::method method; route_handler handler; };
-                        typedef std::list<route> route_handlers;
-                        typedef route_handlers::iterator iterator;
+                        struct route { match_flag_type flags; regex_named_sub_matches_type route_pattern; compiled_route_pattern compiled_pattern; web::http::method method; route_handler handler; };
+                        typedef std::vector<route> route_handlers;
+                        typedef route_handlers::size_type iterator;
+
+                        // trie of the literal prefixes of the route patterns, so that only the routes which can possibly match a path are tried
+                        struct route_trie_node
+                        {
+                            std::vector<iterator> routes;
+                            std::map<utility::char_t, std::size_t> children;
+                        };
+                        typedef std::vector<route_trie_node> route_trie;
+
+                        api_router_impl() : trie(1) {}
 
                         static pplx::task<bool> call(const route_handler& handler, const route_handler& exception_handler, web::http::http_request req, web::http::http_response res, const utility::string_t& route_path, const route_parameters& parameters);
                         static void handle_method_not_allowed(const route& route, web::http::http_response& res, const utility::string_t& route_path, const route_parameters& parameters);
@@ -26,10 +40,16 @@ namespace web
 
                         pplx::task<bool> operator()(web::http::http_request req, web::http::http_response res, const utility::string_t& route_path, const route_parameters& parameters, iterator route);
 
-                        // to allow routes to be added out-of-order, support() and mount() could easily be given overloads that accept and return an iterator (const_iterator in C++11)
-                        iterator insert(iterator where, match_flag_type flags, const utility::string_t& route_pattern, const web::http::method& method, route_handler handler);
+                        // routes are tried in the order they were added
+                        iterator insert(match_flag_type flags, const utility::string_t& route_pattern, const web::http::method& method, route_handler handler);
+
+                        // the routes whose literal prefix matches the path, in order
+                        std::vector<iterator> candidates(const utility::string_t& path) const;
+
+                        static bool match(const route& route, const utility::string_t& path, utility::string_t::size_type& length, route_parameters& parameters);
 
                         route_handlers routes;
+                        route_trie trie;
                         route_handler exception_handler;
                     };
                 }
@@ -89,27 +109,30 @@ namespace web
 
                 pplx::task<bool> api_router::operator()(web::http::http_request req, web::http::http_response res, const utility::string_t& route_path, const route_parameters& parameters)
                 {
-                    return (*impl)(req, res, route_path, parameters, impl->routes.begin());
+                    return (*impl)(req, res, route_path, parameters, 0);
                 }
 
                 pplx::task<bool> details::api_router_impl::operator()(web::http::http_request req, web::http::http_response res, const utility::string_t& route_path, const route_parameters& parameters, iterator route)
                 {
-                    const utility::string_t path = get_route_relative_path(req, route_path); // required, as must live longer than the match results
-                    for (; routes.end() != route; ++route)
+                    const utility::string_t path = get_route_relative_path(req, route_path);
+                    const auto candidate_routes = candidates(path);
+                    for (auto candidate = std::lower_bound(candidate_routes.begin(), candidate_routes.end(), route); candidate_routes.end() != candidate; ++candidate)
                     {
-                        utility::smatch_t route_match;
-                        if (route_regex_match(path, route_match, route->route_pattern.first, route->flags))
+                        route = *candidate;
+                        utility::string_t::size_type length = 0;
+                        route_parameters match_parameters;
+                        if (match(routes[route], path, length, match_parameters))
                         {
                             // route_path for this route handler is constructed by appending the entire matching expression
-                            const auto merged_path = route_path + route_match.str();
+                            const auto merged_path = route_path + path.substr(0, length);
                             // existing parameters are inserted into the new parameters rather than vice-versa so that new parameters replace existing ones with the same name
-                            const auto merged_parameters = insert(get_parameters(route->route_pattern.second, route_match), parameters);
+                            const auto merged_parameters = insert(std::move(match_parameters), parameters);
 
-                            if (route->method == req.method() || any_method == route->method)
+                            if (routes[route].method == req.method() || any_method == routes[route].method)
                             {
                                 // capture shared_this to extend lifetime into the continuation
                                 auto shared_this = shared_from_this();
-                                return call(route->handler, exception_handler, req, res, merged_path, merged_parameters)
+                                return call(routes[route].handler, exception_handler, req, res, merged_path, merged_parameters)
                                     .then([shared_this, this, req, res, route_path, parameters, route](bool continue_matching)
                                 {
                                     if (!continue_matching)
@@ -118,12 +141,12 @@ namespace web
                                         return pplx::task_from_result(false);
                                     }
 
-                                    return (*this)(req, res, route_path, parameters, std::next(route));
+                                    return (*this)(req, res, route_path, parameters, route + 1);
                                 });
                             }
                             else
                             {
-                                handle_method_not_allowed(*route, res, merged_path, merged_parameters);
+                                handle_method_not_allowed(routes[route], res, merged_path, merged_parameters);
                             }
                         }
                     }
@@ -180,22 +203,22 @@ namespace web
 
                 void api_router::support(const utility::string_t& route_pattern, const web::http::method& method, route_handler handler)
                 {
-                    impl->insert(impl->routes.end(), details::match_entire, route_pattern, method, handler);
+                    impl->insert(details::match_entire, route_pattern, method, handler);
                 }
 
                 void api_router::support(const utility::string_t& route_pattern, route_handler all_handler)
                 {
-                    impl->insert(impl->routes.end(), details::match_entire, route_pattern, any_method, all_handler);
+                    impl->insert(details::match_entire, route_pattern, any_method, all_handler);
                 }
 
                 void api_router::mount(const utility::string_t& route_pattern, const web::http::method& method, route_handler handler)
                 {
-                    impl->insert(impl->routes.end(), details::match_prefix, route_pattern, method, handler);
+                    impl->insert(details::match_prefix, route_pattern, method, handler);
                 }
 
                 void api_router::mount(const utility::string_t& route_pattern, route_handler all_handler)
                 {
-                    impl->insert(impl->routes.end(), details::match_prefix, route_pattern, any_method, all_handler);
+                    impl->insert(details::match_prefix, route_pattern, any_method, all_handler);
                 }
 
                 void api_router::set_exception_handler(route_handler handler)
@@ -203,10 +226,64 @@ namespace web
                     impl->exception_handler = handler;
                 }
 
-                details::api_router_impl::iterator details::api_router_impl::insert(iterator where, match_flag_type flags, const utility::string_t& route_pattern, const web::http::method& method, route_handler handler)
+                details::api_router_impl::iterator details::api_router_impl::insert(match_flag_type flags, const utility::string_t& route_pattern, const web::http::method& method, route_handler handler)
                 {
                     auto parsed = utility::parse_regex_named_sub_matches(route_pattern);
-                    return routes.insert(where, { flags, { utility::regex_t(parsed.first), parsed.second }, method, handler });
+                    auto compiled = compile_route_pattern(route_pattern);
+                    const iterator route = routes.size();
+
+                    // add the route to the trie node for its literal prefix
+                    std::size_t node = 0;
+                    for (const auto& c : compiled.prefix)
+                    {
+                        auto child = trie[node].children.find(c);
+                        if (trie[node].children.end() != child)
+                        {
+                            node = child->second;
+                        }
+                        else
+                        {
+                            const auto child_node = trie.size();
+                            trie[node].children.insert({ c, child_node });
+                            trie.push_back({});
+                            node = child_node;
+                        }
+                    }
+                    trie[node].routes.push_back(route);
+
+                    routes.push_back({ flags, { utility::regex_t(parsed.first), parsed.second }, std::move(compiled), method, handler });
+                    return route;
+                }
+
+                std::vector<details::api_router_impl::iterator> details::api_router_impl::candidates(const utility::string_t& path) const
+                {
+                    std::vector<iterator> result(trie.front().routes);
+                    std::size_t node = 0;
+                    for (const auto& c : path)
+                    {
+                        auto child = trie[node].children.find(c);
+                        if (trie[node].children.end() == child) break;
+                        node = child->second;
+                        result.insert(result.end(), trie[node].routes.begin(), trie[node].routes.end());
+                    }
+                    std::sort(result.begin(), result.end());
+                    return result;
+                }
+
+                bool details::api_router_impl::match(const route& route, const utility::string_t& path, utility::string_t::size_type& length, route_parameters& parameters)
+                {
+                    if (regex_pattern != route.compiled_pattern.kind)
+                    {
+                        if (!compiled_route_match(path, length, route.compiled_pattern, route.flags)) return false;
+                        parameters = route.compiled_pattern.parameters;
+                        return true;
+                    }
+
+                    utility::smatch_t route_match;
+                    if (!route_regex_match(path, route_match, route.route_pattern.first, route.flags)) return false;
+                    length = route_match.length();
+                    parameters = get_parameters(route.route_pattern.second, route_match);
+                    return true;
                 }
 
                 route_parameters details::get_parameters(const utility::named_sub_matches_t& parameter_sub_matches, const utility::smatch_t& route_match)
@@ -236,6 +313,146 @@ namespace web
                         ? bst::regex_search(path, route_match, route_regex, bst::regex_constants::match_continuous)
                         : bst::regex_match(path, route_match, route_regex);
                 }
+
+                namespace details
+                {
+                    static bool is_regex_special(utility::char_t c)
+                    {
+                        return utility::string_t::npos != utility::string_t(_XPLATSTR("\\^$.|?*+()[]{}")).find(c);
+                    }
+
+                    static bool is_regex_quantifier(utility::char_t c)
+                    {
+                        return _XPLATSTR('?') == c || _XPLATSTR('*') == c || _XPLATSTR('+') == c || _XPLATSTR('{') == c;
+                    }
+
+                    // parse one literal character, which may be escaped, returning the position after it, or pos if it isn't a literal character
+                    static utility::string_t::size_type parse_literal(const utility::string_t& pattern, utility::string_t::size_type pos, utility::char_t& literal)
+                    {
+                        if (pattern.size() == pos) return pos;
+                        const auto c = pattern[pos];
+                        if (_XPLATSTR('\\') == c)
+                        {
+                            // only an escaped punctuation character is a literal, e.g. "\\d" is a character class
+                            if (pattern.size() == pos + 1) return pos;
+                            const auto e = pattern[pos + 1];
+                            if ((_XPLATSTR('0') <= e && e <= _XPLATSTR('9')) || (_XPLATSTR('a') <= e && e <= _XPLATSTR('z')) || (_XPLATSTR('A') <= e && e <= _XPLATSTR('Z'))) return pos;
+                            literal = e;
+                            return pos + 2;
+                        }
+                        if (is_regex_special(c)) return pos;
+                        literal = c;
+                        return pos + 1;
+                    }
+
+                    // identify whether there is an alternation that isn't inside a group, e.g. "foo|bar", which means there can be no literal prefix
+                    static bool has_top_level_alternation(const utility::string_t& pattern)
+                    {
+                        int depth = 0;
+                        bool bracket = false;
+                        for (utility::string_t::size_type pos = 0; pattern.size() > pos; ++pos)
+                        {
+                            const auto c = pattern[pos];
+                            if (_XPLATSTR('\\') == c) ++pos;
+                            else if (bracket) bracket = _XPLATSTR(']') != c;
+                            else if (_XPLATSTR('[') == c) bracket = true;
+                            else if (_XPLATSTR('(') == c) ++depth;
+                            else if (_XPLATSTR(')') == c) --depth;
+                            else if (_XPLATSTR('|') == c && 0 == depth) return true;
+                        }
+                        return false;
+                    }
+                }
+
+                details::compiled_route_pattern details::compile_route_pattern(const utility::string_t& route_pattern)
+                {
+                    if (has_top_level_alternation(route_pattern))
+                    {
+                        return{ regex_pattern, {}, {} };
+                    }
+
+                    compiled_route_pattern result{ regex_pattern, {}, {} };
+
+                    utility::string_t::size_type pos = 0;
+                    while (route_pattern.size() > pos)
+                    {
+                        utility::char_t literal;
+                        auto next = parse_literal(route_pattern, pos, literal);
+                        if (pos != next)
+                        {
+                            // a quantifier means the preceding character is optional or repeated
+                            if (route_pattern.size() > next && is_regex_quantifier(route_pattern[next])) break;
+                            result.prefix.push_back(literal);
+                            pos = next;
+                            continue;
+                        }
+
+                        // a named sub-match that is entirely literal, e.g. "(?<api>query)", is also part of the literal prefix
+                        static const utility::string_t named_sub_match_begin{ _XPLATSTR("(?<") };
+                        if (0 != route_pattern.compare(pos, named_sub_match_begin.size(), named_sub_match_begin)) break;
+                        // but "(?<=" and "(?<!" begin a lookbehind assertion rather than a named sub-match
+                        if (route_pattern.size() > pos + named_sub_match_begin.size() && (_XPLATSTR('=') == route_pattern[pos + named_sub_match_begin.size()] || _XPLATSTR('!') == route_pattern[pos + named_sub_match_begin.size()])) break;
+                        const auto name_end = route_pattern.find(_XPLATSTR('>'), pos + named_sub_match_begin.size());
+                        if (utility::string_t::npos == name_end) break;
+
+                        utility::string_t sub_match;
+                        next = name_end + 1;
+                        for (auto literal_end = parse_literal(route_pattern, next, literal); next != literal_end; literal_end = parse_literal(route_pattern, next, literal))
+                        {
+                            sub_match.push_back(literal);
+                            next = literal_end;
+                        }
+                        if (route_pattern.size() == next || _XPLATSTR(')') != route_pattern[next]) break;
+                        ++next;
+                        if (route_pattern.size() > next && is_regex_quantifier(route_pattern[next])) break;
+
+                        result.parameters[route_pattern.substr(pos + named_sub_match_begin.size(), name_end - pos - named_sub_match_begin.size())] = sub_match;
+                        result.prefix += sub_match;
+                        pos = next;
+                    }
+
+                    const auto rest = route_pattern.substr(pos);
+                    if (rest.empty())
+                    {
+                        result.kind = literal_pattern;
+                    }
+                    else if (_XPLATSTR("/?") == rest)
+                    {
+                        result.kind = literal_optional_slash_pattern;
+                    }
+                    else if (_XPLATSTR(".*") == rest && result.prefix.empty())
+                    {
+                        result.kind = any_pattern;
+                    }
+                    else
+                    {
+                        // the regex is required, but the parameters are extracted from the sub-matches
+                        result.parameters.clear();
+                    }
+                    return result;
+                }
+
+                bool details::compiled_route_match(const utility::string_t& path, utility::string_t::size_type& length, const compiled_route_pattern& route_pattern, match_flag_type flags)
+                {
+                    const auto& prefix = route_pattern.prefix;
+                    switch (route_pattern.kind)
+                    {
+                    case literal_pattern:
+                        if (match_prefix == flags ? 0 != path.compare(0, prefix.size(), prefix) : path != prefix) return false;
+                        length = prefix.size();
+                        return true;
+                    case literal_optional_slash_pattern:
+                        if (0 != path.compare(0, prefix.size(), prefix)) return false;
+                        length = path.size() > prefix.size() && _XPLATSTR('/') == path[prefix.size()] ? prefix.size() + 1 : prefix.size();
+                        return match_prefix == flags || path.size() == length;
+                    case any_pattern:
+                        // since paths are percent-encoded, there are no line terminators for "." not to match
+                        length = path.size();
+                        return true;
+                    default:
+                        return false;
+                    }
+                }
             }
         }
     }
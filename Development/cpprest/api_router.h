@@ -34,6 +34,22 @@ namespace web
 
                     enum match_flag_type { match_entire = 0, match_prefix = 1 };
 
+                    // most route patterns have a literal prefix, and many are entirely literal apart from an optional trailing slash
+                    // or are just ".*", so can be matched without the regex
+                    enum route_pattern_kind { regex_pattern, literal_pattern, literal_optional_slash_pattern, any_pattern };
+
+                    struct compiled_route_pattern
+                    {
+                        route_pattern_kind kind;
+                        // every path that matches the route pattern begins with this literal prefix
+                        utility::string_t prefix;
+                        // the parameters from named sub-matches that are entirely literal, e.g. "api" for "/x-nmos/(?<api>query)/?"
+                        route_parameters parameters;
+                    };
+
+                    compiled_route_pattern compile_route_pattern(const utility::string_t& route_pattern);
+                    bool compiled_route_match(const utility::string_t& path, utility::string_t::size_type& length, const compiled_route_pattern& route_pattern, match_flag_type flags);
+
                     utility::string_t get_route_relative_path(const web::http::http_request& req, const utility::string_t& route_path);
                     route_parameters get_parameters(const utility::named_sub_matches_t& parameter_sub_matches, const utility::smatch_t& route_match);
                     bool route_regex_match(const utility::string_t& path, utility::smatch_t& route_match, const utility::regex_t& route_regex, match_flag_type flags);
@@ -1,6 +1,7 @@
 #include "cpprest/json_utils.h"
 
 #include <list>
+#include <locale>
 #include <boost/algorithm/string/find.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -39,6 +40,16 @@ namespace web
             {
                 return utility::string_t::npos == last ? utility::string_t::npos : last - first;
             }
+
+            // fold a string to lower case, in one pass, using the global locale like boost::algorithm::iequals, etc.
+            inline utility::string_t fold_case(utility::string_t s)
+            {
+                if (!s.empty())
+                {
+                    std::use_facet<std::ctype<utility::char_t>>(std::locale()).tolower(&s[0], &s[0] + s.size());
+                }
+                return s;
+            }
         }
 
         // insert a field into the specified object at the specified key path (splitting it on '.' and inserting sub-objects as necessary)
@@ -233,6 +244,38 @@ namespace web
             return result;
         }
 
+        // fold the strings in a query/exemplar to lower case, so that it can be compared repeatedly with match_folded
+        web::json::value fold_query(const web::json::value& query)
+        {
+            if (query.is_string())
+            {
+                return web::json::value::string(details::fold_case(query.as_string()));
+            }
+            else if (query.is_object())
+            {
+                // field names are not folded, since they are always matched exactly
+                auto result = query;
+                for (auto& field : result.as_object())
+                {
+                    field.second = fold_query(field.second);
+                }
+                return result;
+            }
+            else if (query.is_array())
+            {
+                auto result = query;
+                for (auto& element : result.as_array())
+                {
+                    element = fold_query(element);
+                }
+                return result;
+            }
+            else
+            {
+                return query;
+            }
+        }
+
         // compare a value against a query/exemplar
         bool match_query(const web::json::value& value, const web::json::value& query, match_flag_type match_flags)
         {
@@ -262,7 +305,15 @@ namespace web
             }
             else if (value.type() == query.type())
             {
-                if (query.is_string())
+                if (query.is_string() && match_folded == (match_folded & match_flags))
+                {
+                    // the query string has already been folded, so only the value needs to be
+                    const auto folded = details::fold_case(value.as_string());
+                    return 0 != (match_substr & match_flags)
+                        ? utility::string_t::npos != folded.find(query.as_string())
+                        : folded == query.as_string();
+                }
+                else if (query.is_string())
                 {
                     return 0 != (match_substr & match_flags)
                         // value must contain the query as a substring (optionally case-insensitive)
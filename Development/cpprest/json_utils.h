@@ -153,6 +153,28 @@ namespace web
             return os.str();
         }
 
+        // concatenate a forward range of already serialized json values (e.g. vector of strings) as an array
+        template <typename ForwardRange>
+        inline utility::string_t concatenate_array(const ForwardRange& serialized_elements)
+        {
+            utility::string_t result(1, _XPLATSTR('['));
+            bool empty = true;
+            for (const auto& serialized_element : serialized_elements)
+            {
+                if (!empty)
+                {
+                    result.push_back(_XPLATSTR(','));
+                }
+                else
+                {
+                    empty = false;
+                }
+                result.append(serialized_element);
+            }
+            result.push_back(_XPLATSTR(']'));
+            return result;
+        }
+
         // serialize a forward range of pairs of strings and json values (e.g. map) as an object
         template <typename ForwardRange>
         inline utility::string_t serialize_object(const ForwardRange& fields)
@@ -265,7 +287,8 @@ namespace web
         {
             match_default = 0x0000, // string matches must be exact
             match_substr =  0x0001, // substring matches are OK
-            match_icase =   0x0002  // case-insensitive matches are OK
+            match_icase =   0x0002, // case-insensitive matches are OK
+            match_folded =  0x0006  // case-insensitive matches are OK, and the query strings have already been folded by fold_query
         };
         // so for some convenience...
         inline match_flag_type operator|(match_flag_type lhs, match_flag_type rhs) { return match_flag_type((int)lhs | (int)rhs); }
@@ -283,6 +306,11 @@ namespace web
         // construct a query/exemplar object from a parameters object, by constructing nested sub-objects from '.'-separated field names
         web::json::value unflatten(const web::json::value& value);
 
+        // fold the strings in a query/exemplar to lower case, so that it can be compared repeatedly with match_folded
+        // rather than with match_icase, which means each comparison only needs to fold the value
+        // (a query string that is eventually treated as serialized json is then also parsed after folding)
+        web::json::value fold_query(const web::json::value& query);
+
         // compare a value against a query/exemplar
         bool match_query(const web::json::value& value, const web::json::value& query, match_flag_type match_flags = match_default);
 
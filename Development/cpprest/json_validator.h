@@ -15,6 +15,10 @@ namespace web
             namespace details
             {
                 class json_validator_impl;
+
+                // for testing only, e.g. to measure the cost of the previous implementation, convert each instance to be validated
+                // by serializing it and parsing the result, rather than by walking the value directly
+                void set_json_validator_serialize_and_parse(bool serialize_and_parse);
             }
 
             class json_validator
@@ -1,5 +1,7 @@
 #include "cpprest/json_validator.h"
 
+#include <atomic>
+#include <cmath>
 #include "bst/regex.h"
 #include "cpprest/basic_utils.h"
 #include "cpprest/json.h"
@@ -75,6 +77,70 @@ namespace web
                     }
                 }
 
+                // convert a cpprest json value to the equivalent nlohmann json value, by walking the value directly
+                // rather than serializing and parsing it, which was the dominant cost of validating small instances
+                // numbers are converted as if they had been parsed, so non-negative integers are unsigned, negative integers are signed,
+                // and a double with an integral value that would be serialized without an exponent is also an integer
+                nlohmann::json to_nlohmann_json(const web::json::value& value)
+                {
+                    switch (value.type())
+                    {
+                    case web::json::value::Null:
+                        return nullptr;
+                    case web::json::value::Boolean:
+                        return value.as_bool();
+                    case web::json::value::Number:
+                    {
+                        const auto& number = value.as_number();
+                        if (number.is_integer())
+                        {
+                            if (number.is_uint64()) return number.to_uint64();
+                            return number.to_int64();
+                        }
+                        const auto d = number.to_double();
+                        if (std::floor(d) == d && std::abs(d) < 1e17)
+                        {
+                            if (0 <= d) return (std::uint64_t)d;
+                            return (std::int64_t)d;
+                        }
+                        return d;
+                    }
+                    case web::json::value::String:
+                        return utility::us2s(value.as_string());
+                    case web::json::value::Object:
+                    {
+                        auto result = nlohmann::json::object();
+                        for (const auto& field : value.as_object())
+                        {
+                            result.emplace(utility::us2s(field.first), to_nlohmann_json(field.second));
+                        }
+                        return result;
+                    }
+                    case web::json::value::Array:
+                    {
+                        auto result = nlohmann::json::array();
+                        const auto& elements = value.as_array();
+                        result.get_ref<nlohmann::json::array_t&>().reserve(elements.size());
+                        for (const auto& element : elements)
+                        {
+                            result.push_back(to_nlohmann_json(element));
+                        }
+                        return result;
+                    }
+                    default:
+                        throw web::json::json_exception("unexpected json value type");
+                    }
+                }
+
+                static std::atomic<bool> json_validator_serialize_and_parse{ false };
+
+                // for testing only, e.g. to measure the cost of the previous implementation, convert each instance to be validated
+                // by serializing it and parsing the result, rather than by walking the value directly
+                void set_json_validator_serialize_and_parse(bool serialize_and_parse)
+                {
+                    json_validator_serialize_and_parse = serialize_and_parse;
+                }
+
                 // json validator implementation that uses pboettch/json_schema_validator
                 class json_validator_impl
                 {
@@ -89,7 +155,7 @@ namespace web
                                 {
                                     const auto id = web::uri(utility::s2us(id_impl.url()));
                                     const auto value = load_schema(id);
-                                    value_impl = nlohmann::json::parse(utility::us2s(value.serialize()));
+                                    value_impl = to_nlohmann_json(value);
                                 },
                                 check_format
                             };
@@ -121,7 +187,9 @@ namespace web
 
                         try
                         {
-                            auto instance = nlohmann::json::parse(utility::us2s(value.serialize()));
+                            const auto instance = json_validator_serialize_and_parse
+                                ? nlohmann::json::parse(utility::us2s(value.serialize()))
+                                : to_nlohmann_json(value);
                             validator->second.validate(instance, error_handler);
                         }
                         catch (const web::json::json_exception&)
@@ -0,0 +1,70 @@
+#include "cpprest/regex_utils.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace utility
+{
+    namespace details
+    {
+        class regex_cache
+        {
+        public:
+            explicit regex_cache(size_t max_size) : max_size(max_size) {}
+
+            std::shared_ptr<const regex_t> get(const string_t& pattern, bool icase)
+            {
+                // the flags and the pattern are combined into a single key
+                const key_type full_key = (icase ? _XPLATSTR("i/") : _XPLATSTR("/")) + pattern;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto found = index.find(full_key);
+                    if (index.end() != found)
+                    {
+                        // move the entry to the front of the list as the most recently used
+                        entries.splice(entries.begin(), entries, found->second);
+                        return found->second->second;
+                    }
+                }
+
+                // construct the regex outside the lock, so that other threads are not held up by it
+                // verbose conditional expression avoids compiler warnings on all platforms
+                const auto flags = icase ? regex_t::flag_type(regex_t::icase) : regex_t::flag_type(0);
+                auto regex = std::make_shared<const regex_t>(pattern, flags);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                // another thread may have got there first
+                auto found = index.find(full_key);
+                if (index.end() != found) return found->second->second;
+
+                entries.push_front({ full_key, regex });
+                index.insert({ full_key, entries.begin() });
+                if (max_size < entries.size())
+                {
+                    index.erase(entries.back().first);
+                    entries.pop_back();
+                }
+                return regex;
+            }
+
+        private:
+            typedef string_t key_type;
+            typedef std::list<std::pair<key_type, std::shared_ptr<const regex_t>>> entries_type;
+
+            const size_t max_size;
+            std::mutex mutex;
+            entries_type entries;
+            std::unordered_map<key_type, entries_type::iterator> index;
+        };
+    }
+
+    // get the regex for the specified pattern from a bounded, least-recently-used cache shared by all callers
+    // throws bst::regex_error if the pattern is not valid, in which case nothing is cached
+    std::shared_ptr<const regex_t> make_cached_regex(const string_t& pattern, bool icase)
+    {
+        static details::regex_cache cache(1024);
+        return cache.get(pattern, icase);
+    }
+}
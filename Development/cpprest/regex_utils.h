@@ -2,6 +2,7 @@
 #define CPPREST_REGEX_UTILS_H
 
 #include <map>
+#include <memory>
 #include "bst/regex.h"
 
 // An implementation of named capture on top of bst::basic_regex (could be extracted from the cpprest module)
@@ -190,6 +191,11 @@ namespace utility
     {
         return ::xregex::parse_regex_named_sub_matches(regex);
     }
+
+    // get the regex for the specified pattern from a bounded, least-recently-used cache shared by all callers,
+    // since constructing a regex is expensive and the same few patterns tend to be used over and over
+    // throws bst::regex_error if the pattern is not valid, in which case nothing is cached
+    std::shared_ptr<const regex_t> make_cached_regex(const string_t& pattern, bool icase = false);
 }
 
 #endif
@@ -91,3 +91,122 @@ BST_TEST_CASE(testGetParameters)
     BST_REQUIRE(bst::regex_match(path, route_match, route_regex));
     BST_REQUIRE(expected == get_parameters(parameter_sub_matches, route_match));
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testCompileRoutePattern)
+{
+    using web::http::experimental::listener::details::compile_route_pattern;
+    using web::http::experimental::listener::details::compiled_route_match;
+    using web::http::experimental::listener::details::match_entire;
+    using web::http::experimental::listener::details::match_prefix;
+    using web::http::experimental::listener::route_parameters;
+    namespace details = web::http::experimental::listener::details;
+
+    // entirely literal apart from an optional trailing slash
+    {
+        const auto compiled = compile_route_pattern(U("/x-nmos/(?<api>query)/?"));
+        BST_REQUIRE_EQUAL(details::literal_optional_slash_pattern, compiled.kind);
+        BST_REQUIRE_STRING_EQUAL("/x-nmos/query", utility::us2s(compiled.prefix));
+        const route_parameters expected{ { U("api"), U("query") } };
+        BST_REQUIRE(expected == compiled.parameters);
+
+        utility::string_t::size_type length = 0;
+        BST_REQUIRE(compiled_route_match(U("/x-nmos/query"), length, compiled, match_entire));
+        BST_REQUIRE_EQUAL(13, length);
+        BST_REQUIRE(compiled_route_match(U("/x-nmos/query/"), length, compiled, match_entire));
+        BST_REQUIRE_EQUAL(14, length);
+        BST_REQUIRE(!compiled_route_match(U("/x-nmos/query/v1.3"), length, compiled, match_entire));
+        BST_REQUIRE(compiled_route_match(U("/x-nmos/query/v1.3"), length, compiled, match_prefix));
+        BST_REQUIRE_EQUAL(14, length);
+        BST_REQUIRE(!compiled_route_match(U("/x-nmos/quer"), length, compiled, match_prefix));
+    }
+
+    // escaped characters are literal
+    {
+        const auto compiled = compile_route_pattern(U("/log/v1\\.0"));
+        BST_REQUIRE_EQUAL(details::literal_pattern, compiled.kind);
+        BST_REQUIRE_STRING_EQUAL("/log/v1.0", utility::us2s(compiled.prefix));
+    }
+
+    // match everything
+    {
+        const auto compiled = compile_route_pattern(U(".*"));
+        BST_REQUIRE_EQUAL(details::any_pattern, compiled.kind);
+
+        utility::string_t::size_type length = 0;
+        BST_REQUIRE(compiled_route_match(U("/foo/bar"), length, compiled, match_entire));
+        BST_REQUIRE_EQUAL(8, length);
+    }
+
+    // the regex is required, but any literal prefix is still identified
+    {
+        const auto compiled = compile_route_pattern(U("/x-nmos/(?<api>query)/(?<version>v[0-9]+\\.[0-9]+)"));
+        BST_REQUIRE_EQUAL(details::regex_pattern, compiled.kind);
+        BST_REQUIRE_STRING_EQUAL("/x-nmos/query/", utility::us2s(compiled.prefix));
+        BST_REQUIRE(compiled.parameters.empty());
+    }
+
+    // a quantifier makes the preceding character optional
+    BST_REQUIRE_STRING_EQUAL("/fo", utility::us2s(compile_route_pattern(U("/foo?/bar")).prefix));
+    BST_REQUIRE_STRING_EQUAL("/foo/", utility::us2s(compile_route_pattern(U("/foo/(?<bar>bar)?")).prefix));
+
+    // an alternation means there is no literal prefix
+    BST_REQUIRE_STRING_EQUAL("", utility::us2s(compile_route_pattern(U("/foo|/bar")).prefix));
+    BST_REQUIRE_STRING_EQUAL("/", utility::us2s(compile_route_pattern(U("/(?:foo|bar)")).prefix));
+
+    // a lookbehind assertion is not a named sub-match
+    BST_REQUIRE_STRING_EQUAL("/foo", utility::us2s(compile_route_pattern(U("/foo(?<=o)(?<bar>bar)")).prefix));
+    BST_REQUIRE_STRING_EQUAL("/foo", utility::us2s(compile_route_pattern(U("/foo(?<!x)(?<bar>bar)")).prefix));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testApiRouterRoutePathAndParameters)
+{
+    using namespace web::http::experimental::listener::api_router_using_declarations;
+
+    std::vector<std::pair<utility::string_t, route_parameters>> matched;
+    const auto handler = [&matched](http_request, http_response, const string_t& route_path, const route_parameters& parameters)
+    {
+        matched.push_back({ route_path, parameters });
+        return pplx::task_from_result(true);
+    };
+
+    api_router versioned;
+    versioned.support(U(".*"), handler);
+    versioned.support(U("/?"), methods::GET, handler);
+    versioned.support(U("/(?<resourceType>senders|receivers)/?"), methods::GET, handler);
+
+    api_router router;
+    router.support(U("/x-nmos/(?<api>query)/?"), methods::GET, handler);
+    router.mount(U("/x-nmos/(?<api>query)/(?<version>v[0-9]+\\.[0-9]+)"), versioned);
+    router.support(U("/x-nmos/(?<api>query)/v1\\.3/senders"), methods::POST, handler);
+
+    const auto route = [&](const utility::string_t& path)
+    {
+        matched.clear();
+        http_request req(methods::GET);
+        req.set_request_uri(web::uri(U("http://host:123") + path));
+        http_response res;
+        return router(req, res, {}, {}).get();
+    };
+
+    BST_REQUIRE(route(U("/x-nmos/query/")));
+    BST_REQUIRE_EQUAL(1, matched.size());
+    BST_REQUIRE_STRING_EQUAL("/x-nmos/query/", utility::us2s(matched[0].first));
+    const route_parameters expected{ { U("api"), U("query") } };
+    BST_REQUIRE(expected == matched[0].second);
+
+    BST_REQUIRE(route(U("/x-nmos/query/v1.3/senders/")));
+    BST_REQUIRE_EQUAL(2, matched.size());
+    BST_REQUIRE_STRING_EQUAL("/x-nmos/query/v1.3/senders/", utility::us2s(matched[0].first));
+    BST_REQUIRE(route_parameters({ { U("api"), U("query") }, { U("version"), U("v1.3") } }) == matched[0].second);
+    BST_REQUIRE_STRING_EQUAL("/x-nmos/query/v1.3/senders/", utility::us2s(matched[1].first));
+    BST_REQUIRE(route_parameters({ { U("api"), U("query") }, { U("version"), U("v1.3") }, { U("resourceType"), U("senders") } }) == matched[1].second);
+
+    // the last route also matches, but not for the requested method
+    BST_REQUIRE(route(U("/x-nmos/query/v1.3/senders")));
+    BST_REQUIRE_EQUAL(2, matched.size());
+
+    BST_REQUIRE(route(U("/x-nmos/registration/")));
+    BST_REQUIRE(matched.empty());
+}
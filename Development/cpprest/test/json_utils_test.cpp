@@ -287,6 +287,13 @@ BST_TEST_CASE(testSerialize)
         BST_REQUIRE_EQUAL(expected, actual);
     }
 
+    {
+        std::vector<utility::string_t> serialized{ U("\"meow\""), U("{\"purr\":42}"), U("[]") };
+
+        BST_REQUIRE_EQUAL(U("[\"meow\",{\"purr\":42},[]]"), web::json::concatenate_array(serialized));
+        BST_REQUIRE_EQUAL(U("[]"), web::json::concatenate_array(std::vector<utility::string_t>{}));
+    }
+
     {
         std::map<utility::string_t, web::json::value> fields{
             { U("meow"), web::json::value::string(U("foo")) },
@@ -300,3 +307,34 @@ BST_TEST_CASE(testSerialize)
         BST_REQUIRE_EQUAL(expected, actual);
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testMatchQueryFolded)
+{
+    using web::json::value_of;
+    using web::json::match_query;
+
+    const auto value = value_of({
+        { U("label"), U("Camera Left") },
+        { U("tags"), value_of({ U("Studio A"), U("Studio B") }) },
+        { U("count"), 42 }
+    });
+
+    const auto query = value_of({ { U("label"), U("CAMERA") }, { U("tags"), U("studio b") } });
+    const auto folded = web::json::fold_query(query);
+
+    // field names are not folded, only strings
+    BST_REQUIRE(folded.has_field(U("label")));
+    BST_REQUIRE_EQUAL(U("camera"), folded.at(U("label")).as_string());
+
+    // matching the folded query gives the same results as case-insensitive matching of the original query
+    BST_REQUIRE(!match_query(value, query, web::json::match_icase));
+    BST_REQUIRE(!match_query(value, folded, web::json::match_folded));
+    BST_REQUIRE(match_query(value, query, web::json::match_icase | web::json::match_substr));
+    BST_REQUIRE(match_query(value, folded, web::json::match_folded | web::json::match_substr));
+
+    const auto exact = value_of({ { U("label"), U("camera LEFT") }, { U("count"), U("42") } });
+    BST_REQUIRE(match_query(value, exact, web::json::match_icase));
+    BST_REQUIRE(match_query(value, web::json::fold_query(exact), web::json::match_folded));
+    BST_REQUIRE(!match_query(value, exact));
+}
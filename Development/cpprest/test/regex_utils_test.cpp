@@ -50,3 +50,22 @@ BST_TEST_CASE(testParseRegexNamedSubMatchesWithTrickiness)
     BST_REQUIRE_EQUAL(2, actual.second.at(U("foo")));
     BST_REQUIRE_EQUAL(3, actual.second.at(U("baz")));
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testMakeCachedRegex)
+{
+    const auto regex = utility::make_cached_regex(U("^foo"));
+    BST_REQUIRE(bst::regex_search(utility::string_t(U("foobar")), *regex));
+    BST_REQUIRE(!bst::regex_search(utility::string_t(U("FOOBAR")), *regex));
+
+    // the same regex is returned for the same pattern
+    BST_REQUIRE(regex == utility::make_cached_regex(U("^foo")));
+
+    // but not with different flags
+    const auto icase_regex = utility::make_cached_regex(U("^foo"), true);
+    BST_REQUIRE(regex != icase_regex);
+    BST_REQUIRE(bst::regex_search(utility::string_t(U("FOOBAR")), *icase_regex));
+    BST_REQUIRE(icase_regex == utility::make_cached_regex(U("^foo"), true));
+
+    BST_REQUIRE_THROW(utility::make_cached_regex(U("^foo(")), bst::regex_error);
+}
@@ -1,6 +1,8 @@
 // The first "test" is of course whether the header compiles standalone
 #include "cpprest/ws_listener.h"
 
+#include <condition_variable>
+#include <mutex>
 #include "bst/test/test.h"
 
 BST_TEST_CASE(testWebSocketListenerCloseOpen)
@@ -27,3 +29,62 @@ BST_TEST_CASE(testWebSocketListenerCloseOpen)
     // hmm, ran out of dynamic ports?!
     BST_REQUIRE(false);
 }
+
+BST_TEST_CASE(testWebSocketListenerSendToConnections)
+{
+    using web::websockets::experimental::listener::connection_id;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<connection_id> connections;
+
+    for (auto port = 49152; port <= 65535; ++port)
+    {
+        const auto uri = web::uri_builder(U("ws://localhost")).set_port(port).to_uri();
+        web::websockets::experimental::listener::websocket_listener ws(uri);
+        ws.set_open_handler([&](const web::uri&, const connection_id& connection)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.push_back(connection);
+            condition.notify_all();
+        });
+        try
+        {
+            ws.open().wait();
+        }
+        catch (const web::websockets::websocket_exception&)
+        {
+            // could well be that port is already in use, so just try the next one
+            continue;
+        }
+
+        std::vector<web::websockets::client::websocket_client> clients(3);
+        for (auto& client : clients)
+        {
+            client.connect(uri).wait();
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            BST_REQUIRE(condition.wait_for(lock, std::chrono::seconds(5), [&] { return clients.size() == connections.size(); }));
+        }
+
+        // an invalid connection doesn't prevent the message being sent to the others
+        auto invalid_connections = connections;
+        invalid_connections.push_back({});
+
+        web::websockets::websocket_outgoing_message message;
+        message.set_utf8_message("meow");
+        BST_REQUIRE_THROW(ws.send(invalid_connections, message).wait(), web::websockets::websocket_exception);
+
+        for (auto& client : clients)
+        {
+            BST_REQUIRE_EQUAL("meow", client.receive().get().extract_string().get());
+            client.close().wait();
+        }
+
+        ws.close().wait();
+        return;
+    }
+    // hmm, ran out of dynamic ports?!
+    BST_REQUIRE(false);
+}
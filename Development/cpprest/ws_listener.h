@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #if !defined(_WIN32) || !defined(__cplusplus_winrt)
 #if defined(__clang__)
@@ -97,7 +98,7 @@ namespace web
                 class websocket_listener_config
                 {
                 public:
-                    websocket_listener_config() : m_backlog(0) {}
+                    websocket_listener_config() : m_backlog(0), m_threads(1), m_compression(false), m_compression_level(-1), m_compression_context_takeover(true) {}
 
                     const web::logging::experimental::log_handler& get_log_callback() const
                     {
@@ -119,6 +120,52 @@ namespace web
                         m_backlog = backlog;
                     }
 
+                    // the number of threads used to run the server, or zero for the number of hardware threads
+                    // messages for each connection are still handled in order, on one thread at a time
+                    int threads() const
+                    {
+                        return m_threads;
+                    }
+
+                    void set_threads(int threads)
+                    {
+                        m_threads = threads;
+                    }
+
+                    // whether to accept a client's offer of the permessage-deflate extension (RFC 7692) to compress messages
+                    bool compression() const
+                    {
+                        return m_compression;
+                    }
+
+                    void set_compression(bool compression)
+                    {
+                        m_compression = compression;
+                    }
+
+                    // the zlib compression level, from 0 (no compression) to 9 (best compression), or -1 for the default level
+                    int compression_level() const
+                    {
+                        return m_compression_level;
+                    }
+
+                    void set_compression_level(int compression_level)
+                    {
+                        m_compression_level = compression_level;
+                    }
+
+                    // whether the compression context is retained from one message to the next on each connection
+                    // which generally improves the compression ratio of repetitive messages, at the expense of memory
+                    bool compression_context_takeover() const
+                    {
+                        return m_compression_context_takeover;
+                    }
+
+                    void set_compression_context_takeover(bool compression_context_takeover)
+                    {
+                        m_compression_context_takeover = compression_context_takeover;
+                    }
+
 #if !defined(_WIN32) || !defined(__cplusplus_winrt)
                     const ssl_context_callback& get_ssl_context_callback() const
                     {
@@ -134,6 +181,10 @@ namespace web
                 private:
                     web::logging::experimental::log_handler m_log_callback;
                     int m_backlog;
+                    int m_threads;
+                    bool m_compression;
+                    int m_compression_level;
+                    bool m_compression_context_takeover;
 #if !defined(_WIN32) || !defined(__cplusplus_winrt)
                     ssl_context_callback m_ssl_context_callback;
 #endif
@@ -171,6 +222,11 @@ namespace web
 
                     pplx::task<void> send(const connection_id& connection, websocket_outgoing_message message);
 
+                    // send the same message to each of the specified connections, without waiting for the message to be sent to each one
+                    // if sending to any connection fails, e.g. because it has been closed, the message is still sent to the others
+                    // and the returned task reports the first error
+                    pplx::task<void> send(const std::vector<connection_id>& connections, websocket_outgoing_message message);
+
                     websocket_listener(websocket_listener&& other);
                     websocket_listener& operator=(websocket_listener&& other);
 
@@ -1,7 +1,9 @@
 #include "cpprest/ws_listener.h"
 
+#include <algorithm>
 #include <mutex>
 #include <set>
+#include <thread>
 #include "detail/pragma_warnings.h"
 #include "detail/private_access.h"
 
@@ -16,6 +18,7 @@ __pragma(warning(disable:4701)) // e.g. potentially uninitialized local variable
 #define BOOST_ASIO_DISABLE_BOOST_REGEX
 #include "websocketpp/config/boost_config.hpp"
 #include "websocketpp/config/asio.hpp"
+#include "websocketpp/extensions/permessage_deflate/enabled.hpp"
 #include "websocketpp/logger/levels.hpp"
 #include "websocketpp/server.hpp"
 PRAGMA_WARNING_POP
@@ -110,7 +113,63 @@ namespace web
                         }
                     }
 
-                    // websocketpp config that just overrides the two log types
+                    struct websocketpp_permessage_deflate_config {};
+                    typedef websocketpp::extensions::permessage_deflate::enabled<websocketpp_permessage_deflate_config> websocketpp_permessage_deflate_base;
+
+                    struct websocketpp_permessage_deflate_dstate { typedef z_stream(websocketpp_permessage_deflate_base::*type); };
+
+                    // permessage-deflate extension (RFC 7692) that applies the compression options of the websocket_listener
+                    // WebSocket++ default-constructs the extension for each connection, on one of the threads running the server,
+                    // so the options are made available via a thread-local pointer that is set by each of those threads
+                    class websocketpp_permessage_deflate : public websocketpp_permessage_deflate_base
+                    {
+                    public:
+                        static thread_local const websocket_listener_config* current_config;
+
+                        websocketpp_permessage_deflate()
+                            : compression(nullptr != current_config && current_config->compression())
+                            , compression_level(nullptr != current_config ? current_config->compression_level() : Z_DEFAULT_COMPRESSION)
+                            , compression_context_takeover(nullptr == current_config || current_config->compression_context_takeover())
+                        {}
+
+                        // hides websocketpp_permessage_deflate_base::negotiate, since the processor uses the derived type
+                        websocketpp::err_str_pair negotiate(const websocketpp::http::attribute_list& offer)
+                        {
+                            if (!compression)
+                            {
+                                return{ websocketpp::extensions::error::make_error_code(websocketpp::extensions::error::disabled), {} };
+                            }
+                            if (!compression_context_takeover)
+                            {
+                                enable_server_no_context_takeover();
+                            }
+                            return websocketpp_permessage_deflate_base::negotiate(offer);
+                        }
+
+                        // hides websocketpp_permessage_deflate_base::init, in order to set the compression level before any message is compressed
+                        websocketpp::lib::error_code init(bool is_server)
+                        {
+                            auto ec = websocketpp_permessage_deflate_base::init(is_server);
+                            if (!ec && Z_DEFAULT_COMPRESSION != compression_level)
+                            {
+                                auto& dstate = this->*detail::stowed<websocketpp_permessage_deflate_dstate>::value;
+                                if (Z_OK != deflateParams(&dstate, compression_level, Z_DEFAULT_STRATEGY))
+                                {
+                                    ec = websocketpp::extensions::permessage_deflate::error::make_error_code(websocketpp::extensions::permessage_deflate::error::zlib_error);
+                                }
+                            }
+                            return ec;
+                        }
+
+                    private:
+                        bool compression;
+                        int compression_level;
+                        bool compression_context_takeover;
+                    };
+
+                    thread_local const websocket_listener_config* websocketpp_permessage_deflate::current_config = nullptr;
+
+                    // websocketpp config that just overrides the two log types, and enables the permessage-deflate extension
                     template <typename Base>
                     struct websocketpp_config : Base
                     {
@@ -143,6 +202,8 @@ namespace web
 
                         typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
 
+                        typedef websocketpp_permessage_deflate permessage_deflate_type;
+
                         // reminder: these compile-time filters can be adjusted
                         static const websocketpp::log::level elog_level = base::elog_level;
                         static const websocketpp::log::level alog_level = base::alog_level;
@@ -228,6 +289,7 @@ namespace web
                         virtual pplx::task<void> close(const connection_id& connection, websocket_close_status close_status, const utility::string_t& close_reason) = 0;
                         virtual pplx::task<void> close(websocket_close_status close_status, const utility::string_t& close_reason) = 0;
                         virtual pplx::task<void> send(const connection_id& connection, websocket_outgoing_message message) = 0;
+                        virtual pplx::task<void> send(const std::vector<connection_id>& connections, websocket_outgoing_message message) = 0;
 
                     protected:
                         // extend friendship with connection_id to derived classes
@@ -325,8 +387,17 @@ namespace web
 #endif
                                 }
                                 server.start_perpetual();
-                                // hmm, is one thread enough?
-                                thread = std::thread(&server_t::run, &server);
+                                // the asio transport uses a strand for each connection, so that its handlers are never run concurrently
+                                // even when there are several threads
+                                const int thread_count = 0 < configuration().threads() ? configuration().threads() : (std::max)(1, (int)std::thread::hardware_concurrency());
+                                for (int i = 0; i < thread_count; ++i)
+                                {
+                                    threads.push_back(std::thread([this]
+                                    {
+                                        websocketpp_permessage_deflate::current_config = &configuration();
+                                        server.run();
+                                    }));
+                                }
 
                                 using websocketpp::lib::bind;
                                 using websocketpp::lib::placeholders::_1;
@@ -442,18 +513,12 @@ namespace web
                             catch (const websocketpp::exception& e)
                             {
                                 server.stop_perpetual();
-                                if (thread.joinable())
-                                {
-                                    thread.join();
-                                }
+                                join_threads();
                                 return pplx::task_from_exception<void>(websocket_exception(e.code(), build_error_msg(e.code(), "close")));
                             }
 
                             server.stop_perpetual();
-                            if (thread.joinable())
-                            {
-                                thread.join();
-                            }
+                            join_threads();
                             return pplx::task_from_result();
                         }
 
@@ -473,8 +538,10 @@ namespace web
 
                             try
                             {
-                                // send will throw if the connection_hdl isn't valid
-                                server.send(hdl_from_id(connection), ptr, count, websocketpp::frame::opcode::text);
+                                // send will fail if the connection_hdl isn't valid
+                                websocketpp::lib::error_code ec;
+                                send_text(hdl_from_id(connection), ptr, count, ec);
+                                if (ec) throw websocketpp::exception(ec);
                             }
                             catch (const websocketpp::exception& e)
                             {
@@ -486,10 +553,66 @@ namespace web
                             return pplx::task_from_result();
                         }
 
+                        pplx::task<void> send(const std::vector<connection_id>& connections, websocket_outgoing_message message)
+                        {
+                            // the message body is only acquired once, however many connections it is sent to
+                            auto body = get_message_body(message);
+                            uint8_t* ptr = nullptr;
+                            size_t count = 0;
+                            bool acquired = body.acquire(ptr, count);
+                            if (!acquired || nullptr == ptr || 0 == count)
+                            {
+                                return pplx::task_from_exception<void>(websocket_exception("Invalid message body"));
+                            }
+
+                            // send only queues the message to be written by the server thread, so doesn't wait for each connection
+                            websocketpp::lib::error_code ec;
+                            for (const auto& connection : connections)
+                            {
+                                // send will fail if the connection_hdl isn't valid
+                                websocketpp::lib::error_code con_ec;
+                                send_text(hdl_from_id(connection), ptr, count, con_ec);
+                                if (!ec && con_ec) ec = con_ec;
+                            }
+
+                            body.release(ptr, count);
+
+                            if (ec)
+                            {
+                                return pplx::task_from_exception<void>(websocket_exception(ec, build_error_msg(ec, "send")));
+                            }
+                            return pplx::task_from_result();
+                        }
+
                     private:
                         typedef websocketpp::server<WsppConfig> server_t;
                         typedef std::set<websocketpp::connection_hdl, std::owner_less<websocketpp::connection_hdl>> connections_t;
 
+                        // like server.send, but the message is marked as compressible, which only has an effect when
+                        // the permessage-deflate extension has been negotiated for the connection
+                        void send_text(websocketpp::connection_hdl hdl, const uint8_t* ptr, size_t count, websocketpp::lib::error_code& ec)
+                        {
+                            auto con = server.get_con_from_hdl(hdl, ec);
+                            if (ec) return;
+
+                            auto msg = con->get_message(websocketpp::frame::opcode::text, count);
+                            msg->append_payload(ptr, count);
+                            msg->set_compressed(true);
+                            ec = con->send(msg);
+                        }
+
+                        void join_threads()
+                        {
+                            for (auto& thread : threads)
+                            {
+                                if (thread.joinable())
+                                {
+                                    thread.join();
+                                }
+                            }
+                            threads.clear();
+                        }
+
                         web::uri uri_from_hdl(websocketpp::connection_hdl hdl)
                         {
                             return web::uri(utility::conversions::to_string_t(server.get_con_from_hdl(hdl)->get_uri()->str()));
@@ -634,7 +757,7 @@ namespace web
                             }
                         }
 
-                        std::thread thread;
+                        std::vector<std::thread> threads;
                         server_t server;
                         connections_t connections;
                         std::mutex mutex;
@@ -736,6 +859,11 @@ namespace web
                     return impl->send(connection, message);
                 }
 
+                pplx::task<void> websocket_listener::send(const std::vector<connection_id>& connections, websocket_outgoing_message message)
+                {
+                    return impl->send(connections, message);
+                }
+
                 const web::uri& websocket_listener::uri() const
                 {
                     return impl->uri();
@@ -755,3 +883,4 @@ template struct detail::stow_private<web::websockets::experimental::listener::de
 template struct detail::stow_private<web::websockets::experimental::listener::details::websocket_incoming_message_body, &web::websockets::websocket_incoming_message::m_body>;
 template struct detail::stow_private<web::websockets::experimental::listener::details::websocket_incoming_message_msg_type, &web::websockets::websocket_incoming_message::m_msg_type>;
 template struct detail::stow_private<web::websockets::experimental::listener::details::websocketpp_http_parser_parser_headers, &websocketpp::http::parser::parser::m_headers>;
+template struct detail::stow_private<web::websockets::experimental::listener::details::websocketpp_permessage_deflate_dstate, &web::websockets::experimental::listener::details::websocketpp_permessage_deflate_base::m_dstate>;
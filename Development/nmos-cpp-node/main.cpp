@@ -64,6 +64,7 @@ int main(int argc, char* argv[])
         // copy to the logging settings
         // hmm, this is a bit icky, but simplest for now
         log_model.settings = node_model.settings;
+        log_model.update_settings_snapshot();
 
         // the logging level is a special case because we want to turn it into an atomic value
         // that can be read by logging statements without locking the mutex protecting the settings
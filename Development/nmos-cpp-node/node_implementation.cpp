@@ -990,6 +990,7 @@ nmos::system_global_handler make_node_implementation_system_global_handler(nmos:
 
             auto system_global_settings = nmos::parse_system_global_data(system_global).second;
             web::json::merge_patch(model.settings, system_global_settings, true);
+            model.update_settings_snapshot();
         }
         else
         {
@@ -1195,7 +1196,7 @@ nmos::connection_sender_transportfile_setter make_node_implementation_transportf
 }
 
 // Example Events WebSocket API client message handler
-nmos::events_ws_message_handler make_node_implementation_events_ws_message_handler(const nmos::node_model& model, slog::base_gate& gate)
+nmos::events_ws_message_handler make_node_implementation_events_ws_message_handler(const nmos::node_model& model, std::shared_ptr<const nmos::experimental::events_ws_receiver_routes> routes, slog::base_gate& gate)
 {
     const auto seed_id = nmos::experimental::fields::seed_id(model.settings);
     const auto how_many = impl::fields::how_many(model.settings);
@@ -1206,7 +1207,7 @@ nmos::events_ws_message_handler make_node_implementation_events_ws_message_handl
     // the message handler will be used for all Events WebSocket connections, and each connection may potentially
     // have subscriptions to a number of sources, for multiple receivers, so this example uses a handler adaptor
     // that enables simple processing of "state" messages (events) per receiver
-    return nmos::experimental::make_events_ws_message_handler(model, [ws_receiver_ids, &gate](const nmos::resource& receiver, const nmos::resource& connection_receiver, const web::json::value& message)
+    return nmos::experimental::make_events_ws_message_handler(model, routes, [ws_receiver_ids, &gate](const nmos::resource& receiver, const nmos::resource& connection_receiver, const web::json::value& message)
     {
         const auto found = boost::range::find(ws_receiver_ids, connection_receiver.id);
         if (ws_receiver_ids.end() != found)
@@ -1238,9 +1239,12 @@ nmos::connection_activation_handler make_node_implementation_connection_activati
     // this example uses this callback to (un)subscribe a IS-07 Events WebSocket receiver when it is activated
     // and, in addition to the message handler, specifies the optional close handler in order that any subsequent
     // connection errors are reflected into the /active endpoint by setting master_enable to false
-    auto handle_events_ws_message = make_node_implementation_events_ws_message_handler(model, gate);
-    auto handle_close = nmos::experimental::make_events_ws_close_handler(model, gate);
-    auto connection_events_activation_handler = nmos::make_connection_events_websocket_activation_handler(handle_load_ca_certificates, handle_events_ws_message, handle_close, model.settings, gate);
+    // the routes from each connection URI and source id to the subscribed receivers are maintained on activation
+    // so that the message and close handlers need not consider every receiver
+    auto routes = std::make_shared<nmos::experimental::events_ws_receiver_routes>();
+    auto handle_events_ws_message = make_node_implementation_events_ws_message_handler(model, routes, gate);
+    auto handle_close = nmos::experimental::make_events_ws_close_handler(model, routes, gate);
+    auto connection_events_activation_handler = nmos::make_connection_events_websocket_activation_handler(handle_load_ca_certificates, handle_events_ws_message, handle_close, routes, model.settings, gate);
 
     return [connection_events_activation_handler, &gate](const nmos::resource& resource, const nmos::resource& connection_resource)
     {
@@ -1,5 +1,6 @@
 #include "nmos/activation_utils.h"
 
+#include <algorithm>
 #include "cpprest/basic_utils.h"
 #include "nmos/activation_mode.h"
 #include "nmos/json_fields.h"
@@ -251,5 +252,77 @@ namespace nmos
             slog::log<slog::severities::too_much_info>(gate, SLOG_FLF) << "Notifying API - immediate activation completed";
             model.notify();
         }
+
+        // schedule or reschedule the activation of the specified resource
+        void activation_schedule::insert(const id_type& id, const tai_clock::time_point& activation_time)
+        {
+            auto found = scheduled.find(id);
+            if (scheduled.end() != found)
+            {
+                if (activation_time == found->second) return;
+                found->second = activation_time;
+            }
+            else
+            {
+                scheduled.insert({ id, activation_time });
+            }
+
+            heap.push_back({ activation_time, id });
+            std::push_heap(heap.begin(), heap.end(), std::greater<entry>());
+
+            // since rescheduled or cancelled activations are only discarded lazily, rebuild the heap
+            // if stale entries dominate, in order to bound its size when activations are repeatedly staged
+            if (heap.size() > 2 * scheduled.size() + 16)
+            {
+                heap.clear();
+                for (const auto& activation : scheduled)
+                {
+                    heap.push_back({ activation.second, activation.first });
+                }
+                std::make_heap(heap.begin(), heap.end(), std::greater<entry>());
+            }
+        }
+
+        // cancel any scheduled activation of the specified resource
+        void activation_schedule::erase(const id_type& id)
+        {
+            scheduled.erase(id);
+        }
+
+        // remove and return the resources whose activations are due at the specified time, in order of activation time
+        std::vector<activation_schedule::id_type> activation_schedule::pop_due(const tai_clock::time_point& now)
+        {
+            std::vector<id_type> due;
+
+            for (pop_stale(); !heap.empty() && heap.front().first <= now; pop_stale())
+            {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<entry>());
+                scheduled.erase(heap.back().second);
+                due.push_back(std::move(heap.back().second));
+                heap.pop_back();
+            }
+
+            return due;
+        }
+
+        // the time of the next scheduled activation, or tai_clock::time_point::max() if there is none
+        tai_clock::time_point activation_schedule::earliest()
+        {
+            pop_stale();
+            return !heap.empty() ? heap.front().first : (tai_clock::time_point::max)();
+        }
+
+        // discard entries for activations that have since been rescheduled or cancelled from the top of the heap
+        void activation_schedule::pop_stale()
+        {
+            while (!heap.empty())
+            {
+                const auto found = scheduled.find(heap.front().second);
+                if (scheduled.end() != found && found->second == heap.front().first) break;
+
+                std::pop_heap(heap.begin(), heap.end(), std::greater<entry>());
+                heap.pop_back();
+            }
+        }
     }
 }
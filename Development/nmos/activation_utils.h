@@ -1,8 +1,11 @@
 #ifndef NMOS_ACTIVATION_UTILS_H
 #define NMOS_ACTIVATION_UTILS_H
 
+#include <map>
+#include <vector>
 #include "nmos/id.h"
 #include "nmos/mutex.h" // forward declarations of nmos::read_lock, nmos::write_lock
+#include "nmos/tai.h"
 #include "nmos/type.h"
 
 namespace web
@@ -21,7 +24,6 @@ namespace slog
 namespace nmos
 {
     struct node_model;
-    struct tai;
 
     // Construct a 'not pending' activation response object with all null values
     web::json::value make_activation();
@@ -44,6 +46,41 @@ namespace nmos
         bool wait_immediate_activation_not_pending(nmos::node_model& model, nmos::write_lock& lock, const std::pair<nmos::id, nmos::type>& id_type);
 
         void handle_immediate_activation_pending(nmos::node_model& model, nmos::write_lock& lock, const std::pair<nmos::id, nmos::type>& id_type, web::json::value& response_activation, slog::base_gate& gate);
+
+        // Pending scheduled activations, in order of activation time, so that the activation threads only need to examine
+        // the resources updated since they last ran, rather than all the resources, to determine the next activation
+        // See nmos::connection_activation_thread and nmos::channelmapping_activation_thread
+        class activation_schedule
+        {
+        public:
+            typedef std::pair<nmos::id, nmos::type> id_type;
+
+            // schedule or reschedule the activation of the specified resource
+            void insert(const id_type& id, const tai_clock::time_point& activation_time);
+
+            // cancel any scheduled activation of the specified resource
+            void erase(const id_type& id);
+
+            // remove and return the resources whose activations are due at the specified time, in order of activation time
+            std::vector<id_type> pop_due(const tai_clock::time_point& now);
+
+            // the time of the next scheduled activation, or tai_clock::time_point::max() if there is none
+            tai_clock::time_point earliest();
+
+            bool empty() const { return scheduled.empty(); }
+            std::size_t size() const { return scheduled.size(); }
+
+        private:
+            typedef std::pair<tai_clock::time_point, id_type> entry;
+
+            // discard entries for activations that have since been rescheduled or cancelled from the top of the heap
+            void pop_stale();
+
+            // a min-heap of activations, which may include stale entries
+            std::vector<entry> heap;
+            // the current activation time of each resource with a scheduled activation
+            std::map<id_type, tai_clock::time_point> scheduled;
+        };
     }
 }
 
@@ -1,6 +1,7 @@
 #include "nmos/api_downgrade.h"
 
 #include <map>
+#include <unordered_set>
 #include "nmos/is04_versions.h"
 #include "nmos/resource.h"
 
@@ -129,6 +130,60 @@ namespace nmos
         return resources_versions;
     }
 
+    namespace details
+    {
+        // the top-level properties of a resource type which are permitted in each API version, i.e. those added in that version or earlier
+        typedef std::unordered_set<utility::string_t> downgrade_plan;
+
+        // the plans are made once for each resource type and each version in resources_versions, so that downgrading a resource
+        // only needs to look up each of its own properties once, rather than every property of every earlier version
+        static const downgrade_plan& get_downgrade_plan(const nmos::type& resource_type, const nmos::api_version& version)
+        {
+            static const std::map<nmos::type, std::map<nmos::api_version, downgrade_plan>> plans = []
+            {
+                std::map<nmos::type, std::map<nmos::api_version, downgrade_plan>> plans;
+                for (const auto& resource_versions : resources_versions())
+                {
+                    auto& type_plans = plans[resource_versions.first];
+                    downgrade_plan properties;
+                    for (const auto& version_properties : resource_versions.second)
+                    {
+                        properties.insert(version_properties.second.begin(), version_properties.second.end());
+                        type_plans[version_properties.first] = properties;
+                    }
+                }
+                return plans;
+            }();
+            static const downgrade_plan no_properties;
+
+            auto& type_plans = plans.at(resource_type);
+            auto found = type_plans.upper_bound(version);
+            if (type_plans.begin() == found) return no_properties;
+            return (--found)->second;
+        }
+
+        static bool is_unchanged_by_downgrade(const downgrade_plan& plan, const web::json::value& resource_data)
+        {
+            if (!resource_data.is_object()) return false;
+            for (const auto& field : resource_data.as_object())
+            {
+                if (0 == plan.count(field.first)) return false;
+            }
+            return true;
+        }
+
+        bool is_unchanged_by_downgrade(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data, const nmos::api_version& version, const nmos::api_version& downgrade_version)
+        {
+            if (!is_permitted_downgrade(resource_version, resource_downgrade_version, resource_type, version, downgrade_version)) return false;
+
+            if (resource_data.is_null()) return true;
+
+            if (resource_version <= version) return true;
+
+            return is_unchanged_by_downgrade(get_downgrade_plan(resource_type, version), resource_data);
+        }
+    }
+
     web::json::value downgrade(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data, const nmos::api_version& version, const nmos::api_version& downgrade_version)
     {
         if (!is_permitted_downgrade(resource_version, resource_downgrade_version, resource_type, version, downgrade_version)) return web::json::value::null();
@@ -139,8 +194,6 @@ namespace nmos
         // optimisation for the common case (old-versioned resources, if being permitted, do not get upgraded)
         if (resource_version <= version) return resource_data;
 
-        web::json::value result;
-
         // This is a simple representation of the backwards-compatible changes that have been made between minor versions
         // of the specification. It just describes in which version each top-level property of each resource type was added.
 
@@ -153,16 +206,20 @@ namespace nmos
         // sub-objects of a node and of "authorization" in node "api.endpoints" and "services" and device "controls".
         // See https://github.com/AMWA-TV/is-04/pull/109/files#diff-251d9acc57a6ffaeed673153c6409f5f
 
-        auto& resource_versions = resources_versions().at(resource_type);
-        auto version_first = resource_versions.cbegin();
-        auto version_last = resource_versions.upper_bound(version);
-        for (auto version_properties = version_first; version_last != version_properties; ++version_properties)
+        const auto& plan = details::get_downgrade_plan(resource_type, version);
+
+        // optimisation for a higher-versioned resource which doesn't have any of the properties added in the higher version
+        if (details::is_unchanged_by_downgrade(plan, resource_data)) return resource_data;
+
+        web::json::value result;
+
+        if (resource_data.is_object())
         {
-            for (auto& property : version_properties->second)
+            for (const auto& field : resource_data.as_object())
             {
-                if (resource_data.has_field(property))
+                if (0 != plan.count(field.first))
                 {
-                    result[property] = resource_data.at(property);
+                    result[field.first] = field.second;
                 }
             }
         }
@@ -22,6 +22,9 @@ namespace nmos
         utility::string_t make_permitted_downgrade_error(const nmos::resource& resource, const nmos::api_version& version);
         utility::string_t make_permitted_downgrade_error(const nmos::resource& resource, const nmos::api_version& version, const nmos::api_version& downgrade_version);
         utility::string_t make_permitted_downgrade_error(const nmos::api_version& resource_version, const nmos::type& resource_type, const nmos::api_version& version, const nmos::api_version& downgrade_version);
+
+        // determine whether the downgrade is permitted and would return the resource data unchanged, in which case the data can be used directly, without a copy
+        bool is_unchanged_by_downgrade(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data, const nmos::api_version& version, const nmos::api_version& downgrade_version);
     }
 
     web::json::value downgrade(const nmos::resource& resource, const nmos::api_version& version);
@@ -1,7 +1,8 @@
 #include "nmos/capabilities.h"
 
+#include <algorithm>
+#include <cmath>
 #include <boost/range/adaptor/transformed.hpp>
-#include "cpprest/regex_utils.h"
 #include "nmos/json_fields.h"
 
 namespace nmos
@@ -103,10 +104,10 @@ namespace nmos
         {
             if (constraint.has_field(nmos::fields::constraint_pattern))
             {
-                const utility::regex_t regex(nmos::fields::constraint_pattern(constraint));
-                utility::smatch_t match;
                 // throws bst::regex_error if pattern is invalid
-                if (!bst::regex_search(value, match, regex))
+                const auto regex = utility::make_cached_regex(nmos::fields::constraint_pattern(constraint));
+                utility::smatch_t match;
+                if (!bst::regex_search(value, match, *regex))
                 {
                     return false;
                 }
@@ -171,4 +172,167 @@ namespace nmos
             throw web::json::json_exception("not a valid constraint target type");
         }
     }
+
+    namespace details
+    {
+        static constraint_limit make_constraint_limit(const web::json::value& limit)
+        {
+            constraint_limit result;
+            if (limit.is_integer())
+            {
+                result.kind = constraint_limit::integer;
+                result.integer = limit.as_number().to_int64();
+                result.number = limit.as_double();
+            }
+            else if (limit.is_double())
+            {
+                result.kind = constraint_limit::number;
+                result.number = limit.as_double();
+            }
+            else if (nmos::is_rational(limit))
+            {
+                result.kind = constraint_limit::rational;
+                result.rational = nmos::parse_rational(limit);
+            }
+            return result;
+        }
+
+        // a limit of a different kind does not apply
+        // returns -1, 0 or +1, like a three-way comparison of the value with the limit
+        static int compare_limit(int64_t value, const constraint_limit& limit)
+        {
+            if (constraint_limit::integer == limit.kind) return value < limit.integer ? -1 : limit.integer < value ? 1 : 0;
+            if (constraint_limit::number == limit.kind) return (double)value < limit.number ? -1 : limit.number < (double)value ? 1 : 0;
+            return 0;
+        }
+
+        static int compare_limit(double value, const constraint_limit& limit)
+        {
+            if (constraint_limit::integer == limit.kind || constraint_limit::number == limit.kind) return value < limit.number ? -1 : limit.number < value ? 1 : 0;
+            return 0;
+        }
+
+        static int compare_limit(const nmos::rational& value, const constraint_limit& limit)
+        {
+            if (constraint_limit::rational == limit.kind) return value < limit.rational ? -1 : limit.rational < value ? 1 : 0;
+            return 0;
+        }
+
+        template <typename T>
+        static bool match_limits(const T& value, const constraint_limit& minimum, const constraint_limit& maximum)
+        {
+            return compare_limit(value, minimum) >= 0 && compare_limit(value, maximum) <= 0;
+        }
+
+        static bool is_integral(double value)
+        {
+            return std::trunc(value) == value && -9.2e18 < value && value < 9.2e18;
+        }
+    }
+
+    compiled_constraint::compiled_constraint()
+        : has_enum(false)
+        , enum_false(false)
+        , enum_true(false)
+        , enum_null(false)
+    {}
+
+    compiled_constraint::compiled_constraint(const web::json::value& constraint)
+        : compiled_constraint()
+    {
+        if (constraint.has_field(nmos::fields::constraint_enum))
+        {
+            has_enum = true;
+            for (const auto& enum_value : nmos::fields::constraint_enum(constraint).as_array())
+            {
+                if (enum_value.is_string()) enum_strings.insert(enum_value.as_string());
+                else if (enum_value.is_integer()) enum_integers.insert(enum_value.as_number().to_int64());
+                else if (enum_value.is_double()) enum_numbers.insert(enum_value.as_double());
+                else if (enum_value.is_boolean() && enum_value.as_bool()) enum_true = true;
+                else if (enum_value.is_boolean()) enum_false = true;
+                else if (enum_value.is_null()) enum_null = true;
+                else if (nmos::is_rational(enum_value)) enum_rationals.insert(nmos::parse_rational(enum_value));
+                else enum_others.push_back(enum_value);
+            }
+        }
+        if (constraint.has_field(nmos::fields::constraint_minimum))
+        {
+            minimum = details::make_constraint_limit(nmos::fields::constraint_minimum(constraint));
+        }
+        if (constraint.has_field(nmos::fields::constraint_maximum))
+        {
+            maximum = details::make_constraint_limit(nmos::fields::constraint_maximum(constraint));
+        }
+        if (constraint.has_field(nmos::fields::constraint_pattern))
+        {
+            // throws bst::regex_error if pattern is invalid
+            pattern = utility::make_cached_regex(nmos::fields::constraint_pattern(constraint));
+        }
+    }
+
+    bool compiled_constraint::match_string(const utility::string_t& value) const
+    {
+        if (has_enum && enum_strings.end() == enum_strings.find(value)) return false;
+        if (pattern)
+        {
+            utility::smatch_t match;
+            if (!bst::regex_search(value, match, *pattern)) return false;
+        }
+        return true;
+    }
+
+    bool compiled_constraint::match_integer(int64_t value) const
+    {
+        if (has_enum && enum_integers.end() == enum_integers.find(value) && enum_numbers.end() == enum_numbers.find((double)value)) return false;
+        return details::match_limits(value, minimum, maximum);
+    }
+
+    bool compiled_constraint::match_number(double value) const
+    {
+        if (has_enum && enum_numbers.end() == enum_numbers.find(value) && !(details::is_integral(value) && enum_integers.end() != enum_integers.find((int64_t)value))) return false;
+        return details::match_limits(value, minimum, maximum);
+    }
+
+    bool compiled_constraint::match_boolean(bool value) const
+    {
+        return !has_enum || (value ? enum_true : enum_false);
+    }
+
+    bool compiled_constraint::match_rational(const nmos::rational& value) const
+    {
+        if (has_enum && enum_rationals.end() == enum_rationals.find(value)) return false;
+        return details::match_limits(value, minimum, maximum);
+    }
+
+    bool compiled_constraint::match(const web::json::value& value) const
+    {
+        if (value.is_string())
+        {
+            return match_string(value.as_string());
+        }
+        else if (value.is_integer())
+        {
+            return match_integer(value.as_number().to_int64());
+        }
+        else if (value.is_double())
+        {
+            return match_number(value.as_double());
+        }
+        else if (value.is_boolean())
+        {
+            return match_boolean(value.as_bool());
+        }
+        else if (value.is_null())
+        {
+            return !has_enum || enum_null;
+        }
+        else if (nmos::is_rational(value))
+        {
+            return match_rational(nmos::parse_rational(value));
+        }
+        else
+        {
+            return !has_enum || enum_others.end() != std::find(enum_others.begin(), enum_others.end(), value);
+        }
+    }
 }
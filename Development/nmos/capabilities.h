@@ -1,7 +1,11 @@
 #ifndef NMOS_CAPABILITIES_H
 #define NMOS_CAPABILITIES_H
 
+#include <memory>
+#include <set>
+#include <unordered_set>
 #include "cpprest/json_utils.h"
+#include "cpprest/regex_utils.h"
 #include "nmos/rational.h"
 
 namespace nmos
@@ -41,6 +45,57 @@ namespace nmos
     bool match_rational_constraint(const nmos::rational& value, const web::json::value& constraint);
     bool match_constraint(const web::json::value& value, const web::json::value& constraint);
 
+    namespace details
+    {
+        // a minimum or maximum constraint, as a native number
+        struct constraint_limit
+        {
+            enum kind_t { none, integer, number, rational };
+
+            constraint_limit() : kind(none), integer(0), number(0) {}
+
+            kind_t kind;
+            int64_t integer;
+            double number;
+            nmos::rational rational;
+        };
+    }
+
+    // A constraint, compiled once to be matched against many values, with its enum values in hash sets,
+    // its minimum and maximum as native numbers, and its pattern as a regex
+    // Matching is like the functions above, except that comparisons between integers and numbers are exact,
+    // and a value of any other type, e.g. null, only has to match the enum values, like JSON Schema
+    class compiled_constraint
+    {
+    public:
+        compiled_constraint();
+        // throws bst::regex_error if the pattern is invalid
+        explicit compiled_constraint(const web::json::value& constraint);
+
+        bool match_string(const utility::string_t& value) const;
+        bool match_integer(int64_t value) const;
+        bool match_number(double value) const;
+        bool match_boolean(bool value) const;
+        bool match_rational(const nmos::rational& value) const;
+        bool match(const web::json::value& value) const;
+
+    private:
+        bool has_enum;
+        std::unordered_set<utility::string_t> enum_strings;
+        std::unordered_set<int64_t> enum_integers;
+        std::unordered_set<double> enum_numbers;
+        std::set<nmos::rational> enum_rationals;
+        bool enum_false;
+        bool enum_true;
+        bool enum_null;
+        std::vector<web::json::value> enum_others;
+
+        details::constraint_limit minimum;
+        details::constraint_limit maximum;
+
+        std::shared_ptr<const utility::regex_t> pattern;
+    };
+
     // NMOS Parameter Registers - Capabilities register
     // See https://specs.amwa.tv/nmos-parameter-registers/branches/main/capabilities/
     namespace caps
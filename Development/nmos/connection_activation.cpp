@@ -1,7 +1,8 @@
 #include "nmos/connection_activation.h"
 
-#include "detail/for_each_reversed.h"
+#include <algorithm>
 #include "nmos/activation_mode.h"
+#include "nmos/activation_utils.h"
 #include "nmos/connection_api.h" // for nmos::set_connection_resource_active, etc.
 #include "nmos/model.h"
 #include "nmos/slog.h"
@@ -16,6 +17,9 @@ namespace nmos
         auto most_recent_update = nmos::tai_min();
         auto earliest_scheduled_activation = (nmos::tai_clock::time_point::max)();
 
+        // pending scheduled activations, updated incrementally from the connection resources which have been updated
+        details::activation_schedule schedule;
+
         for (;;)
         {
             // wait for the thread to be interrupted because there may be new scheduled activations, or immediate activations to process
@@ -26,29 +30,36 @@ namespace nmos
 
             auto& by_updated = model.connection_resources.get<nmos::tags::updated>();
 
-            // go through all connection resources
-            // process any immediate activations
-            // process any scheduled activations whose requested_time has passed
-            // identify the next scheduled activation
-
-            const auto now = nmos::tai_clock::now();
-
-            earliest_scheduled_activation = (nmos::tai_clock::time_point::max)();
+            // go through the connection resources which have been updated since last time
+            // identify any immediate activations, and any new, modified or cancelled scheduled activations
+            // then process the immediate activations and any scheduled activations whose requested_time has passed
+            // and identify the next scheduled activation
 
-            bool notify = false;
+            std::vector<std::pair<nmos::id, nmos::type>> activations;
 
-            // since modify reorders the resource in this index, use for_each_reversed
-            detail::for_each_reversed(by_updated.begin(), by_updated.end(), [&](const nmos::resource& resource)
+            // the updated index is in order of most recent update first
+            for (auto it = by_updated.begin(); by_updated.end() != it && most_recent_update < it->updated; ++it)
             {
-                if (!resource.has_data()) return;
+                const auto& resource = *it;
 
                 const std::pair<nmos::id, nmos::type> id_type{ resource.id, resource.type };
 
+                if (!resource.has_data())
+                {
+                    schedule.erase(id_type);
+                    continue;
+                }
+
                 auto& staged = nmos::fields::endpoint_staged(resource.data);
                 auto& staged_activation = nmos::fields::activation(staged);
                 auto& staged_mode_or_null = nmos::fields::mode(staged_activation);
 
-                if (staged_mode_or_null.is_null()) return;
+                if (staged_mode_or_null.is_null())
+                {
+                    // any scheduled activation has been cancelled, or processed
+                    schedule.erase(id_type);
+                    continue;
+                }
 
                 const nmos::activation_mode staged_mode{ staged_mode_or_null.as_string() };
 
@@ -56,36 +67,48 @@ namespace nmos
                     nmos::activation_modes::activate_scheduled_relative == staged_mode)
                 {
                     auto& staged_activation_time = nmos::fields::activation_time(staged_activation);
-                    const auto scheduled_activation = nmos::time_point_from_tai(nmos::parse_version(staged_activation_time.as_string()));
+                    schedule.insert(id_type, nmos::time_point_from_tai(nmos::parse_version(staged_activation_time.as_string())));
+                    continue;
+                }
 
-                    if (scheduled_activation < now)
-                    {
-                        slog::log<slog::severities::info>(gate, SLOG_FLF) << "Processing scheduled activation for " << id_type;
-                    }
-                    else
-                    {
-                        if (scheduled_activation < earliest_scheduled_activation)
-                        {
-                            earliest_scheduled_activation = scheduled_activation;
-                        }
+                schedule.erase(id_type);
 
-                        return;
-                    }
-                }
-                else if (nmos::activation_modes::activate_immediate == staged_mode)
+                if (nmos::activation_modes::activate_immediate == staged_mode)
                 {
                     // check for cancelled in-flight immediate activation
-                    if (nmos::fields::requested_time(staged_activation).is_null()) return;
+                    if (nmos::fields::requested_time(staged_activation).is_null()) continue;
                     // check for processed in-flight immediate activation
-                    if (!nmos::fields::activation_time(staged_activation).is_null()) return;
+                    if (!nmos::fields::activation_time(staged_activation).is_null()) continue;
 
                     slog::log<slog::severities::info>(gate, SLOG_FLF) << "Processing immediate activation for " << id_type;
+                    activations.push_back(id_type);
                 }
                 else
                 {
                     slog::log<slog::severities::severe>(gate, SLOG_FLF) << "Unexpected activation mode for " << id_type;
-                    return;
                 }
+            }
+
+            // process immediate activations in the order they were requested
+            std::reverse(activations.begin(), activations.end());
+
+            const auto now = nmos::tai_clock::now();
+
+            for (auto& id_type : schedule.pop_due(now))
+            {
+                slog::log<slog::severities::info>(gate, SLOG_FLF) << "Processing scheduled activation for " << id_type;
+                activations.push_back(std::move(id_type));
+            }
+
+            earliest_scheduled_activation = schedule.earliest();
+
+            bool notify = false;
+
+            for (const auto& id_type : activations)
+            {
+                const auto found = find_resource(model.connection_resources, id_type);
+                if (model.connection_resources.end() == found || !found->has_data()) continue;
+                const auto& resource = *found;
 
                 const auto activation_time = nmos::tai_now();
 
@@ -189,7 +212,7 @@ namespace nmos
                 }
 
                 notify = true;
-            });
+            }
 
             if ((nmos::tai_clock::time_point::max)() != earliest_scheduled_activation)
             {
@@ -1,5 +1,7 @@
 #include "nmos/connection_api.h"
 
+#include <exception>
+#include <mutex>
 #include <boost/range/join.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 #include "cpprest/http_utils.h"
@@ -8,6 +10,7 @@
 #include "nmos/activation_utils.h"
 #include "nmos/api_downgrade.h"
 #include "nmos/api_utils.h"
+#include "nmos/capabilities.h"
 #include "nmos/is04_versions.h"
 #include "nmos/is05_versions.h"
 #include "nmos/json_schema.h"
@@ -285,23 +288,169 @@ namespace nmos
             }, keep_order);
         }
 
-        // Validate staged endpoint against constraints
-        void validate_staged_constraints(const nmos::type& type, const web::json::value& constraints, const nmos::transport& transport_base, const web::json::value& staged)
+        // The constraints of a connection resource, compiled for validating many staged endpoints
+        struct compiled_connection_constraints
         {
-            const auto schema = make_constraints_schema(type, constraints, transport_base);
-            const auto uri = web::uri{ U("/constraints") };
+            // what was compiled, to determine whether it is still current
+            nmos::type type;
+            nmos::tai updated;
+            nmos::transport transport_base;
+
+            // the constraint on each transport parameter, for each leg, and whether the parameter supports "auto"
+            struct transport_param_constraint
+            {
+                utility::string_t name;
+                bool supports_auto;
+                nmos::compiled_constraint constraint;
+            };
+            std::vector<std::vector<transport_param_constraint>> legs;
+
+            // or, if the constraints use any other JSON Schema keywords, a validator for the schema made from the constraints
+            std::unique_ptr<web::json::experimental::json_validator> validator;
+        };
 
-            // Validate staged JSON syntax according to the schema
+        static const web::uri& constraints_schema_uri()
+        {
+            static const web::uri uri{ U("/constraints") };
+            return uri;
+        }
 
-            const web::json::experimental::json_validator validator
+        // Only the constraint keywords defined by IS-05 are compiled, other JSON Schema keywords are left to the validator
+        static bool is_compilable_constraints(const web::json::value& constraints)
+        {
+            static const std::set<utility::string_t> keywords
             {
-                [&](const web::uri&) { return schema; },
-                { uri }
+                nmos::fields::constraint_maximum.key,
+                nmos::fields::constraint_minimum.key,
+                nmos::fields::constraint_enum.key,
+                nmos::fields::constraint_pattern.key,
+                nmos::fields::constraint_description.key
             };
 
-            // Validate JSON syntax according to the schema
+            if (!constraints.is_array()) return false;
+            for (const auto& leg : constraints.as_array())
+            {
+                if (!leg.is_object()) return false;
+                for (const auto& constraint : leg.as_object())
+                {
+                    if (!constraint.second.is_object()) return false;
+                    for (const auto& keyword : constraint.second.as_object())
+                    {
+                        if (keywords.end() == keywords.find(keyword.first)) return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        std::shared_ptr<const compiled_connection_constraints> compile_connection_constraints(const nmos::resource& resource, const nmos::transport& transport_base)
+        {
+            const auto& type = resource.type;
+            const auto& constraints = nmos::fields::endpoint_constraints(resource.data);
+
+            auto result = std::make_shared<compiled_connection_constraints>();
+            result->type = type;
+            result->updated = resource.updated;
+            result->transport_base = transport_base;
+
+            if (is_compilable_constraints(constraints))
+            {
+                auto& type_auto_constraints = auto_constraints(transport_base).at(type);
+
+                try
+                {
+                    for (const auto& leg : constraints.as_array())
+                    {
+                        std::vector<compiled_connection_constraints::transport_param_constraint> params;
+                        for (const auto& constraint : leg.as_object())
+                        {
+                            params.push_back({ constraint.first, type_auto_constraints.end() != type_auto_constraints.find(constraint.first), nmos::compiled_constraint(constraint.second) });
+                        }
+                        result->legs.push_back(std::move(params));
+                    }
+                    return result;
+                }
+                catch (const bst::regex_error&)
+                {
+                    // an invalid pattern is also left to the validator
+                    result->legs.clear();
+                }
+            }
+
+            const auto schema = make_constraints_schema(type, constraints, transport_base);
+            result->validator.reset(new web::json::experimental::json_validator
+            {
+                [schema](const web::uri&) { return schema; },
+                { constraints_schema_uri() }
+            });
+            return result;
+        }
+
+        // Get the compiled constraints of the specified connection resource from the table, compiling them only if the resource has been updated,
+        // or the transport has changed, since they were compiled
+        std::shared_ptr<const compiled_connection_constraints> get_compiled_connection_constraints(compiled_connection_constraints_table& table, const nmos::node_model& model, const nmos::resource& resource, const nmos::transport& transport_base)
+        {
+            std::shared_ptr<const compiled_connection_constraints> compiled;
+            {
+                std::lock_guard<std::mutex> lock(table.mutex);
+                auto found = table.compiled.find(resource.id);
+                if (table.compiled.end() != found) compiled = found->second;
+            }
+            if (compiled && compiled->type == resource.type && compiled->updated == resource.updated && compiled->transport_base == transport_base)
+            {
+                return compiled;
+            }
 
-            validator.validate(staged, uri);
+            compiled = compile_connection_constraints(resource, transport_base);
+            {
+                std::lock_guard<std::mutex> lock(table.mutex);
+                auto& entry = table.compiled[resource.id];
+                if (!entry)
+                {
+                    // when an entry is added, remove the entries of any connection resources which have since been deleted
+                    for (auto it = table.compiled.begin(); table.compiled.end() != it;)
+                    {
+                        if (resource.id != it->first && model.connection_resources.end() == find_resource(model.connection_resources, it->first)) it = table.compiled.erase(it);
+                        else ++it;
+                    }
+                }
+                entry = compiled;
+            }
+            return compiled;
+        }
+
+        // Validate staged endpoint against constraints
+        // throws web::json::json_exception on failure, which results in a 400 Bad Request
+        void validate_staged_constraints(const compiled_connection_constraints& compiled, const web::json::value& staged)
+        {
+            if (compiled.validator)
+            {
+                // Validate staged JSON syntax according to the schema
+
+                compiled.validator->validate(staged, constraints_schema_uri());
+                return;
+            }
+
+            if (!staged.has_field(nmos::fields::transport_params)) return;
+            const auto& transport_params = nmos::fields::transport_params(staged).as_array();
+
+            for (size_t leg = 0; leg < compiled.legs.size() && leg < transport_params.size(); ++leg)
+            {
+                const auto& leg_params = transport_params.at(leg);
+
+                for (const auto& param : compiled.legs[leg])
+                {
+                    if (!leg_params.has_field(param.name)) continue;
+                    const auto& value = leg_params.at(param.name);
+
+                    if (param.supports_auto && value.is_string() && U("auto") == value.as_string()) continue;
+
+                    if (!param.constraint.match(value))
+                    {
+                        throw web::json::json_exception("schema validation failed at /transport_params/" + std::to_string(leg) + "/" + utility::us2s(param.name) + " - value does not match constraints JSON - " + utility::us2s(value.serialize()));
+                    }
+                }
+            }
         }
 
         // Apparently, the response to errors in the transport file should be 500 Internal Error rather than 400 Bad Request
@@ -349,6 +498,137 @@ namespace nmos
             return make_connection_resource_patch_error_response(code, {}, utility::s2us(debug.what()));
         }
 
+        // Validate the specified patch for the specified (IS-04/IS-05) resource/connection_resource and merge it into a copy of the current staged endpoint
+        // throws exceptions on failure, like handle_connection_resource_patch; since it doesn't modify the model, it may be called with only a read lock
+        web::json::value merge_connection_resource_patch(const nmos::node_model& model, compiled_connection_constraints_table& compiled_constraints, const nmos::resource& matching_resource, const nmos::resource& resource, const web::json::value& patch, const nmos::tai& request_time, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
+        {
+            // Merge this patch request into a *copy* of the current staged endpoint
+            // so that the merged parameters can be validated against the constraints
+            // before the current values are overwritten.
+            // On successful staging/activation, this copy will also be used for the response.
+
+            auto merged = nmos::fields::endpoint_staged(resource.data);
+
+            // "In the case where the transport file and transport parameters are updated in the same PATCH request
+            // transport parameters specified in the request object take precedence over those in the transport file."
+            // See https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#single_receivers__receiverid__staged_patch
+            // "In all other cases the most recently received PATCH request takes priority."
+            // See https://specs.amwa.tv/is-05/releases/v1.0.0/docs/4.1._Behaviour_-_RTP_Transport_Type.html#interpretation-of-sdp-files
+
+            // First, validate and merge the transport file (this resource must be a receiver)
+            // See https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#single_receivers__receiverid__staged_patch
+
+            auto& transport_file = nmos::fields::transport_file(patch);
+            if (!transport_file.is_null() && !transport_file.as_object().empty())
+            {
+                const auto transport_type_data = details::get_transport_type_data(transport_file);
+
+                if (!transport_type_data.first.empty())
+                {
+                    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Processing transport file";
+
+                    try
+                    {
+                        // Validate and parse the transport file for this receiver
+
+                        const auto transport_file_params = parse_transport_file(matching_resource, resource, transport_type_data.first, transport_type_data.second, gate);
+
+                        // Merge the transport file into the transport parameters
+
+                        auto& transport_params = nmos::fields::transport_params(merged);
+
+                        web::json::merge_patch(transport_params, transport_file_params);
+                    }
+                    catch (const web::json::json_exception& e)
+                    {
+                        throw transport_file_error(e.what());
+                    }
+                    catch (const std::runtime_error& e)
+                    {
+                        throw transport_file_error(e.what());
+                    }
+                }
+            }
+
+            // Second, merge the transport parameters (in fact, all fields, including "sender_id", "master_enabled", etc.)
+
+            web::json::merge_patch(merged, patch);
+
+            // Then, prepare the activation response
+
+            details::merge_activation(merged[nmos::fields::activation], nmos::fields::activation(patch), request_time);
+
+            // Validate merged JSON according to the constraints
+
+            slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Validating staged transport parameters against constraints";
+
+            const nmos::transport transport_subclassification(nmos::fields::transport(matching_resource.data));
+            details::validate_staged_constraints(*details::get_compiled_connection_constraints(compiled_constraints, model, resource, nmos::transport_base(transport_subclassification)), merged);
+
+            // Perform any final validation
+
+            if (validate_merged)
+            {
+                validate_merged(matching_resource, resource, merged, gate);
+            }
+
+            return merged;
+        }
+
+        // The result of validating and merging a PATCH request for one resource, with only a read lock on the model
+        // See the 'bulk' request handler in nmos::make_unmounted_connection_api
+        struct connection_resource_patch_preparation
+        {
+            // the updated timestamps of the connection resource and the matching IS-04 resource when the preparation was made
+            nmos::tai updated;
+            nmos::tai matching_updated;
+
+            // the result of validating the patch against the schema
+            std::exception_ptr invalid;
+
+            // the result of nmos::details::merge_connection_resource_patch
+            web::json::value merged;
+            std::exception_ptr error;
+        };
+
+        // Validate and merge a PATCH request for one resource, without modifying the model, so that this relatively expensive work
+        // can be done concurrently for the patches in a 'bulk' request
+        // lock.owns_lock() must be true, and since the model is not modified, this may be a read lock
+        connection_resource_patch_preparation prepare_connection_resource_patch(const nmos::node_model& model, compiled_connection_constraints_table& compiled_constraints, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, const nmos::tai& request_time, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
+        {
+            connection_resource_patch_preparation result;
+
+            try
+            {
+                details::validate_staged_core(version, id_type.second, patch);
+            }
+            catch (...)
+            {
+                result.invalid = std::current_exception();
+                return result;
+            }
+
+            auto resource = find_resource(model.connection_resources, id_type);
+            auto matching_resource = find_resource(model.node_resources, id_type);
+            // any other errors are left to be handled by nmos::details::handle_connection_resource_patch
+            if (model.connection_resources.end() == resource || model.node_resources.end() == matching_resource) return result;
+            if (!resource->has_data() || !matching_resource->has_data()) return result;
+
+            result.updated = resource->updated;
+            result.matching_updated = matching_resource->updated;
+
+            try
+            {
+                result.merged = merge_connection_resource_patch(model, compiled_constraints, *matching_resource, *resource, patch, request_time, parse_transport_file, validate_merged, gate);
+            }
+            catch (...)
+            {
+                result.error = std::current_exception();
+            }
+
+            return result;
+        }
+
         // Basic theory of implementation of PATCH /staged
         //
         // 1. Reject any patch, other than cancellation, when a scheduled activation is outstanding.
@@ -394,7 +674,8 @@ namespace nmos
         // By the time we reacquire the model lock anything may have happened, but we can identify with the above whether to send
         // a success response or an error, and in the success case, release the 'per-resource lock' by updating the staged
         // activation mode, requested_time and activation_time.
-        connection_resource_patch_response handle_connection_resource_patch(nmos::node_model& model, nmos::write_lock& lock, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, const nmos::tai& request_time, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
+        // If a preparation is specified, and the resources are unchanged since it was made, the merged staged endpoint is not recomputed
+        connection_resource_patch_response handle_connection_resource_patch(nmos::node_model& model, nmos::write_lock& lock, compiled_connection_constraints_table& compiled_constraints, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, const nmos::tai& request_time, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate, const connection_resource_patch_preparation* prepared = nullptr)
         {
             using namespace web::http::experimental::listener::api_router_using_declarations;
 
@@ -402,10 +683,14 @@ namespace nmos
             auto& resources = model.connection_resources;
 
             // Validate JSON syntax according to the schema
-            details::validate_staged_core(version, id_type.second, patch);
+            if (nullptr == prepared) details::validate_staged_core(version, id_type.second, patch);
+            else if (prepared->invalid) std::rethrow_exception(prepared->invalid);
 
             const auto patch_state = details::get_activation_state(nmos::fields::activation(patch));
 
+            // waiting for an in-flight immediate activation releases and reacquires the lock
+            bool waited = false;
+
             auto resource = find_resource(resources, id_type);
             if (resources.end() != resource)
             {
@@ -454,6 +739,7 @@ namespace nmos
                         }
                         // find resource again just in case, since waiting releases and reacquires the lock
                         resource = find_resource(resources, id_type);
+                        waited = true;
                     }
                 }
                 else
@@ -472,75 +758,12 @@ namespace nmos
                     throw std::logic_error("matching IS-04 and IS-05 resources not found");
                 }
 
-                // Merge this patch request into a *copy* of the current staged endpoint
-                // so that the merged parameters can be validated against the constraints
-                // before the current values are overwritten.
-                // On successful staging/activation, this copy will also be used for the response.
-
-                auto merged = nmos::fields::endpoint_staged(resource->data);
-
-                // "In the case where the transport file and transport parameters are updated in the same PATCH request
-                // transport parameters specified in the request object take precedence over those in the transport file."
-                // See https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#single_receivers__receiverid__staged_patch
-                // "In all other cases the most recently received PATCH request takes priority."
-                // See https://specs.amwa.tv/is-05/releases/v1.0.0/docs/4.1._Behaviour_-_RTP_Transport_Type.html#interpretation-of-sdp-files
+                // Merge this patch request into a *copy* of the current staged endpoint, and validate it,
+                // unless that has already been done and the resources are unchanged since
 
-                // First, validate and merge the transport file (this resource must be a receiver)
-                // See https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#single_receivers__receiverid__staged_patch
-
-                auto& transport_file = nmos::fields::transport_file(patch);
-                if (!transport_file.is_null() && !transport_file.as_object().empty())
-                {
-                    const auto transport_type_data = details::get_transport_type_data(transport_file);
-
-                    if (!transport_type_data.first.empty())
-                    {
-                        slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Processing transport file";
-
-                        try
-                        {
-                            // Validate and parse the transport file for this receiver
-
-                            const auto transport_file_params = parse_transport_file(*matching_resource, *resource, transport_type_data.first, transport_type_data.second, gate);
-
-                            // Merge the transport file into the transport parameters
-
-                            auto& transport_params = nmos::fields::transport_params(merged);
-
-                            web::json::merge_patch(transport_params, transport_file_params);
-                        }
-                        catch (const web::json::json_exception& e)
-                        {
-                            throw transport_file_error(e.what());
-                        }
-                        catch (const std::runtime_error& e)
-                        {
-                            throw transport_file_error(e.what());
-                        }
-                    }
-                }
-
-                // Second, merge the transport parameters (in fact, all fields, including "sender_id", "master_enabled", etc.)
-
-                web::json::merge_patch(merged, patch);
-
-                // Then, prepare the activation response
-
-                details::merge_activation(merged[nmos::fields::activation], nmos::fields::activation(patch), request_time);
-
-                // Validate merged JSON according to the constraints
-
-                slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Validating staged transport parameters against constraints";
-
-                const nmos::transport transport_subclassification(nmos::fields::transport(matching_resource->data));
-                details::validate_staged_constraints(resource->type, nmos::fields::endpoint_constraints(resource->data), nmos::transport_base(transport_subclassification), merged);
-
-                // Perform any final validation
-
-                if (validate_merged)
-                {
-                    validate_merged(*matching_resource, *resource, merged, gate);
-                }
+                const bool unchanged = nullptr != prepared && !waited && prepared->updated == resource->updated && prepared->matching_updated == matching_resource->updated;
+                if (unchanged && prepared->error) std::rethrow_exception(prepared->error);
+                auto merged = unchanged ? prepared->merged : merge_connection_resource_patch(model, compiled_constraints, *matching_resource, *resource, patch, request_time, parse_transport_file, validate_merged, gate);
 
                 // Finally, update the staged endpoint
 
@@ -580,12 +803,12 @@ namespace nmos
             model.notify();
         }
 
-        void handle_connection_resource_patch(web::http::http_response res, nmos::node_model& model, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
+        void handle_connection_resource_patch(web::http::http_response res, nmos::node_model& model, compiled_connection_constraints_table& compiled_constraints, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
         {
             auto lock = model.write_lock();
             const auto request_time = tai_now(); // during write lock to ensure uniqueness
 
-            auto result = handle_connection_resource_patch(model, lock, version, id_type, patch, request_time, parse_transport_file, validate_merged, gate);
+            auto result = handle_connection_resource_patch(model, lock, compiled_constraints, version, id_type, patch, request_time, parse_transport_file, validate_merged, gate);
 
             if (web::http::is_success_status_code(result.first))
             {
@@ -606,6 +829,13 @@ namespace nmos
             }
         }
 
+        void handle_connection_resource_patch(web::http::http_response res, nmos::node_model& model, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate)
+        {
+            // without a table shared between requests, the constraints are compiled for each request
+            compiled_connection_constraints_table compiled_constraints;
+            handle_connection_resource_patch(res, model, compiled_constraints, version, id_type, patch, parse_transport_file, validate_merged, gate);
+        }
+
         void handle_connection_resource_transportfile(web::http::http_response res, const nmos::node_model& model, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const utility::string_t& accept, slog::base_gate& gate)
         {
             using namespace web::http::experimental::listener::api_router_using_declarations;
@@ -901,6 +1131,9 @@ namespace nmos
         const auto versions = with_read_lock(model.mutex, [&model] { return nmos::is05_versions::from_settings(model.settings); });
         connection_api.support(U(".*"), details::make_api_version_handler(versions, gate_));
 
+        // the constraints of each connection resource are compiled when they are first used to validate a PATCH request, and are shared between requests to this API
+        auto compiled_constraints = std::make_shared<details::compiled_connection_constraints_table>();
+
         connection_api.support(U("/?"), methods::GET, [](http_request req, http_response res, const string_t&, const route_parameters&)
         {
             set_reply(res, status_codes::OK, nmos::make_sub_routes_body({ U("bulk/"), U("single/") }, req, res));
@@ -918,14 +1151,11 @@ namespace nmos
         // See https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#bulk_senders_get
         // and https://specs.amwa.tv/is-05/releases/v1.0.0/APIs/ConnectionAPI.html#bulk_receivers_get
 
-        connection_api.support(U("/bulk/") + nmos::patterns::connectorType.pattern + U("/?"), methods::POST, [&model, parse_transport_file, validate_merged, &gate_](http_request req, http_response res, const string_t&, const route_parameters& parameters)
+        connection_api.support(U("/bulk/") + nmos::patterns::connectorType.pattern + U("/?"), methods::POST, [&model, compiled_constraints, parse_transport_file, validate_merged, &gate_](http_request req, http_response res, const string_t&, const route_parameters& parameters)
         {
             nmos::api_gate gate(gate_, req, parameters);
-            return details::extract_json(req, gate).then([&model, req, res, parameters, parse_transport_file, validate_merged, gate](value body) mutable
+            return details::extract_json(req, gate).then([&model, compiled_constraints, req, res, parameters, parse_transport_file, validate_merged, gate](value body) mutable
             {
-                auto lock = model.write_lock();
-                const auto request_time = tai_now(); // during write lock to ensure uniqueness
-
                 const nmos::api_version version = nmos::parse_api_version(parameters.at(nmos::patterns::version.name));
                 const string_t resourceType = parameters.at(nmos::patterns::connectorType.name);
 
@@ -983,15 +1213,51 @@ namespace nmos
                     }
                 };
 
+                std::vector<nmos::id> ids;
+                ids.reserve(patches.size());
                 for (auto& patch : patches)
                 {
-                    const auto id = nmos::fields::id(patch);
+                    ids.push_back(nmos::fields::id(patch));
+                    // ensure the params field exists before the patches are shared between threads
+                    patch[nmos::fields::params];
+                }
+
+                // Schema validation, transport file parsing and validation of the merged staged endpoint are done for each patch
+                // with only a read lock, so that other requests are not held up by the write lock meanwhile, and concurrently
+                // if so configured, since that means the callbacks may be called concurrently
+                // Any resources that are modified before the write lock is acquired are validated again, while it is held
+
+                std::vector<details::connection_resource_patch_preparation> preparations(patches.size());
+                const auto request_time = [&model]
+                {
+                    auto lock = model.write_lock();
+                    return tai_now(); // during write lock to ensure uniqueness
+                }();
+                {
+                    auto lock = model.read_lock();
+
+                    const auto bulk_concurrency = nmos::experimental::fields::connection_api_bulk_concurrency(model.settings);
+                    const std::size_t concurrency = 0 < bulk_concurrency ? (std::size_t)bulk_concurrency : 0 == bulk_concurrency ? (std::size_t)std::thread::hardware_concurrency() : 1;
+
+                    const auto& const_patches = patches;
+                    details::parallel_for(patches.size(), [&](std::size_t index)
+                    {
+                        preparations[index] = details::prepare_connection_resource_patch(model, *compiled_constraints, version, { ids[index], type }, const_patches.at(index).at(nmos::fields::params), request_time, parse_transport_file, validate_merged, gate);
+                    }, concurrency);
+                }
+
+                auto lock = model.write_lock();
+
+                for (std::size_t index = 0; index < patches.size(); ++index)
+                {
+                    const auto& id = ids[index];
+                    auto& patch = patches[index];
 
                     details::connection_resource_patch_response result;
 
                     try
                     {
-                        result = details::handle_connection_resource_patch(model, lock, version, { id, type }, patch[nmos::fields::params], request_time, parse_transport_file, validate_merged, gate);
+                        result = details::handle_connection_resource_patch(model, lock, *compiled_constraints, version, { id, type }, patch[nmos::fields::params], request_time, parse_transport_file, validate_merged, gate, &preparations[index]);
                     }
                     catch (...)
                     {
@@ -1001,6 +1267,7 @@ namespace nmos
                     results.push_back(result);
                 }
 
+                // all the immediate activations are handed to the activation thread together
                 if (0 != patches.size()) details::notify_connection_resource_patch(model, gate);
 
                 auto rit = results.begin();
@@ -1226,10 +1493,10 @@ namespace nmos
             return pplx::task_from_result(true);
         });
 
-        connection_api.support(U("/single/") + nmos::patterns::connectorType.pattern + U("/") + nmos::patterns::resourceId.pattern + U("/staged/?"), methods::PATCH, [&model, parse_transport_file, validate_merged, &gate_](http_request req, http_response res, const string_t&, const route_parameters& parameters)
+        connection_api.support(U("/single/") + nmos::patterns::connectorType.pattern + U("/") + nmos::patterns::resourceId.pattern + U("/staged/?"), methods::PATCH, [&model, compiled_constraints, parse_transport_file, validate_merged, &gate_](http_request req, http_response res, const string_t&, const route_parameters& parameters)
         {
             nmos::api_gate gate(gate_, req, parameters);
-            return details::extract_json(req, gate).then([&model, req, res, parameters, parse_transport_file, validate_merged, gate](value body) mutable
+            return details::extract_json(req, gate).then([&model, compiled_constraints, req, res, parameters, parse_transport_file, validate_merged, gate](value body) mutable
             {
                 const nmos::api_version version = nmos::parse_api_version(parameters.at(nmos::patterns::version.name));
                 const string_t resourceType = parameters.at(nmos::patterns::connectorType.name);
@@ -1239,7 +1506,7 @@ namespace nmos
 
                 slog::log<slog::severities::info>(gate, SLOG_FLF) << "Operation requested for single " << id_type;
 
-                details::handle_connection_resource_patch(res, model, version, id_type, body, parse_transport_file, validate_merged, gate);
+                details::handle_connection_resource_patch(res, model, *compiled_constraints, version, id_type, body, parse_transport_file, validate_merged, gate);
 
                 return true;
             });
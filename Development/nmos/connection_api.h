@@ -1,6 +1,8 @@
 #ifndef NMOS_CONNECTION_API_H
 #define NMOS_CONNECTION_API_H
 
+#include <mutex>
+#include <unordered_map>
 #include "cpprest/api_router.h"
 #include "nmos/id.h"
 
@@ -37,6 +39,7 @@ namespace nmos
     // Connection API factory functions
 
     // callbacks from this function are called with the model locked, and may read but should not write directly to the model
+    // for 'bulk' requests, they are only called concurrently from several threads (with only a read lock) if nmos::experimental::fields::connection_api_bulk_concurrency is not 1
     web::http::experimental::listener::api_router make_connection_api(nmos::node_model& model, transport_file_parser parse_transport_file, details::connection_resource_patch_validator validate_merged, slog::base_gate& gate);
 
     inline web::http::experimental::listener::api_router make_connection_api(nmos::node_model& model, transport_file_parser parse_transport_file, slog::base_gate& gate)
@@ -46,10 +49,26 @@ namespace nmos
 
     web::http::experimental::listener::api_router make_connection_api(nmos::node_model& model, slog::base_gate& gate);
 
+    namespace details
+    {
+        // the constraints of a connection resource, compiled for validating many staged endpoints
+        struct compiled_connection_constraints;
+
+        // the compiled constraints of the connection resources, by id, which are shared between the requests to one Connection API
+        // entries are compiled when needed, with only a read lock on the model, hence the table's own mutex
+        struct compiled_connection_constraints_table
+        {
+            std::mutex mutex;
+            std::unordered_map<nmos::id, std::shared_ptr<const compiled_connection_constraints>> compiled;
+        };
+    }
+
     // Connection API implementation details shared with the Node API /receivers/{receiverId}/target endpoint
     // and experimental Manifest API for Node API "manifest_href"
     namespace details
     {
+        void handle_connection_resource_patch(web::http::http_response res, nmos::node_model& model, compiled_connection_constraints_table& compiled_constraints, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, transport_file_parser parse_transport_file, connection_resource_patch_validator validate_merged, slog::base_gate& gate);
+        // without a table shared between requests, the constraints are compiled for each request
         void handle_connection_resource_patch(web::http::http_response res, nmos::node_model& model, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& patch, transport_file_parser parse_transport_file, connection_resource_patch_validator validate_merged, slog::base_gate& gate);
         void handle_connection_resource_transportfile(web::http::http_response res, const nmos::node_model& model, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const utility::string_t& accept, slog::base_gate& gate);
     }
@@ -67,6 +86,22 @@ namespace nmos
     // (This function should be called after nmos::set_connection_resource_active.)
     void set_resource_subscription(nmos::resource& node_resource, bool active, const nmos::id& connected_id, const nmos::tai& activation_time);
 
+    // Validation of staged endpoints against the /constraints endpoint
+
+    struct transport;
+
+    namespace details
+    {
+        // get the compiled constraints of the specified connection resource from the table, compiling them only if the resource has been updated,
+        // or the transport has changed, since they were compiled; when an entry is added, the entries of deleted connection resources are removed
+        // this may be called concurrently from several threads, with only a read lock on the model
+        std::shared_ptr<const compiled_connection_constraints> get_compiled_connection_constraints(compiled_connection_constraints_table& table, const nmos::node_model& model, const nmos::resource& connection_resource, const nmos::transport& transport_base);
+
+        // validate the specified merged /staged value against the compiled constraints
+        // throws web::json::json_exception on failure, which results in a 400 Bad Request
+        void validate_staged_constraints(const compiled_connection_constraints& compiled, const web::json::value& staged);
+    }
+
     // Helper functions for the Connection API callbacks
 
     struct sdp_parameters;
@@ -1,5 +1,7 @@
 #include "nmos/connection_events_activation.h"
 
+#include <vector>
+
 #include "pplx/pplx_utils.h"
 #include "nmos/connection_api.h"
 #include "nmos/client_utils.h"
@@ -10,15 +12,44 @@
 
 namespace nmos
 {
+    namespace experimental
+    {
+        // add or update the route for the specified receiver
+        void insert_events_ws_receiver_route(events_ws_receiver_routes& routes, const nmos::id& receiver_id, const utility::string_t& connection_uri, const nmos::id& source_id)
+        {
+            erase_events_ws_receiver_route(routes, receiver_id);
+
+            const events_ws_receiver_routes::route route{ connection_uri, source_id };
+            routes.receivers[route].insert(receiver_id);
+            routes.routes.insert({ receiver_id, route });
+        }
+
+        // remove the route for the specified receiver, if any
+        void erase_events_ws_receiver_route(events_ws_receiver_routes& routes, const nmos::id& receiver_id)
+        {
+            auto found = routes.routes.find(receiver_id);
+            if (routes.routes.end() == found) return;
+
+            auto receivers = routes.receivers.find(found->second);
+            if (routes.receivers.end() != receivers)
+            {
+                receivers->second.erase(receiver_id);
+                if (receivers->second.empty()) routes.receivers.erase(receivers);
+            }
+            routes.routes.erase(found);
+        }
+    }
+
     // this handler can be used to (un)subscribe IS-07 Events WebSocket receivers with the specified handlers, when they are activated
-    nmos::connection_activation_handler make_connection_events_websocket_activation_handler(load_ca_certificates_handler load_ca_certificates, events_ws_message_handler message_handler, events_ws_close_handler close_handler, const nmos::settings& settings, slog::base_gate& gate)
+    // and, optionally, to maintain the routes used by the message and close handlers
+    nmos::connection_activation_handler make_connection_events_websocket_activation_handler(load_ca_certificates_handler load_ca_certificates, events_ws_message_handler message_handler, events_ws_close_handler close_handler, std::shared_ptr<experimental::events_ws_receiver_routes> routes, const nmos::settings& settings, slog::base_gate& gate)
     {
         std::shared_ptr<nmos::events_ws_client> events_ws_client(new nmos::events_ws_client(nmos::make_websocket_client_config(settings, load_ca_certificates, gate), nmos::fields::events_heartbeat_interval(settings), gate));
 
         events_ws_client->set_message_handler(message_handler);
         events_ws_client->set_close_handler(close_handler);
 
-        return [events_ws_client](const nmos::resource& resource, const nmos::resource& connection_resource)
+        return [events_ws_client, routes](const nmos::resource& resource, const nmos::resource& connection_resource)
         {
             if (nmos::types::receiver != resource.type) return;
             if (nmos::transports::websocket.name != nmos::fields::transport(resource.data)) return;
@@ -33,11 +64,15 @@ namespace nmos
 
             if (active && !connection_uri_or_null.is_null() && !ext_is_07_source_id_or_null.is_null())
             {
+                if (routes) experimental::insert_events_ws_receiver_route(*routes, connection_resource.id, connection_uri_or_null.as_string(), ext_is_07_source_id_or_null.as_string());
+
                 events_ws_client->subscribe(connection_resource.id, connection_uri_or_null.as_string(), ext_is_07_source_id_or_null.as_string())
                     .then(pplx::observe_exception());
             }
             else
             {
+                if (routes) experimental::erase_events_ws_receiver_route(*routes, connection_resource.id);
+
                 events_ws_client->unsubscribe(connection_resource.id)
                     .then(pplx::observe_exception());
             }
@@ -48,9 +83,10 @@ namespace nmos
     {
         // since each Events WebSocket connection may potentially have subscriptions to a number of sources, for multiple receivers
         // this handler adaptor enables simple processing of "state" messages (events) per receiver
-        nmos::events_ws_message_handler make_events_ws_message_handler(const nmos::node_model& model, events_ws_receiver_event_handler event_handler, slog::base_gate& gate)
+        // when routes are specified, only the receivers subscribed to the message source are considered, rather than every receiver
+        nmos::events_ws_message_handler make_events_ws_message_handler(const nmos::node_model& model, std::shared_ptr<const events_ws_receiver_routes> routes, events_ws_receiver_event_handler event_handler, slog::base_gate& gate)
         {
-            return [&model, event_handler, &gate](const web::uri& connection_uri, const web::json::value& message)
+            return [&model, routes, event_handler, &gate](const web::uri& connection_uri, const web::json::value& message)
             {
                 const auto& message_type = nmos::fields::message_type(message);
 
@@ -67,19 +103,18 @@ namespace nmos
                     // the callback might be simplified by passing a set of ids associated with the message source id, or perhaps a boost::any_range of the
                     // relevant event_ws_subscriptions, or access to the subscriptions member itself protected by the mutex
 
-                    // for now, iterate over all receivers and just skip the ones that don't match
+                    // for now, consider all (routed) receivers and just skip the ones that don't match
 
-                    auto& by_type = model.node_resources.get<nmos::tags::type>();
-                    const auto receivers = by_type.equal_range(nmos::details::has_data(nmos::types::receiver));
+                    const auto connection_uri_string = connection_uri.to_string();
 
-                    for (auto receiver = receivers.first; receivers.second != receiver; ++receiver)
+                    const auto handle_receiver = [&](const nmos::resource& receiver)
                     {
-                        if (nmos::transports::websocket.name != nmos::fields::transport(receiver->data)) continue;
+                        if (nmos::transports::websocket.name != nmos::fields::transport(receiver.data)) return;
 
-                        const std::pair<nmos::id, nmos::type> id_type{ receiver->id, receiver->type };
+                        const std::pair<nmos::id, nmos::type> id_type{ receiver.id, receiver.type };
 
                         auto connection_receiver = nmos::find_resource(model.connection_resources, id_type);
-                        if (model.connection_resources.end() == connection_receiver) continue;
+                        if (model.connection_resources.end() == connection_receiver) return;
 
                         const auto& endpoint_active = nmos::fields::endpoint_active(connection_receiver->data);
                         const bool active = nmos::fields::master_enable(endpoint_active);
@@ -87,13 +122,13 @@ namespace nmos
                         const auto& connection_uri_or_null = nmos::fields::connection_uri(transport_params);
                         const auto& ext_is_07_source_id_or_null = nmos::fields::ext_is_07_source_id(transport_params);
 
-                        if (!active) continue;
-                        if (connection_uri_or_null.is_null() || connection_uri.to_string() != connection_uri_or_null.as_string()) continue;
-                        if (ext_is_07_source_id_or_null.is_null() || source_id != ext_is_07_source_id_or_null.as_string()) continue;
+                        if (!active) return;
+                        if (connection_uri_or_null.is_null() || connection_uri_string != connection_uri_or_null.as_string()) return;
+                        if (ext_is_07_source_id_or_null.is_null() || source_id != ext_is_07_source_id_or_null.as_string()) return;
 
                         // subscription-specific behaviour
 
-                        const auto& event_type_caps_or_null = nmos::fields::event_types(nmos::fields::caps(receiver->data));
+                        const auto& event_type_caps_or_null = nmos::fields::event_types(nmos::fields::caps(receiver.data));
 
                         const bool match = event_type_caps_or_null.is_null() || [&]
                         {
@@ -110,10 +145,34 @@ namespace nmos
                         {
                             if (event_handler)
                             {
-                                event_handler(*receiver, *connection_receiver, message);
+                                event_handler(receiver, *connection_receiver, message);
                             }
                         }
                         // else, hmm, what now?
+                    };
+
+                    if (routes)
+                    {
+                        // the routes may include receivers that have since been deleted, or deactivated other than by activation, which are skipped as usual
+                        const auto found = routes->receivers.find({ connection_uri_string, source_id });
+                        if (routes->receivers.end() == found) return;
+
+                        for (const auto& receiver_id : found->second)
+                        {
+                            const auto receiver = nmos::find_resource(model.node_resources, { receiver_id, nmos::types::receiver });
+                            if (model.node_resources.end() == receiver || !receiver->has_data()) continue;
+                            handle_receiver(*receiver);
+                        }
+                    }
+                    else
+                    {
+                        auto& by_type = model.node_resources.get<nmos::tags::type>();
+                        const auto receivers = by_type.equal_range(nmos::details::has_data(nmos::types::receiver));
+
+                        for (auto receiver = receivers.first; receivers.second != receiver; ++receiver)
+                        {
+                            handle_receiver(*receiver);
+                        }
                     }
                 }
                 else // "health", "shutdown" or "reboot"
@@ -129,9 +188,10 @@ namespace nmos
         }
 
         // this handler reflects Events WebSocket connection errors into the /active endpoint of all associated receivers by setting master_enable to false
-        nmos::events_ws_close_handler make_events_ws_close_handler(nmos::node_model& model, slog::base_gate& gate)
+        // when routes are specified, only the receivers subscribed to sources on the connection are considered, and their routes are removed
+        nmos::events_ws_close_handler make_events_ws_close_handler(nmos::node_model& model, std::shared_ptr<events_ws_receiver_routes> routes, slog::base_gate& gate)
         {
-            return [&model, &gate](const web::uri& connection_uri, web::websockets::client::websocket_close_status close_status, const utility::string_t& close_reason)
+            return [&model, routes, &gate](const web::uri& connection_uri, web::websockets::client::websocket_close_status close_status, const utility::string_t& close_reason)
             {
                 auto lock = model.write_lock();
 
@@ -143,14 +203,40 @@ namespace nmos
 
                 const auto activation_time = nmos::tai_now();
 
-                auto& by_type = model.node_resources.get<nmos::tags::type>();
-                const auto receivers = by_type.equal_range(nmos::details::has_data(nmos::types::receiver));
+                const auto connection_uri_string = connection_uri.to_string();
 
-                for (auto receiver = receivers.first; receivers.second != receiver; ++receiver)
+                std::vector<nmos::id> receiver_ids;
+                if (routes)
                 {
-                    if (nmos::transports::websocket.name != nmos::fields::transport(receiver->data)) continue;
+                    // the routes are ordered by connection URI, then source id
+                    for (auto route = routes->receivers.lower_bound({ connection_uri_string, {} }); routes->receivers.end() != route && connection_uri_string == route->first.first; ++route)
+                    {
+                        receiver_ids.insert(receiver_ids.end(), route->second.begin(), route->second.end());
+                    }
+                    for (const auto& receiver_id : receiver_ids)
+                    {
+                        erase_events_ws_receiver_route(*routes, receiver_id);
+                    }
+                }
+                else
+                {
+                    auto& by_type = model.node_resources.get<nmos::tags::type>();
+                    const auto receivers = by_type.equal_range(nmos::details::has_data(nmos::types::receiver));
 
-                    const std::pair<nmos::id, nmos::type> id_type{ receiver->id, receiver->type };
+                    for (auto receiver = receivers.first; receivers.second != receiver; ++receiver)
+                    {
+                        receiver_ids.push_back(receiver->id);
+                    }
+                }
+
+                for (const auto& receiver_id : receiver_ids)
+                {
+                    const std::pair<nmos::id, nmos::type> id_type{ receiver_id, nmos::types::receiver };
+
+                    auto receiver = nmos::find_resource(model.node_resources, id_type);
+                    if (model.node_resources.end() == receiver || !receiver->has_data()) continue;
+
+                    if (nmos::transports::websocket.name != nmos::fields::transport(receiver->data)) continue;
 
                     auto connection_receiver = nmos::find_resource(model.connection_resources, id_type);
                     if (model.connection_resources.end() == connection_receiver) continue;
@@ -161,7 +247,7 @@ namespace nmos
                     const auto& connection_uri_or_null = nmos::fields::connection_uri(transport_params);
 
                     if (!active) continue;
-                    if (connection_uri_or_null.is_null() || connection_uri.to_string() != connection_uri_or_null.as_string()) continue;
+                    if (connection_uri_or_null.is_null() || connection_uri_string != connection_uri_or_null.as_string()) continue;
 
                     // Update the IS-05 resource's /active endpoint
 
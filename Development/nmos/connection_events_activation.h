@@ -1,6 +1,8 @@
 #ifndef NMOS_CONNECTION_EVENTS_ACTIVATION_H
 #define NMOS_CONNECTION_EVENTS_ACTIVATION_H
 
+#include <map>
+#include <set>
 #include "nmos/certificate_handlers.h"
 #include "nmos/connection_activation.h"
 #include "nmos/events_ws_client.h" // for nmos::events_ws_message_handler, etc.
@@ -10,8 +12,35 @@ namespace nmos
 {
     struct node_model;
 
+    namespace experimental
+    {
+        // a routing table from the connection URI and source id of each active IS-07 Events WebSocket receiver to its id
+        // so that a message need only be dispatched to the receivers that are subscribed to its source
+        // the activation handler maintains the routes and the message and close handlers use them, all with the model mutex locked
+        struct events_ws_receiver_routes
+        {
+            // connection URI and source id
+            typedef std::pair<utility::string_t, nmos::id> route;
+
+            std::map<route, std::set<nmos::id>> receivers;
+            std::map<nmos::id, route> routes;
+        };
+
+        // add or update the route for the specified receiver
+        void insert_events_ws_receiver_route(events_ws_receiver_routes& routes, const nmos::id& receiver_id, const utility::string_t& connection_uri, const nmos::id& source_id);
+
+        // remove the route for the specified receiver, if any
+        void erase_events_ws_receiver_route(events_ws_receiver_routes& routes, const nmos::id& receiver_id);
+    }
+
     // this handler can be used to (un)subscribe IS-07 Events WebSocket receivers with the specified handlers, when they are activated
-    nmos::connection_activation_handler make_connection_events_websocket_activation_handler(nmos::load_ca_certificates_handler load_ca_certificates, nmos::events_ws_message_handler message_handler, nmos::events_ws_close_handler close_handler, const nmos::settings& settings, slog::base_gate& gate);
+    // and, optionally, to maintain the routes used by the message and close handlers
+    nmos::connection_activation_handler make_connection_events_websocket_activation_handler(nmos::load_ca_certificates_handler load_ca_certificates, nmos::events_ws_message_handler message_handler, nmos::events_ws_close_handler close_handler, std::shared_ptr<experimental::events_ws_receiver_routes> routes, const nmos::settings& settings, slog::base_gate& gate);
+
+    inline nmos::connection_activation_handler make_connection_events_websocket_activation_handler(nmos::load_ca_certificates_handler load_ca_certificates, nmos::events_ws_message_handler message_handler, nmos::events_ws_close_handler close_handler, const nmos::settings& settings, slog::base_gate& gate)
+    {
+        return make_connection_events_websocket_activation_handler(std::move(load_ca_certificates), std::move(message_handler), std::move(close_handler), {}, settings, gate);
+    }
 
     inline nmos::connection_activation_handler make_connection_events_websocket_activation_handler(nmos::events_ws_message_handler message_handler, nmos::events_ws_close_handler close_handler, const nmos::settings& settings, slog::base_gate& gate)
     {
@@ -30,10 +59,22 @@ namespace nmos
 
         // since each Events WebSocket connection may potentially have subscriptions to a number of sources, for multiple receivers
         // this handler adaptor enables simple processing of "state" messages (events) per receiver
-        nmos::events_ws_message_handler make_events_ws_message_handler(const nmos::node_model& model, events_ws_receiver_event_handler event_handler, slog::base_gate& gate);
+        // when routes are specified, only the receivers subscribed to the message source are considered, rather than every receiver
+        nmos::events_ws_message_handler make_events_ws_message_handler(const nmos::node_model& model, std::shared_ptr<const events_ws_receiver_routes> routes, events_ws_receiver_event_handler event_handler, slog::base_gate& gate);
+
+        inline nmos::events_ws_message_handler make_events_ws_message_handler(const nmos::node_model& model, events_ws_receiver_event_handler event_handler, slog::base_gate& gate)
+        {
+            return make_events_ws_message_handler(model, {}, std::move(event_handler), gate);
+        }
 
         // this handler reflects Events WebSocket connection errors into the /active endpoint of all associated receivers by setting master_enable to false
-        nmos::events_ws_close_handler make_events_ws_close_handler(nmos::node_model& model, slog::base_gate& gate);
+        // when routes are specified, only the receivers subscribed to sources on the connection are considered, and their routes are removed
+        nmos::events_ws_close_handler make_events_ws_close_handler(nmos::node_model& model, std::shared_ptr<events_ws_receiver_routes> routes, slog::base_gate& gate);
+
+        inline nmos::events_ws_close_handler make_events_ws_close_handler(nmos::node_model& model, slog::base_gate& gate)
+        {
+            return make_events_ws_close_handler(model, {}, gate);
+        }
     }
 }
 
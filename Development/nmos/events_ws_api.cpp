@@ -85,7 +85,7 @@ namespace nmos
                 const bool non_persistent = false;
                 value data = value_of({
                     { nmos::fields::id, nmos::make_id() },
-                    { nmos::fields::max_update_rate_ms, 0 },
+                    { nmos::fields::max_update_rate_ms, nmos::experimental::fields::events_ws_max_update_rate_ms(model.settings) },
                     { nmos::fields::resource_path, U('/') + nmos::resourceType_from_type(nmos::types::source) },
                     { nmos::fields::params, value_of({ { U("query.rql"), U("in(id,())") } }) },
                     { nmos::fields::persist, non_persistent },
@@ -343,6 +343,79 @@ namespace nmos
 
             slog::base_gate& gate;
         };
+
+        // prepare the messages that may be sent now for the specified events, which are removed from the array
+        tai_clock::time_point prepare_events_ws_messages(std::vector<web::json::value>& messages, web::json::value& events, events_ws_sent_states& sent_states, const std::chrono::milliseconds& max_update_rate, const tai_clock::time_point& now)
+        {
+            auto earliest_necessary_update = (tai_clock::time_point::max)();
+
+            auto& events_storage = web::json::storage_of(events.as_array());
+
+            // the latest state event for each rate-limited source, in the order the sources were first seen
+            std::vector<web::json::value> latest;
+            std::map<nmos::id, size_t> latest_index;
+
+            for (auto& event : events_storage)
+            {
+                if (event.has_field(U("message_type")))
+                {
+                    // reboot, shutdown or health message
+                    messages.push_back(std::move(event));
+                }
+                else if (event.has_field(U("post")))
+                {
+                    // state message
+                    // see https://specs.amwa.tv/is-07/releases/v1.0.1/docs/2.0._Message_types.html#11-the-state-message-type
+                    // and nmos::make_events_boolean_state, nmos::make_events_number_state, etc.
+                    // and nmos::details::make_resource_event
+                    const auto& source = event.at(U("post"));
+                    const auto source_update_rate = source.has_field(nmos::fields::max_update_rate_ms) ? std::chrono::milliseconds(nmos::fields::max_update_rate_ms(source)) : max_update_rate;
+                    if (std::chrono::milliseconds::zero() == source_update_rate)
+                    {
+                        messages.push_back(nmos::fields::endpoint_state(source));
+                        continue;
+                    }
+
+                    const auto inserted = latest_index.insert({ nmos::fields::id(source), latest.size() });
+                    if (inserted.second)
+                    {
+                        latest.push_back(std::move(event));
+                    }
+                    else
+                    {
+                        // a more recent state supersedes any that has not yet been sent
+                        latest[inserted.first->second] = std::move(event);
+                    }
+                }
+            }
+
+            events_storage.clear();
+
+            for (auto& event : latest)
+            {
+                const auto& source = event.at(U("post"));
+                const auto source_update_rate = source.has_field(nmos::fields::max_update_rate_ms) ? std::chrono::milliseconds(nmos::fields::max_update_rate_ms(source)) : max_update_rate;
+
+                auto& sent = sent_states[nmos::fields::id(source)];
+                const auto earliest_allowed_update = sent + source_update_rate;
+                if (earliest_allowed_update > now)
+                {
+                    // make sure to send the state as soon as allowed
+                    if (earliest_allowed_update < earliest_necessary_update)
+                    {
+                        earliest_necessary_update = earliest_allowed_update;
+                    }
+                    // just don't do it now!
+                    events_storage.push_back(std::move(event));
+                    continue;
+                }
+
+                sent = now;
+                messages.push_back(nmos::fields::endpoint_state(source));
+            }
+
+            return earliest_necessary_update;
+        }
     }
 
     void send_events_ws_messages_thread(web::websockets::experimental::listener::websocket_listener& listener, nmos::node_model& model, nmos::websockets& websockets, slog::base_gate& gate_)
@@ -361,6 +434,9 @@ namespace nmos
         tai most_recent_message{};
         auto earliest_necessary_update = (tai_clock::time_point::max)();
 
+        // when the most recent state message for each source was sent on each websocket connection, for rate limiting
+        std::map<nmos::id, details::events_ws_sent_states> sent_states;
+
         for (;;)
         {
             // wait for the thread to be interrupted either because there are resource changes, or because the server is being shut down
@@ -371,6 +447,8 @@ namespace nmos
 
             slog::log<slog::severities::too_much_info>(gate, SLOG_FLF) << "Got notification on events websockets thread";
 
+            const auto now = tai_clock::now();
+
             earliest_necessary_update = (tai_clock::time_point::max)();
 
             std::vector<std::pair<web::websockets::experimental::listener::connection_id, web::websockets::websocket_outgoing_message>> outgoing_messages;
@@ -388,6 +466,7 @@ namespace nmos
                     // theoretically blocking, but in fact not
                     close.wait();
 
+                    sent_states.erase(websocket.first);
                     wit = websockets.left.erase(wit);
                     continue;
                 }
@@ -402,51 +481,60 @@ namespace nmos
                     // theoretically blocking, but in fact not
                     close.wait();
 
+                    sent_states.erase(websocket.first);
                     wit = websockets.left.erase(wit);
                     continue;
                 }
                 // and has events to send
-                if (0 == nmos::fields::message_grain_data(grain->data).size())
+                const auto events_count = nmos::fields::message_grain_data(grain->data).size();
+                if (0 == events_count)
                 {
                     ++wit;
                     continue;
                 }
 
-                slog::log<slog::severities::info>(gate, SLOG_FLF) << "Preparing to send " << nmos::fields::message_grain_data(grain->data).size() << " events on websocket connection: " << grain->id;
+                // state messages are coalesced and throttled according to the subscription's max_update_rate_ms
+                // or a source's own max_update_rate_ms, so that bursts of changes to high-rate sources such as meters
+                // result in at most one message per source per interval, carrying the latest state
+                const auto max_update_rate = std::chrono::milliseconds(nmos::fields::max_update_rate_ms(subscription->data));
 
-                for (const auto& event : nmos::fields::message_grain_data(grain->data).as_array())
+                std::vector<value> messages;
+                resources.modify(grain, [&](nmos::resource& grain)
                 {
-                    web::websockets::websocket_outgoing_message message;
+                    auto& events = nmos::fields::message_grain_data(grain.data);
 
-                    if (event.has_field(U("message_type")))
+                    const auto earliest_allowed_update = details::prepare_events_ws_messages(messages, events, sent_states[grain.id], max_update_rate, now);
+                    if (earliest_allowed_update < earliest_necessary_update)
                     {
-                        // reboot, shutdown or health message
-                        message.set_utf8_message(utility::us2s(event.serialize()));
-                        outgoing_messages.push_back({ websocket.second, message });
-                    }
-                    else if (event.has_field(U("post")))
-                    {
-                        // state message
-                        // see https://specs.amwa.tv/is-07/releases/v1.0.1/docs/2.0._Message_types.html#11-the-state-message-type
-                        // and nmos::make_events_boolean_state, nmos::make_events_number_state, etc.
-                        // and nmos::details::make_resource_event
-                        const web::json::value& state = nmos::fields::endpoint_state(event.at(U("post")));
-                        message.set_utf8_message(utility::us2s(state.serialize()));
-                        outgoing_messages.push_back({ websocket.second, message });
+                        earliest_necessary_update = earliest_allowed_update;
                     }
+
+                    // only mark the grain as updated if some events have actually been sent or coalesced
+                    // otherwise this thread would be woken immediately to find only the same delayed events
+                    if (!messages.empty() || events_count != events.size()) grain.updated = strictly_increasing_update(resources);
+                });
+
+                if (!messages.empty())
+                {
+                    slog::log<slog::severities::info>(gate, SLOG_FLF) << "Preparing to send " << messages.size() << " of " << events_count << " events on websocket connection: " << grain->id;
                 }
 
-                // reset the grain for next time
-                resources.modify(grain, [&resources](nmos::resource& grain)
+                for (const auto& event : messages)
                 {
-                    // all messages have now been prepared
-                    nmos::fields::message_grain_data(grain.data) = value::array();
-                    grain.updated = strictly_increasing_update(resources);
-                });
+                    web::websockets::websocket_outgoing_message message;
+                    message.set_utf8_message(utility::us2s(event.serialize()));
+                    outgoing_messages.push_back({ websocket.second, message });
+                }
 
                 ++wit;
             }
 
+            // forget the rate limiting state of websocket connections that have been closed
+            for (auto sit = sent_states.begin(); sent_states.end() != sit;)
+            {
+                if (websockets.left.end() == websockets.left.find(sit->first)) sit = sent_states.erase(sit); else ++sit;
+            }
+
             // send the messages without the lock on resources
             details::reverse_lock_guard<nmos::write_lock> unlock{ lock };
 
@@ -1,6 +1,8 @@
 #ifndef NMOS_EVENTS_WS_API_H
 #define NMOS_EVENTS_WS_API_H
 
+#include <map>
+#include <vector>
 #include "nmos/events_resources.h"
 #include "nmos/websockets.h"
 
@@ -45,6 +47,19 @@ namespace nmos
     // see https://specs.amwa.tv/is-07/releases/v1.0.1/docs/2.0._Message_types.html#15-the-health-message-type
     web::json::value make_events_health_message(const nmos::details::events_state_timing& timing);
 
+    namespace details
+    {
+        // the time at which the most recent state message for each source was sent on one websocket connection
+        typedef std::map<nmos::id, tai_clock::time_point> events_ws_sent_states;
+
+        // prepare the messages that may be sent now for the specified events, which are removed from the array
+        // reboot, shutdown and health messages are never delayed, nor are state messages for a source with no minimum interval
+        // otherwise state messages are coalesced, so that only the latest state of each source remains, and at most one per interval is sent
+        // the minimum interval for a source is its "max_update_rate_ms" if specified, otherwise the subscription's max_update_rate
+        // returns the earliest time at which any remaining, i.e. delayed, state message may be sent
+        tai_clock::time_point prepare_events_ws_messages(std::vector<web::json::value>& messages, web::json::value& events, events_ws_sent_states& sent_states, const std::chrono::milliseconds& max_update_rate, const tai_clock::time_point& now);
+    }
+
     void send_events_ws_messages_thread(web::websockets::experimental::listener::websocket_listener& listener, nmos::node_model& model, nmos::websockets& websockets, slog::base_gate& gate);
     void erase_expired_events_resources_thread(nmos::node_model& model, slog::base_gate& gate);
 }
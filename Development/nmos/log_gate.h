@@ -56,23 +56,23 @@ namespace nmos
         protected:
             virtual bool pertinent(const std::list<nmos::category>& categories) const
             {
-                if (!model.settings.has_field(nmos::fields::logging_categories))
+                const auto settings = model.settings_snapshot();
+
+                if (settings->logging_all_categories)
                 {
                     return true;
                 }
 
-                const auto& pertinent_categories = nmos::fields::logging_categories(model.settings);
+                const auto& pertinent_categories = settings->logging_categories;
 
                 if (categories.empty())
                 {
-                    static const auto no_category = web::json::value::string(utility::string_t());
-                    return pertinent_categories.end() != boost::range::find(pertinent_categories, no_category);
+                    return 0 != pertinent_categories.count(nmos::category());
                 }
 
-                // this could be made more efficient if there may be many pertinent categories
                 return categories.end() != boost::range::find_if(categories, [&](const nmos::category& c)
                 {
-                    return pertinent_categories.end() != boost::range::find(pertinent_categories, web::json::value::string(utility::s2us(c)));
+                    return 0 != pertinent_categories.count(c);
                 });
             }
 
@@ -109,7 +109,7 @@ namespace nmos
                     access_log << nmos::common_log_format(message);
                 }
 
-                nmos::experimental::insert_log_event(model.events, message, generate_id(), nmos::experimental::fields::logging_limit(model.settings));
+                nmos::experimental::insert_log_event(model.events, message, generate_id(), model.settings_snapshot()->logging_limit);
             }
 
             mutable slog::async_log_service<service_function> async_service;
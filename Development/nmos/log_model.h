@@ -2,6 +2,7 @@
 #define NMOS_LOG_MODEL_H
 
 #include <atomic>
+#include <memory>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
@@ -60,6 +61,9 @@ namespace nmos
             // application-wide configuration
             nmos::settings settings;
 
+            // typed snapshot of frequently used settings, initially of the default settings, see settings_snapshot() and update_settings_snapshot()
+            std::shared_ptr<const nmos::settings_snapshot> current_settings_snapshot = nmos::make_settings_snapshot(settings);
+
             // the logging level is a special case because we want to turn it into an atomic value
             // that can be read by logging statements without locking the mutex protecting the settings
             std::atomic<slog::severity> level{ nmos::fields::logging_level.default_value };
@@ -71,6 +75,11 @@ namespace nmos
 
             nmos::read_lock read_lock() const { return nmos::read_lock{ mutex }; }
             nmos::write_lock write_lock() const { return nmos::write_lock{ mutex }; }
+
+            // typed snapshot of frequently used settings, which can be read without locking the mutex
+            std::shared_ptr<const nmos::settings_snapshot> settings_snapshot() const { return std::atomic_load(&current_settings_snapshot); }
+            // replace the snapshot, which must be done whenever the settings are modified (with the mutex locked)
+            void update_settings_snapshot() { std::atomic_store(&current_settings_snapshot, nmos::make_settings_snapshot(settings)); }
         };
 
         // push a log event into the model keeping a maximum size (lock the mutex before calling this)
@@ -99,11 +99,14 @@ namespace nmos
                 }
                 basic_query.erase(U("query"));
             }
+
+            // fold the Basic Query once, since all string matches are case-insensitive
+            basic_query = web::json::fold_query(basic_query);
         }
 
         log_event_query::result_type log_event_query::operator()(argument_type event) const
         {
-            return web::json::match_query(event.data, basic_query, web::json::match_icase | web::json::match_substr)
+            return web::json::match_query(event.data, basic_query, web::json::match_folded | web::json::match_substr)
                 && match_logging_rql(event.data, rql_query);
         }
 
@@ -25,6 +25,9 @@ namespace nmos
         // application-wide configuration
         nmos::settings settings;
 
+        // typed snapshot of frequently used settings, initially of the default settings, see settings_snapshot() and update_settings_snapshot()
+        std::shared_ptr<const nmos::settings_snapshot> current_settings_snapshot = nmos::make_settings_snapshot(settings);
+
         // flag indicating whether shutdown has been initiated
         bool shutdown = false;
 
@@ -35,6 +38,11 @@ namespace nmos
         nmos::write_lock write_lock() const { return nmos::write_lock{ mutex }; }
         void notify() const { return condition.notify_all(); }
 
+        // typed snapshot of frequently used settings, which can be read without locking the mutex
+        std::shared_ptr<const nmos::settings_snapshot> settings_snapshot() const { return std::atomic_load(&current_settings_snapshot); }
+        // replace the snapshot, which must be done whenever the settings are modified (with the mutex locked)
+        void update_settings_snapshot() { std::atomic_store(&current_settings_snapshot, nmos::make_settings_snapshot(settings)); }
+
         template <class ReadOrWriteLock>
         void wait(ReadOrWriteLock& lock)
         {
@@ -1,5 +1,6 @@
 #include "nmos/node_behaviour.h"
 
+#include <list>
 #include "pplx/pplx_utils.h" // for pplx::complete_at
 #include "cpprest/http_client.h"
 #include "cpprest/json_storage.h"
@@ -366,6 +367,9 @@ namespace nmos
                     swap(events, nmos::fields::message_grain_data(grain.data));
                     grain.updated = strictly_increasing_update(resources);
                 });
+
+                // when the resources have been changed several times since the events were last stolen, only the latest state need be registered
+                coalesce_resource_events(node_behaviour_topic, events);
             }
 
             ~node_behaviour_grain_guard()
@@ -393,6 +397,38 @@ namespace nmos
             nmos::resources::iterator grain;
             web::json::value& events;
         };
+
+        // a request on the Registration API /resource endpoint for a resource event, which may be in flight concurrently with others
+        struct registration_request
+        {
+            web::json::value event;
+            std::pair<nmos::id, nmos::type> id_type;
+            std::pair<nmos::id, nmos::type> super_id_type;
+            // set when the request has been completed successfully (or with an ignored failure)
+            bool done;
+            // set when the request has been abandoned (e.g. due to a registration service error) and the event returned to the grain
+            bool abandoned;
+        };
+
+        bool is_dependent_request(const std::pair<nmos::id, nmos::type>& in_flight_id_type, const std::pair<nmos::id, nmos::type>& in_flight_super_id_type, const std::pair<nmos::id, nmos::type>& id_type, const std::pair<nmos::id, nmos::type>& super_id_type)
+        {
+            return in_flight_id_type.first == id_type.first
+                || in_flight_id_type.first == super_id_type.first
+                || in_flight_super_id_type.first == id_type.first;
+        }
+
+        // return a task that completes when both the specified tasks have completed, successfully or not
+        pplx::task<void> when_both_done(pplx::task<void> first, pplx::task<void> second)
+        {
+            return first.then([second](pplx::task<void> finally)
+            {
+                try { finally.wait(); } catch (...) {}
+                return second;
+            }).then([](pplx::task<void> finally)
+            {
+                try { finally.wait(); } catch (...) {}
+            });
+        }
     }
 
     // registered operation
@@ -727,6 +763,9 @@ namespace nmos
                     {
                         subscription.version = registry_version;
 
+                        // the subscription query must be made again for the new version
+                        subscription.subscription_query = details::make_subscription_query(resources, subscription);
+
                         subscription.updated = strictly_increasing_update(resources);
                     });
 
@@ -836,10 +875,14 @@ namespace nmos
 
             web::json::value events;
 
+            // requests for independent resources may be in flight concurrently, see nmos::experimental::fields::registration_concurrency
+            std::list<registration_request> requests;
+
             std::chrono::steady_clock::time_point heartbeat_time;
 
             // background tasks may read/write the above local state by reference
             pplx::cancellation_token_source cancellation_source;
+            // this task completes when all the requests have completed
             pplx::task<void> request = pplx::task_from_result();
             pplx::task<void> heartbeats = pplx::task_from_result();
 
@@ -866,6 +909,7 @@ namespace nmos
                     request.wait();
                     heartbeats.wait();
 
+                    requests.clear();
                     registration_client.reset();
                     heartbeat_client.reset();
                     cancellation_source = pplx::cancellation_token_source();
@@ -961,54 +1005,91 @@ namespace nmos
                 node_behaviour_grain_guard guard(resources, grain, events);
                 most_recent_update = grain->updated;
 
-                while (0 != events.size())
+                const size_t concurrency = (size_t)(std::max)(1, nmos::experimental::fields::registration_concurrency(model.settings));
+
+                while (0 != events.size() || !requests.empty())
                 {
                     if (shutdown || registration_service_error || node_unregistered) break;
 
-                    const auto id_type = get_resource_event_resource(node_behaviour_topic, events.at(0));
-                    const auto event_type = get_resource_event_type(events.at(0));
+                    // forget the completed requests
+                    requests.remove_if([](const registration_request& request) { return request.done; });
 
-                    auto token = cancellation_source.get_token();
-                    request = details::request_registration(*registration_client, events.at(0), gate, token).then([&](pplx::task<void> finally)
+                    // make requests for as many events as possible, in order
+                    while (0 != events.size() && requests.size() < concurrency)
                     {
-                        auto lock = model.write_lock(); // in order to update local state
+                        const auto& event = events.at(0);
+                        const auto id_type = get_resource_event_resource(node_behaviour_topic, event);
+                        const auto event_type = get_resource_event_type(event);
 
-                        try
+                        const auto& data = resource_removed_event == event_type ? event.at(U("pre")) : event.at(U("post"));
+                        const auto super_id_type = nmos::get_super_resource(grain->version, id_type.second, data);
+
+                        // wait for any in-flight request on which this one depends
+                        const bool dependent = requests.end() != std::find_if(requests.begin(), requests.end(), [&](const registration_request& request)
                         {
-                            finally.get();
+                            return !request.done && is_dependent_request(request.id_type, request.super_id_type, id_type, super_id_type);
+                        });
+                        if (dependent) break;
 
-                            // on success (or an ignored failure), discard the resource event
-                            if (0 != events.size())
+                        requests.push_back(registration_request{ event, id_type, super_id_type, false, false });
+                        const auto in_flight = std::prev(requests.end());
+                        events.erase(0);
+
+                        auto token = cancellation_source.get_token();
+                        auto dispatched = details::request_registration(*registration_client, in_flight->event, gate, token).then([&, in_flight](pplx::task<void> finally)
+                        {
+                            auto lock = model.write_lock(); // in order to update local state
+
+                            try
                             {
-                                events.erase(0);
+                                finally.get();
+
+                                // on success (or an ignored failure), discard the resource event
+                                in_flight->done = true;
+
+                                // "Following deletion of all other resources, the Node resource may be deleted and heartbeating stopped."
+                                // See https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.1._Behaviour_-_Registration.html#controlled-unregistration
+                                if (self_id == in_flight->id_type.first && resource_removed_event == get_resource_event_type(in_flight->event))
+                                {
+                                    node_unregistered = true;
+                                }
                             }
+                            catch (const web::http::http_exception& e)
+                            {
+                                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration request HTTP error: " << e.what() << " [" << e.error_code() << "]";
 
-                            // "Following deletion of all other resources, the Node resource may be deleted and heartbeating stopped."
-                            // See https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.1._Behaviour_-_Registration.html#controlled-unregistration
-                            if (self_id == id_type.first && resource_removed_event == event_type)
+                                registration_service_error = true;
+                            }
+                            catch (const registration_service_exception&)
                             {
-                                node_unregistered = true;
+                                registration_service_error = true;
                             }
-                        }
-                        catch (const web::http::http_exception& e)
+                        });
+                        // avoid race condition between condition.notify_all() and checking whether requests are done
+                        request = when_both_done(request, dispatched.then([&]
                         {
-                            slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration request HTTP error: " << e.what() << " [" << e.error_code() << "]";
+                            condition.notify_all();
+                        }));
+                    }
 
-                            registration_service_error = true;
-                        }
-                        catch (const registration_service_exception&)
-                        {
-                            registration_service_error = true;
-                        }
-                    });
-                    // avoid race condition between condition.notify_all() and request.is_done()
-                    request.then([&]
-                    {
-                        condition.notify_all();
-                    });
+                    if (requests.empty()) continue;
 
-                    // wait for the request because interactions with the Registration API /resource endpoint must be sequential
-                    condition.wait(lock, [&]{ return shutdown || registration_service_error || node_unregistered || request.is_done(); });
+                    // wait for a request to complete, because interactions with the Registration API /resource endpoint for dependent resources must be sequential
+                    condition.wait(lock, [&]{ return shutdown || registration_service_error || node_unregistered || requests.end() != std::find_if(requests.begin(), requests.end(), [](const registration_request& request) { return request.done; }); });
+                }
+
+                // return the events for any incomplete requests to the grain, to be requested again
+                std::vector<web::json::value> incomplete;
+                for (auto& request : requests)
+                {
+                    if (request.done || request.abandoned) continue;
+                    incomplete.push_back(request.event);
+                    request.abandoned = true;
+                }
+                if (!incomplete.empty())
+                {
+                    auto& events_storage = web::json::storage_of(events.as_array());
+                    events_storage.insert(events_storage.begin(), incomplete.begin(), incomplete.end());
                 }
             }
 
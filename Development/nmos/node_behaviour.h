@@ -2,7 +2,10 @@
 #define NMOS_NODE_BEHAVIOUR_H
 
 #include <functional>
+#include <utility>
 #include "nmos/certificate_handlers.h"
+#include "nmos/id.h"
+#include "nmos/type.h"
 
 namespace web
 {
@@ -46,6 +49,13 @@ namespace nmos
 
     // uses the specified DNS-SD implementation
     void node_behaviour_thread(nmos::model& model, load_ca_certificates_handler load_ca_certificates, mdns::service_advertiser& advertiser, mdns::service_discovery& discovery, slog::base_gate& gate);
+
+    namespace details
+    {
+        // registration requests for the same resource, or for a resource and one of its sub-resources, must be sequential
+        // so that e.g. a super-resource is registered before its sub-resources, and unregistered after them
+        bool is_dependent_request(const std::pair<nmos::id, nmos::type>& in_flight_id_type, const std::pair<nmos::id, nmos::type>& in_flight_super_id_type, const std::pair<nmos::id, nmos::type>& id_type, const std::pair<nmos::id, nmos::type>& super_id_type);
+    }
 }
 
 #endif
@@ -27,6 +27,11 @@ namespace nmos
 
             slog::log<slog::severities::info>(gate, SLOG_FLF) << "Configuring nmos-cpp node with its primary Node API at: " << nmos::get_host(node_model.settings) << ":" << nmos::fields::node_port(node_model.settings);
 
+            // Make sure the typed snapshots reflect the settings
+
+            node_model.update_settings_snapshot();
+            log_model.update_settings_snapshot();
+
             nmos::server node_server{ node_model };
 
             // Set up the APIs, assigning them to the configured ports
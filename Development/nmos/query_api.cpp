@@ -21,6 +21,12 @@ namespace nmos
     {
         using namespace web::http::experimental::listener::api_router_using_declarations;
 
+        // make sure the typed snapshot used for paging reflects the settings, since the API may be made without nmos::make_registry_server
+        {
+            auto lock = model.read_lock();
+            model.update_settings_snapshot();
+        }
+
         api_router query_api;
 
         query_api.support(U("/?"), methods::GET, [](http_request req, http_response res, const string_t&, const route_parameters&)
@@ -342,7 +348,7 @@ namespace nmos
 
             // Configure the query predicate
 
-            const resource_query match(version, U('/') + resourceType, flat_query_params);
+            const resource_query match(version, U('/') + resourceType, flat_query_params, resources);
             // const auto pred = [&](const nmos::resource& r) { return match(r, resources); }, or std::bind(std::cref(match), std::placeholders::_1, std::cref(resources)) OK from Boost.Range 1.56.0
             struct { const resource_query* rq; const nmos::resources* rs; bool operator()(const nmos::resource& r) const { return (*rq)(r, *rs); } } pred{ &match, &resources };
 
@@ -351,12 +357,18 @@ namespace nmos
             // Configure the paging parameters
 
             // Limit queries to the current resources (although tai_now() would also be an option?) and use the paging limit (default and max) from the setings
-            resource_paging paging(flat_query_params, most_recent_update(resources), (size_t)nmos::fields::query_paging_default(model.settings), (size_t)nmos::fields::query_paging_limit(model.settings));
+            const auto settings = model.settings_snapshot();
+            resource_paging paging(flat_query_params, most_recent_update(resources), settings->query_paging_default, settings->query_paging_limit);
 
             if (paging.valid())
             {
                 // Get the payload and update the paging parameters
-                auto page = paging.page(resources, pred);
+                // (the query type is always a specific resource type, so only those resources need be considered,
+                // and when the query requires a specific value of an indexed property, only those with that value)
+                const property_index_range indexed(resources, match, paging.order_by_created);
+                auto page = !match.index_property.empty()
+                    ? paging.page(indexed, pred)
+                    : paging.page(resources, match.type, pred);
 
                 size_t count = 0;
 
@@ -372,10 +384,11 @@ namespace nmos
                 }
                 else
                 {
+                    // polling clients typically list the same resources repeatedly, so reuse the serialized data
                     set_reply(res, status_codes::OK,
-                        web::json::serialize_array(page
+                        web::json::concatenate_array(page
                             | boost::adaptors::transformed(
-                                [&count, &match](const nmos::resources::value_type& resource) { ++count; return match.downgrade(resource); }
+                                [&count, &match](const nmos::resources::value_type& resource) -> const utility::string_t& { ++count; return match.serialize(resource); }
                             )),
                         web::http::details::mime_types::application_json);
                 }
@@ -423,7 +436,7 @@ namespace nmos
                     }
                     else
                     {
-                        set_reply(res, status_codes::OK, match.downgrade(*resource));
+                        set_reply(res, status_codes::OK, match.serialize(*resource), web::http::details::mime_types::application_json);
                     }
 
                     // experimental extension, see also nmos::make_resource_events for equivalent WebSockets extension
@@ -526,7 +539,8 @@ namespace nmos
 
                     // if the query parameters are not supported, an exception from either of these constructors will result in an appropriate response, e.g. a 501 HTTP status code
                     // see https://github.com/AMWA-TV/is-04/pull/99
-                    const resource_query match(version, nmos::fields::resource_path(data), nmos::fields::params(data));
+                    // the subscription query is made once here, and then reused for every resource event
+                    auto match = std::make_shared<const resource_query>(version, nmos::fields::resource_path(data), nmos::fields::params(data), resources);
                     const resource_paging paging(nmos::fields::params(data));
 
                     // get the request host
@@ -573,6 +587,7 @@ namespace nmos
 
                         // never expire persistent subscriptions, they are only deleted when explicitly requested
                         nmos::resource subscription{ version, nmos::types::subscription, data, nmos::fields::persist(data) };
+                        subscription.subscription_query = std::move(match);
 
                         resource = insert_resource(resources, std::move(subscription)).first;
                     }
@@ -1,18 +1,20 @@
 #include "nmos/query_utils.h"
 
 #include <set>
+#include <unordered_map>
 #include <boost/algorithm/string/erase.hpp>
+#include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include "cpprest/basic_utils.h"
+#include "cpprest/json_storage.h"
 #include "nmos/api_downgrade.h"
 #include "nmos/api_utils.h" // for nmos::resourceType_from_type
 #include "nmos/rational.h"
 #include "nmos/sdp_utils.h" // for nmos::details::make_sampling
 #include "nmos/version.h"
-#include "rql/rql.h"
 
 namespace nmos
 {
@@ -31,14 +33,68 @@ namespace nmos
     }
 
     rql::operators make_rql_operators(const nmos::resources& resources);
+    rql::compiled_operators make_rql_compiled_operators(const nmos::resources& resources);
+
+    namespace details
+    {
+        // resource_path may be empty (matching all resource types) or e.g. "/nodes"
+        static nmos::type type_from_resource_path(const utility::string_t& resource_path)
+        {
+            if (resource_path.empty()) return{};
+
+            const auto resourceType = resource_path.substr(1);
+            for (const auto& type : nmos::types::all)
+            {
+                if (resourceType == nmos::resourceType_from_type(type)) return type;
+            }
+
+            // a resource_path which doesn't correspond to any resource type matches nothing
+            return nmos::type{ resource_path };
+        }
+
+        // properties which are commonly required by subscription queries to have a specific value, such as a device_id
+        // see nmos::insert_resource_events
+        static const std::vector<utility::string_t>& key_properties()
+        {
+            static const std::vector<utility::string_t> key_properties
+            {
+                nmos::fields::id,
+                nmos::fields::node_id,
+                nmos::fields::device_id,
+                nmos::fields::source_id,
+                nmos::fields::flow_id,
+                nmos::fields::format
+            };
+            return key_properties;
+        }
+
+        // properties which have a property index, in order of preference
+        // unselective properties such as format are not indexed, since all the candidates from a property index are collected
+        // and sorted before paging, whereas a scan of the type index can stop as soon as the page is full
+        // see nmos::find_property_resources
+        static const std::vector<std::vector<utility::string_t>>& index_properties()
+        {
+            static const std::vector<std::vector<utility::string_t>> index_properties
+            {
+                property_key_path<tags::subscription_sender_id>(),
+                property_key_path<tags::flow_id>(),
+                property_key_path<tags::source_id>(),
+                property_key_path<tags::device_id>(),
+                property_key_path<tags::node_id>()
+            };
+            return index_properties;
+        }
+    }
 
     resource_query::resource_query(const nmos::api_version& version, const utility::string_t& resource_path, const web::json::value& flat_query_params)
         : version(version)
         , resource_path(resource_path)
+        , type(details::type_from_resource_path(resource_path))
         , basic_query(web::json::unflatten(flat_query_params))
         , downgrade_version(version)
         , strip(true)
         , match_flags(web::json::match_default)
+        , rql_resources(nullptr)
     {
         // extract the supported advanced query options
         if (basic_query.has_field(U("paging")))
@@ -82,6 +138,103 @@ namespace nmos
             }
             basic_query.erase(U("query"));
         }
+
+        // fold the Basic Query once for case-insensitive matching, rather than in every comparison
+        if (web::json::match_icase == (web::json::match_icase & match_flags))
+        {
+            basic_query = web::json::fold_query(basic_query);
+            match_flags = match_flags | web::json::match_folded;
+        }
+
+        // identify a property which the Basic Query requires to have a specific value
+        // only exact matching allows a resource's property value to be used to look up the query
+        if (web::json::match_default == match_flags)
+        {
+            for (const auto& property : details::key_properties())
+            {
+                if (basic_query.has_field(property) && basic_query.at(property).is_string())
+                {
+                    key_property = property;
+                    key_value = basic_query.at(property).as_string();
+                    break;
+                }
+            }
+
+            for (const auto& key_path : details::index_properties())
+            {
+                web::json::value value;
+                if (web::json::extract(basic_query.as_object(), value, key_path) && value.is_string())
+                {
+                    index_property = boost::algorithm::join(key_path, U("."));
+                    index_value = value.as_string();
+                    break;
+                }
+            }
+        }
+    }
+
+    resource_query::resource_query(const nmos::api_version& version, const utility::string_t& resource_path, const web::json::value& flat_query_params, const nmos::resources& resources)
+        : resource_query(version, resource_path, flat_query_params)
+    {
+        if (!rql_query.is_null())
+        {
+            rql_operators = std::make_shared<const rql::operators>(make_rql_operators(resources));
+            rql_resources = &resources;
+
+            try
+            {
+                rql_plan = std::make_shared<const rql::plan>(rql::compile_query(rql_query, std::make_shared<const rql::compiled_operators>(make_rql_compiled_operators(resources))));
+            }
+            catch (const std::exception&)
+            {
+                // e.g. invalid args, which are left to be reported by the interpreter when the query is evaluated
+            }
+        }
+    }
+
+    // find the extant resources of the query's resource type which could match the query, using the index of the property which
+    // the query requires to have a specific value, or return false if the query doesn't identify such a property
+    bool find_property_resources(std::vector<const nmos::resource*>& results, const nmos::resources& resources, const nmos::resource_query& query)
+    {
+        if (query.index_property.empty()) return false;
+
+        if (!find_property_resources(results, resources, query.type, query.index_property, details::string_property_value, query.index_value)) return false;
+
+        // a query requiring a specific string value may still match a resource value of another type, e.g. an array,
+        // or if the query value is itself valid json, see web::json::match_query
+        find_property_resources(results, resources, query.type, query.index_property, details::array_property_value);
+        std::error_code ec;
+        web::json::value::parse(query.index_value, ec);
+        if (!ec)
+        {
+            find_property_resources(results, resources, query.type, query.index_property, details::other_property_value);
+        }
+
+        return true;
+    }
+
+    property_index_range::property_index_range(const nmos::resources& resources, const nmos::resource_query& query, bool order_by_created)
+        : order_by_created(order_by_created)
+    {
+        if (find_property_resources(candidates, resources, query))
+        {
+            // in descending order, like the created/updated indices
+            if (order_by_created)
+            {
+                std::sort(candidates.begin(), candidates.end(), [](const nmos::resource* lhs, const nmos::resource* rhs) { return lhs->created > rhs->created; });
+            }
+            else
+            {
+                std::sort(candidates.begin(), candidates.end(), [](const nmos::resource* lhs, const nmos::resource* rhs) { return lhs->updated > rhs->updated; });
+            }
+        }
+    }
+
+    property_index_range::const_iterator lower_bound(const property_index_range& range, const nmos::tai& timestamp)
+    {
+        return range.order_by_created
+            ? std::lower_bound(range.begin(), range.end(), timestamp, [](const nmos::resource& resource, const nmos::tai& timestamp) { return resource.created > timestamp; })
+            : std::lower_bound(range.begin(), range.end(), timestamp, [](const nmos::resource& resource, const nmos::tai& timestamp) { return resource.updated > timestamp; });
     }
 
     resource_paging::resource_paging(const web::json::value& flat_query_params, const nmos::tai& max_until, size_t default_limit, size_t max_limit)
@@ -263,6 +416,14 @@ namespace nmos
         };
     }
 
+    static inline rql::path_extractor make_rql_path_extractor(const web::json::value& value)
+    {
+        return [&value](web::json::value& results, const rql::key_path& key_path)
+        {
+            return web::json::extract(value.as_object(), results, key_path);
+        };
+    }
+
     namespace experimental
     {
         // Sub-query operators
@@ -277,7 +438,7 @@ namespace nmos
             const auto relation_value = eval(args.at(0), true);
             const auto query = args.at(1);
 
-            const auto& operators = eval.operators;
+            const auto& operators = eval.shared_operators;
             const auto rel = [&resolve, &relation_name, &operators, &query](const web::json::value& relation_value)
             {
                 // evaluate the call-operator against the specified data
@@ -305,6 +466,54 @@ namespace nmos
             return indeterminate ? rql::value_indeterminate : rql::value_false;
         }
 
+        // Compiled equivalent of relation_query
+        // the relation is resolved to a reference, rather than a copy of the linked data
+        template <typename ResolveRelation>
+        rql::plan compile_relation_query(const rql::compiler& compile, const web::json::value& args, ResolveRelation resolve)
+        {
+            const auto relation_name = compile(args.at(0));
+            const auto relation_value = compile(args.at(0), true);
+            const auto query = compile(args.at(1));
+
+            return [relation_name, relation_value, query, resolve](const rql::path_extractor& extract)
+            {
+                const auto name = relation_name(extract).as_string();
+                const auto value = relation_value(extract);
+
+                const auto rel = [&resolve, &name, &query](const web::json::value& relation_value)
+                {
+                    // evaluate the call-operator against the specified data
+                    return query(make_rql_path_extractor(resolve(name, relation_value)));
+                };
+
+                // cf. rql::details::logical_or
+                if (!value.is_array())
+                {
+                    return rel(value);
+                }
+                bool indeterminate = false;
+                for (const auto& rv : value.as_array())
+                {
+                    auto result = rel(rv);
+                    if (!result.is_boolean())
+                    {
+                        indeterminate = true;
+                    }
+                    else if (result.as_bool())
+                    {
+                        return rql::value_true;
+                    }
+                }
+                return indeterminate ? rql::value_indeterminate : rql::value_false;
+            };
+        }
+
+        static const web::json::value& empty_object()
+        {
+            static const web::json::value empty = web::json::value::object();
+            return empty;
+        }
+
         // Experimental support for the 'rel' operator, in order to allow e.g. matching senders based on their flows' formats
         // rel(<relation-name>, <call-operator>) - Applies the provided call-operator against the linked data of the provided relation-name
         web::json::value rel(const nmos::resources& resources, const rql::evaluator& eval, const web::json::value& args)
@@ -348,6 +557,54 @@ namespace nmos
         }
     }
 
+    namespace experimental
+    {
+        // Compiled equivalent of rel
+        rql::plan compile_rel(const nmos::resources& resources, const rql::compiler& compile, const web::json::value& args)
+        {
+            return compile_relation_query(compile, args, [&resources](const utility::string_t& relation_name, const web::json::value& relation_value) -> const web::json::value&
+            {
+                if (relation_value.is_string())
+                {
+                    // see rel
+                    nmos::type relation_type{ erase_tail_copy(relation_name.substr(relation_name.find_last_of(U('.')) + 1), U("_id")) };
+                    nmos::id relation_id{ relation_value.as_string() };
+
+                    auto found = find_resource(resources, { relation_id, relation_type });
+                    if (resources.end() == found) return rql::value_indeterminate;
+
+                    // return the linked value
+                    return found->data;
+                }
+                return empty_object();
+            });
+        }
+
+        // Compiled equivalent of sub
+        rql::plan compile_sub(const rql::compiler& compile, const web::json::value& args)
+        {
+            return compile_relation_query(compile, args, [](const utility::string_t& relation_name, const web::json::value& relation_value) -> const web::json::value&
+            {
+                if (relation_value.is_object())
+                {
+                    // effectively just changes the extractor context to a sub-object
+                    return relation_value;
+                }
+                return empty_object();
+            });
+        }
+    }
+
+    rql::compiled_operators make_rql_compiled_operators(const nmos::resources& resources)
+    {
+        auto operators = rql::default_any_compiled_operators(equal_to, less);
+
+        operators[U("rel")] = std::bind(experimental::compile_rel, std::cref(resources), std::placeholders::_1, std::placeholders::_2);
+        operators[U("sub")] = experimental::compile_sub;
+
+        return operators;
+    }
+
     rql::operators make_rql_operators(const nmos::resources& resources)
     {
         auto operators = rql::default_any_operators(equal_to, less);
@@ -358,11 +615,11 @@ namespace nmos
         return operators;
     }
 
-    bool match_rql(const web::json::value& value, const web::json::value& query, const nmos::resources& resources)
+    bool match_rql(const web::json::value& value, const web::json::value& query, const std::shared_ptr<const rql::operators>& operators)
     {
         try
         {
-            return query.is_null() || rql::evaluator{ make_rql_extractor(value), make_rql_operators(resources) }(query) == rql::value_true;
+            return query.is_null() || rql::evaluator{ make_rql_extractor(value), operators }(query) == rql::value_true;
         }
         catch (const std::runtime_error&) // i.e. rql::details::rql_exception
         {
@@ -370,15 +627,34 @@ namespace nmos
         }
     }
 
+    bool match_rql(const web::json::value& value, const rql::plan& plan)
+    {
+        try
+        {
+            return plan(make_rql_path_extractor(value)) == rql::value_true;
+        }
+        catch (const std::runtime_error&) // i.e. rql::details::rql_exception
+        {
+            return false;
+        }
+    }
+
+    bool match_rql(const web::json::value& value, const web::json::value& query, const nmos::resources& resources)
+    {
+        return query.is_null() || match_rql(value, query, std::make_shared<const rql::operators>(make_rql_operators(resources)));
+    }
+
     resource_query::result_type resource_query::operator()(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data, const nmos::resources& resources) const
     {
         // in theory, should be performing match_query against the downgraded resource_data but
         // in practice, I don't think that can make a difference?
         return !resource_data.is_null()
-            && (resource_path.empty() || resource_path == U('/') + nmos::resourceType_from_type(resource_type))
+            && (type.empty() || type == resource_type)
             && nmos::is_permitted_downgrade(resource_version, resource_downgrade_version, resource_type, version, downgrade_version)
             && web::json::match_query(resource_data, basic_query, match_flags)
-            && match_rql(resource_data, rql_query, resources);
+            && (nullptr != rql_resources && &resources == rql_resources
+                ? (rql_plan ? match_rql(resource_data, *rql_plan) : match_rql(resource_data, rql_query, rql_operators))
+                : match_rql(resource_data, rql_query, resources));
     }
 
     web::json::value resource_query::downgrade(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data) const
@@ -389,6 +665,30 @@ namespace nmos
         return nmos::downgrade(resource_version, resource_downgrade_version, resource_type, resource_data, version, downgrade_version);
     }
 
+    bool resource_query::is_unchanged_by_downgrade(const nmos::resource& resource) const
+    {
+        // when requested, the resource is not stripped
+        if (!strip && resource.version.major == version.major && resource.version.minor > version.minor) return true;
+
+        return nmos::details::is_unchanged_by_downgrade(resource.version, resource.downgrade_version, resource.type, resource.data, version, downgrade_version);
+    }
+
+    const utility::string_t& resource_query::serialize(const nmos::resource& resource) const
+    {
+        auto& cache = *resource.serialized;
+        std::lock_guard<std::mutex> lock(cache.mutex);
+
+        // the result also depends on the strip flag, since resources of a higher API version may be returned unstripped
+        const auto key = std::make_tuple(version, downgrade_version, strip);
+        auto found = cache.serialized.find(key);
+        if (cache.serialized.end() == found)
+        {
+            // avoid copying the resource data when the downgrade would not change it, which is the usual case
+            found = cache.serialized.insert({ key, is_unchanged_by_downgrade(resource) ? resource.data.serialize() : downgrade(resource).serialize() }).first;
+        }
+        return found->second;
+    }
+
     // Helpers for constructing /subscriptions websocket grains
 
     namespace details
@@ -398,6 +698,12 @@ namespace nmos
             return type != types::subscription && type != types::grain;
         }
 
+        // make the query for a subscription from its resource_path and params
+        std::shared_ptr<const resource_query> make_subscription_query(const nmos::resources& resources, const nmos::resource& subscription)
+        {
+            return std::make_shared<const resource_query>(subscription.version, nmos::fields::resource_path(subscription.data), nmos::fields::params(subscription.data), resources);
+        }
+
         web::json::value make_grain(const nmos::id& source_id, const nmos::id& flow_id, const utility::string_t& topic)
         {
             using web::json::value;
@@ -472,13 +778,72 @@ namespace nmos
                 return event.at(U("pre")) != event.at(U("post")) ? resource_modified_event : resource_unchanged_event;
             }
         }
+
+        // coalesce the resource events for each resource
+        // 'modified' events following an 'added' or 'modified' event are combined with it, taking the earlier position
+        // and a 'removed' event following a 'modified' event is combined with it, taking the later position, so that
+        // super-resources are still added before their sub-resources, and removed after them
+        void coalesce_resource_events(const utility::string_t& topic, web::json::value& events)
+        {
+            auto& events_storage = web::json::storage_of(events.as_array());
+            if (events_storage.size() < 2) return;
+
+            // the position of the latest event for each resource
+            std::unordered_map<nmos::id, size_t> latest;
+            std::vector<bool> discarded(events_storage.size(), false);
+
+            for (size_t i = 0; i < events_storage.size(); ++i)
+            {
+                auto& event = events_storage[i];
+                const auto id = get_resource_event_resource(topic, event).first;
+
+                auto found = latest.find(id);
+                // an 'added' event is never combined with an earlier 'removed' event, since the resource might have been added quite differently
+                if (latest.end() == found || !event.has_field(U("pre")) || !events_storage[found->second].has_field(U("post")))
+                {
+                    latest[id] = i;
+                    continue;
+                }
+
+                auto& earlier = events_storage[found->second];
+                if (event.has_field(U("post")))
+                {
+                    // 'added' or 'modified' followed by 'modified'
+                    earlier[U("post")] = std::move(event[U("post")]);
+                    discarded[i] = true;
+                }
+                else if (!earlier.has_field(U("pre")))
+                {
+                    // 'added' followed by 'removed'
+                    discarded[found->second] = true;
+                    discarded[i] = true;
+                    latest.erase(found);
+                }
+                else
+                {
+                    // 'modified' followed by 'removed'
+                    event[U("pre")] = std::move(earlier[U("pre")]);
+                    discarded[found->second] = true;
+                    found->second = i;
+                }
+            }
+
+            size_t kept = 0;
+            for (size_t i = 0; i < events_storage.size(); ++i)
+            {
+                if (discarded[i]) continue;
+                if (kept != i) events_storage[kept] = std::move(events_storage[i]);
+                ++kept;
+            }
+            events_storage.resize(kept);
+        }
     }
 
     // make the initial 'sync' resource events for a new grain, including all resources that match the specified version, resource path and flat query parameters
     // optionally, make 'added' resource events instead of 'sync' events
     web::json::value make_resource_events(const nmos::resources& resources, const nmos::api_version& version, const utility::string_t& resource_path, const web::json::value& params, bool sync)
     {
-        const resource_query match(version, resource_path, params);
+        const resource_query match(version, resource_path, params, resources);
 
         std::vector<web::json::value> events;
 
@@ -488,13 +853,22 @@ namespace nmos
         {
             if (!details::is_queryable_resource(type)) continue;
 
-            auto& by_type = resources.get<tags::type>();
-            const auto range = by_type.equal_range(details::has_data(type));
-            for (auto found = range.first; range.second != found; ++found)
+            if (!match.type.name.empty() && type != match.type) continue;
+
+            // when the query requires a specific value of an indexed property, only the resources with that value need be considered
+            std::vector<const nmos::resource*> candidates;
+            if (!find_property_resources(candidates, resources, match))
+            {
+                auto& by_type = resources.get<tags::type>();
+                const auto range = by_type.equal_range(details::has_data(type));
+                for (auto found = range.first; range.second != found; ++found) candidates.push_back(&*found);
+            }
+
+            for (const auto candidate : candidates)
             {
-                auto& resource = *found;
+                auto& resource = *candidate;
 
-                if (!match(resource, resources)) continue;
+                if (type != resource.type || !match(resource, resources)) continue;
 
                 const auto resource_data = match.downgrade(resource);
                 auto event = details::make_resource_event(resource_path, resource.type, sync ? resource_data : web::json::value::null(), resource_data);
@@ -521,6 +895,56 @@ namespace nmos
         return web::json::value_from_elements(events);
     }
 
+    namespace details
+    {
+        // find the subscriptions which could match a resource event of the specified type and "pre" or "post" values, using the subscription index
+        // i.e. subscriptions for this resource type or all types, which either don't require a specific property value
+        // or require a value which the "pre" or "post" resource has
+        std::vector<const nmos::resource*> find_subscriptions(const nmos::resources& resources, const nmos::type& type, const web::json::value& pre, const web::json::value& post)
+        {
+            std::vector<const nmos::resource*> results;
+
+            auto& by_subscription = resources.get<tags::subscription>();
+            const auto insert_results = [&results](const std::pair<nmos::resources::index<tags::subscription>::type::const_iterator, nmos::resources::index<tags::subscription>::type::const_iterator>& range)
+            {
+                for (auto it = range.first; range.second != it; ++it) results.push_back(&*it);
+            };
+
+            for (const auto& key_type : { type, nmos::type{} })
+            {
+                insert_results(by_subscription.equal_range(boost::make_tuple(true, key_type, utility::string_t{}, utility::string_t{})));
+
+                for (const auto& property : key_properties())
+                {
+                    // a query requiring a specific string value may still match a resource value of another type, e.g. an array
+                    // see web::json::match_query
+                    bool any_value = false;
+                    std::set<utility::string_t> values;
+                    for (const auto& data : { &pre, &post })
+                    {
+                        if (!data->is_object() || !data->has_field(property)) continue;
+                        const auto& value = data->at(property);
+                        if (value.is_string()) values.insert(value.as_string()); else any_value = true;
+                    }
+
+                    if (any_value)
+                    {
+                        insert_results(by_subscription.equal_range(boost::make_tuple(true, key_type, property)));
+                    }
+                    else
+                    {
+                        for (const auto& value : values)
+                        {
+                            insert_results(by_subscription.equal_range(boost::make_tuple(true, key_type, property, value)));
+                        }
+                    }
+                }
+            }
+
+            return results;
+        }
+    }
+
     // insert 'added', 'removed' or 'modified' resource events into all grains whose subscriptions match the specified version, type and "pre" or "post" values
     void insert_resource_events(nmos::resources& resources, const nmos::api_version& version, const nmos::api_version& downgrade_version, const nmos::type& type, const web::json::value& pre, const web::json::value& post)
     {
@@ -529,17 +953,15 @@ namespace nmos
 
         if (!details::is_queryable_resource(type)) return;
 
-        auto& by_type = resources.get<tags::type>();
-        const auto subscriptions = by_type.equal_range(details::has_data(nmos::types::subscription));
-        for (auto it = subscriptions.first; subscriptions.second != it; ++it)
+        for (const auto& found : details::find_subscriptions(resources, type, pre, post))
         {
-            // for each subscription
-            const auto& subscription = *it;
+            // for each subscription which could match
+            const auto& subscription = *found;
 
             // check whether the resource_path matches the resource type and the query parameters match either the "pre" or "post" resource
 
-            const auto resource_path = nmos::fields::resource_path(subscription.data);
-            const resource_query match(subscription.version, resource_path, nmos::fields::params(subscription.data));
+            const resource_query& match = *subscription.subscription_query;
+            const auto& resource_path = match.resource_path;
 
             const bool pre_match = match(version, downgrade_version, type, pre, resources);
             const bool post_match = match(version, downgrade_version, type, post, resources);
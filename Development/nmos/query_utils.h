@@ -1,9 +1,11 @@
 #ifndef NMOS_QUERY_UTILS_H
 #define NMOS_QUERY_UTILS_H
 
+#include <boost/iterator/indirect_iterator.hpp>
 #include <boost/range/any_range.hpp>
 #include "nmos/paging_utils.h"
 #include "nmos/resources.h"
+#include "rql/rql.h"
 
 namespace nmos
 {
@@ -21,11 +23,22 @@ namespace nmos
 
         resource_query(const nmos::api_version& version, const utility::string_t& resource_path, const web::json::value& flat_query_params);
 
+        // construct a query which is to be evaluated repeatedly in the context of the specified resources, e.g. for a Query API subscription,
+        // so that the RQL call-operators are made once rather than for every evaluation
+        resource_query(const nmos::api_version& version, const utility::string_t& resource_path, const web::json::value& flat_query_params, const nmos::resources& resources);
+
         // evaluate the query against the specified resource in the context of the specified resources
         result_type operator()(const nmos::resource& resource, const nmos::resources& resources) const { return (*this)(resource.version, resource.downgrade_version, resource.type, resource.data, resources); }
 
         web::json::value downgrade(const nmos::resource& resource) const { return downgrade(resource.version, resource.downgrade_version, resource.type, resource.data); }
 
+        // determine whether downgrade would return the resource data unchanged, so that it can be used without a copy
+        bool is_unchanged_by_downgrade(const nmos::resource& resource) const;
+
+        // serialize the downgraded resource data, reusing the serialized data cached on the resource when possible
+        // the result is valid until the resource data is next modified
+        const utility::string_t& serialize(const nmos::resource& resource) const;
+
         result_type operator()(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data, const nmos::resources& resources) const;
 
         web::json::value downgrade(const nmos::api_version& resource_version, const nmos::api_version& resource_downgrade_version, const nmos::type& resource_type, const web::json::value& resource_data) const;
@@ -36,6 +49,9 @@ namespace nmos
         // resource_path may be empty (matching all resource types) or e.g. "/nodes"
         utility::string_t resource_path;
 
+        // the resource type corresponding to resource_path, empty if resource_path is empty
+        nmos::type type;
+
         // the query/exemplar object for a Basic Query
         web::json::value basic_query;
 
@@ -50,6 +66,66 @@ namespace nmos
 
         // flags that affect the Basic Query (experimental)
         web::json::match_flag_type match_flags;
+
+        // a property which is required by the Basic Query to have a specific (string) value, and that value, or both empty
+        // this allows resources to be matched against many queries efficiently, see nmos::insert_resource_events
+        utility::string_t key_property;
+        utility::string_t key_value;
+
+        // an indexed property which is required by the Basic Query to have a specific (string) value, and that value, or both empty
+        // this allows the resources which could match the query to be found without a full scan, see nmos::find_property_resources
+        utility::string_t index_property;
+        utility::string_t index_value;
+
+        // the RQL call-operators, if the query was constructed in the context of specific resources
+        std::shared_ptr<const rql::operators> rql_operators;
+        const nmos::resources* rql_resources;
+
+        // the RQL query compiled with those call-operators, which is evaluated instead of interpreting rql_query, if not null
+        std::shared_ptr<const rql::plan> rql_plan;
+    };
+
+    // The extant resources of one type, from one of the composite indices ordered by type and then created or updated timestamp
+    template <typename Tag>
+    struct type_index_range : boost::iterator_range<typename nmos::resources::index<Tag>::type::const_iterator>
+    {
+        typedef typename nmos::resources::index<Tag>::type index_type;
+
+        type_index_range(const index_type& index, const nmos::type& type)
+            : type_index_range(index, type, index.equal_range(details::has_data(type)))
+        {}
+
+        const index_type& index;
+        nmos::type type;
+
+    private:
+        type_index_range(const index_type& index, const nmos::type& type, const std::pair<typename index_type::const_iterator, typename index_type::const_iterator>& range)
+            : boost::iterator_range<typename index_type::const_iterator>(range.first, range.second)
+            , index(index)
+            , type(type)
+        {}
+    };
+
+    // find the extant resources of the query's resource type which could match the query, using the index of the property which
+    // the query requires to have a specific value, or return false if the query doesn't identify such a property
+    bool find_property_resources(std::vector<const nmos::resource*>& results, const nmos::resources& resources, const nmos::resource_query& query);
+
+    // The extant resources which could match a query which requires a specific value of an indexed property,
+    // ordered by created or updated timestamp in the same way as the composite indices, for cursor-based paging
+    struct property_index_range
+    {
+        typedef boost::indirect_iterator<std::vector<const nmos::resource*>::const_iterator> iterator;
+        typedef iterator const_iterator;
+        typedef std::size_t size_type;
+
+        // the range is empty if the query doesn't identify an indexed property
+        property_index_range(const nmos::resources& resources, const nmos::resource_query& query, bool order_by_created);
+
+        iterator begin() const { return iterator(candidates.begin()); }
+        iterator end() const { return iterator(candidates.end()); }
+
+        std::vector<const nmos::resource*> candidates;
+        bool order_by_created;
     };
 
     // Cursor-based paging parameters
@@ -88,6 +164,30 @@ namespace nmos
                 return paging::cursor_based_page(resources.get<tags::updated>(), match, until, since, limit, !since_specified);
             }
         }
+
+        // page through only the resources of the specified type, which costs O(log N + limit) rather than O(N)
+        template <typename Predicate>
+        boost::any_range<const nmos::resource, boost::bidirectional_traversal_tag, const nmos::resource&, std::ptrdiff_t> page(const nmos::resources& resources, const nmos::type& type, Predicate match)
+        {
+            if (order_by_created)
+            {
+                const type_index_range<tags::type_created> range(resources.get<tags::type_created>(), type);
+                return paging::cursor_based_page(range, match, until, since, limit, !since_specified);
+            }
+            else
+            {
+                const type_index_range<tags::type_updated> range(resources.get<tags::type_updated>(), type);
+                return paging::cursor_based_page(range, match, until, since, limit, !since_specified);
+            }
+        }
+
+        // page through only the resources found using a property index, which costs O(M log M) in the number of those resources rather than O(N)
+        // the range must be ordered by the same timestamp as the paging parameters
+        template <typename Predicate>
+        boost::any_range<const nmos::resource, boost::bidirectional_traversal_tag, const nmos::resource&, std::ptrdiff_t> page(const property_index_range& range, Predicate match)
+        {
+            return paging::cursor_based_page(range, match, until, since, limit, !since_specified);
+        }
     };
 
     namespace details
@@ -104,6 +204,16 @@ namespace nmos
     inline nmos::resources::index<tags::created>::type::const_iterator lower_bound(const nmos::resources::index<tags::created>::type& index, const nmos::tai& timestamp) { return index.lower_bound(timestamp); }
     inline nmos::resources::index<tags::updated>::type::const_iterator lower_bound(const nmos::resources::index<tags::updated>::type& index, const nmos::tai& timestamp) { return index.lower_bound(timestamp); }
 
+    inline nmos::tai extract_cursor(const type_index_range<tags::type_created>&, nmos::resources::index<tags::type_created>::type::const_iterator it) { return it->created; }
+    inline nmos::tai extract_cursor(const type_index_range<tags::type_updated>&, nmos::resources::index<tags::type_updated>::type::const_iterator it) { return it->updated; }
+
+    inline nmos::resources::index<tags::type_created>::type::const_iterator lower_bound(const type_index_range<tags::type_created>& range, const nmos::tai& timestamp) { return range.index.lower_bound(boost::make_tuple(true, range.type, timestamp)); }
+    inline nmos::resources::index<tags::type_updated>::type::const_iterator lower_bound(const type_index_range<tags::type_updated>& range, const nmos::tai& timestamp) { return range.index.lower_bound(boost::make_tuple(true, range.type, timestamp)); }
+
+    inline nmos::tai extract_cursor(const property_index_range& range, property_index_range::const_iterator it) { return range.order_by_created ? it->created : it->updated; }
+
+    property_index_range::const_iterator lower_bound(const property_index_range& range, const nmos::tai& timestamp);
+
     // Helpers for constructing /subscriptions websocket grains
     // See https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.2._Behaviour_-_Querying.html
 
@@ -150,11 +260,22 @@ namespace nmos
         // determine the type of the resource event from "pre" and "post"
         resource_event_type get_resource_event_type(const web::json::value& event);
 
+        // coalesce the resource events in a grain, so that only one event remains for each resource, representing the change from
+        // its earliest to its latest state, unless it was removed and added again, while an 'added' event followed by a 'removed'
+        // event is discarded entirely; super-resources are still added before their sub-resources, and removed after them
+        void coalesce_resource_events(const utility::string_t& topic, web::json::value& events);
+
         // resource_path may be empty (matching all resource types) or e.g. "/nodes"
         web::json::value make_resource_event(const utility::string_t& resource_path, const nmos::type& type, const web::json::value& pre, const web::json::value& post);
 
         // make an empty grain
         web::json::value make_grain(const nmos::id& source_id, const nmos::id& flow_id, const utility::string_t& topic);
+
+        // make the query for a subscription from its resource_path and params
+        std::shared_ptr<const resource_query> make_subscription_query(const nmos::resources& resources, const nmos::resource& subscription);
+
+        // find the subscriptions which could match a resource event of the specified type and "pre" or "post" values, using the subscription index
+        std::vector<const nmos::resource*> find_subscriptions(const nmos::resources& resources, const nmos::type& type, const web::json::value& pre, const web::json::value& post);
     }
 }
 
@@ -172,7 +172,27 @@ namespace nmos
 
             earliest_necessary_update = (tai_clock::time_point::max)();
 
-            std::vector<std::pair<web::websockets::experimental::listener::connection_id, web::websockets::websocket_outgoing_message>> outgoing_messages;
+            // identical messages, e.g. for multiple websocket connections to the same subscription, are only serialized once
+            // and are sent to all those connections together
+            struct outgoing_message
+            {
+                std::vector<web::websockets::experimental::listener::connection_id> connections;
+                value message;
+            };
+            std::vector<outgoing_message> outgoing_messages;
+
+            // the messages prepared for each subscription, and the index of the corresponding outgoing message
+            std::map<nmos::id, std::vector<std::pair<const value*, size_t>>> subscription_messages;
+
+            // each grain is only reset once all the messages have been prepared, so that they can be compared
+            struct prepared_grain
+            {
+                nmos::resources::iterator grain;
+                value next_events;
+                size_t outgoing_message;
+                bool first;
+            };
+            std::vector<prepared_grain> prepared_grains;
 
             for (auto wit = websockets.left.begin(); websockets.left.end() != wit;)
             {
@@ -293,11 +313,20 @@ namespace nmos
                 }
                 //- additional logging, cf. nmos::details::request_registration
 
-                auto serialized = utility::us2s(nmos::fields::message(grain->data).serialize());
-                web::websockets::websocket_outgoing_message message;
-                message.set_utf8_message(serialized);
-
-                outgoing_messages.push_back({ websocket.second, message });
+                // find an identical message already prepared for another connection to the same subscription
+                const auto& message = nmos::fields::message(grain->data);
+                auto& prepared_messages = subscription_messages[subscription->id];
+                auto prepared_message = std::find_if(prepared_messages.begin(), prepared_messages.end(), [&message](const std::pair<const value*, size_t>& prepared_message)
+                {
+                    return *prepared_message.first == message;
+                });
+                const bool first = prepared_messages.end() == prepared_message;
+                if (first)
+                {
+                    prepared_message = prepared_messages.emplace(prepared_messages.end(), &message, outgoing_messages.size());
+                    outgoing_messages.push_back({ {}, value::null() });
+                }
+                outgoing_messages[prepared_message->second].connections.push_back(websocket.second);
 
                 if (0 != next_events.size())
                 {
@@ -308,27 +337,43 @@ namespace nmos
                     }
                 }
 
-                // reset the grain for next time
-                resources.modify(grain, [&next_events, &resources](nmos::resource& grain)
+                prepared_grains.push_back({ grain, std::move(next_events), prepared_message->second, first });
+
+                ++wit;
+            }
+
+            // reset the grains for next time
+            // moving the events out of the grain for each distinct message, so it can be serialized without the lock on resources
+            for (auto& prepared : prepared_grains)
+            {
+                resources.modify(prepared.grain, [&prepared, &outgoing_messages, &resources](nmos::resource& grain)
                 {
+                    auto events = value::array();
                     using std::swap;
-                    swap(nmos::fields::message_grain_data(grain.data), next_events);
-                    next_events = value::array(); // unnecessary
+                    swap(nmos::fields::message_grain_data(grain.data), events);
+                    if (prepared.first)
+                    {
+                        auto& message = outgoing_messages[prepared.outgoing_message].message;
+                        message = nmos::fields::message(grain.data);
+                        nmos::fields::grain_data(message) = std::move(events);
+                    }
+                    swap(nmos::fields::message_grain_data(grain.data), prepared.next_events);
                     grain.updated = strictly_increasing_update(resources);
                 });
-
-                ++wit;
             }
 
-            // send the messages without the lock on resources
+            // serialize and send the messages without the lock on resources
             details::reverse_lock_guard<nmos::write_lock> unlock{ lock };
 
-            if (!outgoing_messages.empty()) slog::log<slog::severities::info>(gate, SLOG_FLF) << "Sending " << outgoing_messages.size() << " websocket messages";
+            if (!outgoing_messages.empty()) slog::log<slog::severities::info>(gate, SLOG_FLF) << "Sending " << outgoing_messages.size() << " websocket messages to " << prepared_grains.size() << " connections";
 
             for (auto& outgoing_message : outgoing_messages)
             {
+                web::websockets::websocket_outgoing_message message;
+                message.set_utf8_message(utility::us2s(outgoing_message.message.serialize()));
+
                 // hmmm, no way to cancel this currently...
-                auto send = listener.send(outgoing_message.first, outgoing_message.second).then([&](pplx::task<void> finally)
+                auto send = listener.send(outgoing_message.connections, message).then([&](pplx::task<void> finally)
                 {
                     try
                     {
@@ -339,8 +384,8 @@ namespace nmos
                         slog::log<slog::severities::error>(gate, SLOG_FLF) << "WebSocket error: " << e.what() << " [" << e.error_code() << "]";
                     }
                 });
-                // current websocket_listener implementation is synchronous in any case, but just to make clear...
-                // for now, wait for the message to be sent
+                // current websocket_listener implementation only queues the message for each connection in any case, but just to make clear...
+                // for now, wait for the message to be queued
                 send.wait();
             }
         }
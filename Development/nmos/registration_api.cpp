@@ -19,6 +19,10 @@ namespace nmos
 
         // start out as a shared/read lock, only upgraded to an exclusive/write lock when an expired resource actually needs to be deleted from the resources
         auto lock = model.read_lock();
+
+        // make sure the typed snapshot reflects the settings, since this thread may be started without nmos::make_registry_server
+        model.update_settings_snapshot();
+
         auto& shutdown_condition = model.shutdown_condition;
         auto& shutdown = model.shutdown;
         auto& resources = model.registry_resources;
@@ -27,15 +31,16 @@ namespace nmos
 
         // wait until the next node could potentially expire, or the server is being shut down
         // (since health is truncated to seconds, and we want to be certain the expiry interval has passed, there's an extra second to wait here)
-        while (!shutdown_condition.wait_until(lock, time_point_from_health(least_health.first + nmos::fields::registration_expiry_interval(model.settings) + 1), [&]{ return shutdown; }))
+        while (!shutdown_condition.wait_until(lock, time_point_from_health(least_health.first + model.settings_snapshot()->registration_expiry_interval + 1), [&]{ return shutdown; }))
         {
             // hmmm, it needs to be possible to enable/disable periodic logging like this independently of the severity...
             slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "At " << nmos::make_version(nmos::tai_now()) << ", the registry contains " << nmos::put_resources_statistics(resources);
 
             // most nodes will have had a heartbeat during the wait, so the least health will have been increased
             // so this thread will be able to go straight back to waiting
-            auto expire_health = health_now() - nmos::fields::registration_expiry_interval(model.settings);
-            auto forget_health = expire_health - nmos::fields::registration_expiry_interval(model.settings);
+            const auto expiry_interval = model.settings_snapshot()->registration_expiry_interval;
+            auto expire_health = health_now() - expiry_interval;
+            auto forget_health = expire_health - expiry_interval;
             least_health = nmos::least_health(resources);
             if (least_health.first >= expire_health && least_health.second >= forget_health) continue;
 
@@ -45,8 +50,8 @@ namespace nmos
             // note, without atomic upgrade, another thread may preempt hence the need to recalculate expire_health/forget_health and least_health
             auto upgrade = model.write_lock();
 
-            expire_health = health_now() - nmos::fields::registration_expiry_interval(model.settings);
-            forget_health = expire_health - nmos::fields::registration_expiry_interval(model.settings);
+            expire_health = health_now() - expiry_interval;
+            forget_health = expire_health - expiry_interval;
 
             // forget all resources expired in the previous interval
             forget_erased_resources(resources, forget_health);
@@ -168,6 +173,272 @@ namespace nmos
         {
             return value.is_null() ? value.serialize() : value.as_string();
         }
+
+        // the checks of a registration request against the existing registrations, which determine whether the request is accepted
+        struct registration_checks
+        {
+            registration_checks(const nmos::resources& resources, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const std::pair<nmos::id, nmos::type>& super_id_type, const web::json::value& data)
+            {
+                // a modification request must not change the existing type
+                resource = nmos::find_resource(resources, id_type.first);
+                creating = resources.end() == resource;
+                valid_type = creating || resource->type == id_type.second;
+
+                // a modification request must not change the API version
+                valid_api_version = creating || resource->version == version;
+
+                // it must not change the super-resource either
+                valid_super_id_type = creating || nmos::get_super_resource(*resource) == super_id_type;
+
+                // the super-resource should exist in this registry (and must be of the right type)
+                super_resource = nmos::find_resource(resources, super_id_type.first);
+                no_super_resource = resources.end() == super_resource;
+                valid_super_resource = no_resource == super_id_type || !no_super_resource;
+
+                valid_super_type = no_resource == super_id_type || no_super_resource || super_resource->type == super_id_type.second;
+
+                // all the sub-resources of each node must have the same version
+                valid_super_api_version = no_resource == super_id_type || no_super_resource || super_resource->version == version;
+
+                // registration of an unchanged resource is considered as an acceptable "update" even though it's a no-op, but seems worth logging?
+                unchanged = !creating && data == resource->data;
+
+                // each modification of a resource should update the version timestamp
+                valid_version = creating || unchanged || nmos::fields::version(data) > nmos::fields::version(resource->data);
+            }
+
+            bool valid() const
+            {
+                return valid_type && valid_api_version && valid_super_id_type && valid_super_resource && valid_super_type && valid_super_api_version && valid_version;
+            }
+
+            // always reject updates that would modify resource type or super-resource
+            bool accepted(bool valid_references, bool allow_invalid_resources) const
+            {
+                return valid_type && valid_super_id_type && ((valid() && valid_references) || allow_invalid_resources);
+            }
+
+            const std::pair<nmos::id, nmos::type> no_resource{};
+
+            nmos::resources::const_iterator resource;
+            bool creating;
+            bool valid_type;
+            bool valid_api_version;
+            bool valid_super_id_type;
+
+            nmos::resources::const_iterator super_resource;
+            bool no_super_resource;
+            bool valid_super_resource;
+            bool valid_super_type;
+            bool valid_super_api_version;
+
+            bool unchanged;
+            bool valid_version;
+        };
+
+        void log_registration_checks(slog::base_gate& gate, const registration_checks& checks, const std::pair<nmos::id, nmos::type>& id_type, const std::pair<nmos::id, nmos::type>& super_id_type)
+        {
+            if (!checks.valid_type)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " would modify type from " << checks.resource->type.name;
+            else if (!checks.valid_api_version)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " would modify API version from " << nmos::make_api_version(checks.resource->version);
+            else if (!checks.valid_super_id_type)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on " << super_id_type << " would modify super-resource from " << nmos::get_super_resource(*checks.resource);
+            else if (!checks.valid_super_resource)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on unknown " << super_id_type;
+            else if (!checks.valid_super_type)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on " << super_id_type << " with inconsistent type of " << checks.super_resource->type.name;
+            else if (!checks.valid_super_api_version)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with API version inconsistent with super-resource " << nmos::make_api_version(checks.super_resource->version);
+            else if (!checks.valid_version)
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with invalid version";
+            else if (checks.no_resource == super_id_type) // i.e. just nodes, basically
+                slog::log<slog::severities::info>(gate, SLOG_FLF) << "Registration requested for " << (checks.unchanged ? "unchanged " : "") << id_type;
+            else
+                slog::log<slog::severities::info>(gate, SLOG_FLF) << "Registration requested for " << (checks.unchanged ? "unchanged " : "") << id_type << " on " << super_id_type;
+        }
+
+        // check the references from a registration request to other resources, which are logged as warnings but don't make the request invalid
+        // (unless the resource type itself is unrecognised)
+        bool check_registration_references(slog::base_gate& gate, const nmos::resources& resources, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const web::json::value& data)
+        {
+            using web::json::value;
+
+            const auto& type = id_type.second;
+
+            if (nmos::types::node == type)
+            {
+                // no extra validation yet
+            }
+            else if (nmos::types::device == type)
+            {
+                // "The 'senders' and 'receivers' arrays in a Device have been deprecated, but will continue to be present until v2.0."
+                // Therefore, issue warnings rather than errors here
+                // See https://specs.amwa.tv/is-04/releases/v1.2.1/docs/4.2._Behaviour_-_Querying.html#referential-integrity
+
+                for (auto& element : nmos::fields::senders(data))
+                {
+                    const auto& sender_id = element.as_string();
+                    const bool valid_sender = nmos::has_resource(resources, { sender_id, nmos::types::sender });
+                    if (!valid_sender) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown sender: " << sender_id;
+                }
+
+                for (auto& element : nmos::fields::receivers(data))
+                {
+                    const auto& receiver_id = element.as_string();
+                    const bool valid_receiver = nmos::has_resource(resources, { receiver_id, nmos::types::receiver });
+                    if (!valid_receiver) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown receiver: " << receiver_id;
+                }
+            }
+            else if (nmos::types::source == type)
+            {
+                // the parent sources might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
+                for (auto& element : nmos::fields::parents(data))
+                {
+                    const auto& source_id = element.as_string();
+                    const bool valid_parent = nmos::has_resource(resources, { source_id, nmos::types::source });
+                    if (!valid_parent) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown parent source: " << source_id;
+                }
+            }
+            else if (nmos::types::flow == type)
+            {
+                // v1.1 introduced device_id for flow, and uses it for referential integrity rather than source_id
+                // so if the source is not (yet) registered, issue a warning not an error, and don't treat this as invalid?
+                // see https://specs.amwa.tv/is-04/releases/v1.2.1/docs/4.1._Behaviour_-_Registration.html#referential-integrity
+                if (nmos::is04_versions::v1_1 <= version)
+                {
+                    const auto& source_id = nmos::fields::source_id(data);
+                    const bool valid_source = nmos::has_resource(resources, { source_id, nmos::types::source });
+                    if (!valid_source) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " from unknown source: " << source_id;
+                }
+
+                // the parent flows might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
+                for (auto& element : nmos::fields::parents(data))
+                {
+                    const auto& flow_id = element.as_string();
+                    const bool valid_parent = nmos::has_resource(resources, { flow_id, nmos::types::flow });
+                    if (!valid_parent) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown parent flow: " << flow_id;
+                }
+            }
+            else if (nmos::types::sender == type)
+            {
+                // v1.1 introduced null for flow_id to "permit Senders without attached Flows to model a Device before internal routing has been performed"
+                const auto& flow_id = nmos::fields::flow_id(data);
+                const bool valid_flow = flow_id.is_null() || nmos::has_resource(resources, { flow_id.as_string(), nmos::types::flow });
+                if (!valid_flow)
+                    slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " of unknown flow: " << flow_id.as_string();
+                else
+                    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " of flow: " << details::as_string_or_null(flow_id);
+
+                // v1.2 introduced subscription for sender
+                if (nmos::is04_versions::v1_2 <= version)
+                {
+                    // the receiver might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
+                    const value& receiver_id = nmos::fields::receiver_id(nmos::fields::subscription(data));
+                    const bool valid_receiver = receiver_id.is_null() || nmos::has_resource(resources, { receiver_id.as_string(), nmos::types::receiver });
+                    if (!valid_receiver)
+                        slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to unknown receiver: " << receiver_id.as_string();
+                    else
+                        slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to receiver: " << details::as_string_or_null(receiver_id);
+                }
+            }
+            else if (nmos::types::receiver == type)
+            {
+                // the sender might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
+                const value& sender_id = nmos::fields::sender_id(nmos::fields::subscription(data));
+                const bool valid_sender = sender_id.is_null() || nmos::has_resource(resources, { sender_id.as_string(), nmos::types::sender });
+                if (!valid_sender)
+                    slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to unknown sender: " << sender_id.as_string();
+                else
+                    slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to sender: " << details::as_string_or_null(sender_id);
+            }
+            else // bad type
+            {
+                slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for unrecognised resource type: " << type.name;
+                return false;
+            }
+
+            return true;
+        }
+
+        void set_registration_error_reply(web::http::http_response& res, const registration_checks& checks, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type, const std::pair<nmos::id, nmos::type>& super_id_type, const web::json::value& data)
+        {
+            using namespace web::http::experimental::listener::api_router_using_declarations;
+
+            if (!checks.valid_api_version)
+            {
+                // experimental extension, proposed for v1.3, using a more specific status code to distinguish conflicts from validation errors
+                // when that conflict may be resolvable automatically by the Node
+                // see https://github.com/AMWA-TV/is-04/pull/85
+                set_error_reply(res, status_codes::Conflict, U("Conflict; ") + make_valid_api_version_error(version, checks.resource->version));
+
+                // the Location header would enable an HTTP DELETE to be performed to explicitly clear the registry of the conflicting registration
+                // (assert !creating, i.e. resources.end() != resource in all these cases)
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.resource));
+            }
+            else if (!checks.valid_type)
+            {
+                // the following errors are more likely to require a human to investigate so result in a simple 400 response
+                // but provide additional information in the error body, and as an experimental extension, via the Location header
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_type_error(id_type, checks.resource->type));
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.resource));
+            }
+            else if (!checks.valid_super_id_type)
+            {
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_super_id_type_error(super_id_type, nmos::get_super_resource(*checks.resource)));
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.resource));
+            }
+            else if (!checks.valid_version)
+            {
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_version_error(nmos::fields::version(data), nmos::fields::version(checks.resource->data)));
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.resource));
+            }
+            else if (!checks.valid_super_type)
+            {
+                // the difference here is that it's the super-resource that conflicts
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_super_type_error(super_id_type, checks.super_resource->type));
+
+                // since the conflict is with the super-resource, a single HTTP DELETE cannot be enough to resolve the issue in this case...
+                // (assert !no_super_resource, i.e. resources.end() != super_resource in all these cases)
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.super_resource));
+            }
+            else if (!checks.valid_super_api_version)
+            {
+                // another super-resource conflict
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_super_api_version_error(version, checks.super_resource->version));
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*checks.super_resource));
+            }
+            else if (!checks.valid_super_resource)
+            {
+                set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + make_valid_super_resource_error(super_id_type));
+            }
+            else
+            {
+                set_reply(res, status_codes::BadRequest);
+            }
+        }
+
+        // determine the response to a request to delete a resource which either isn't found or is registered with another API version
+        void set_deletion_error_reply(web::http::http_response& res, const nmos::resources& resources, const nmos::api_version& version, const std::pair<nmos::id, nmos::type>& id_type)
+        {
+            using namespace web::http::experimental::listener::api_router_using_declarations;
+
+            auto resource = find_resource(resources, id_type);
+            if (resources.end() != resource)
+            {
+                // experimental extension, proposed for v1.3, to distinguish from Not Found
+                set_error_reply(res, status_codes::Conflict, U("Conflict; ") + make_valid_api_version_error(version, resource->version));
+                res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
+            }
+            else if (is_erased_resource(resources, id_type))
+            {
+                set_error_reply(res, status_codes::NotFound, U("Not Found; ") + make_erased_resource_error());
+            }
+            else
+            {
+                set_reply(res, status_codes::NotFound);
+            }
+        }
     }
 
     inline web::http::experimental::listener::api_router make_unmounted_registration_api(nmos::registry_model& model, slog::base_gate& gate_)
@@ -211,15 +482,13 @@ namespace nmos
             // note that, as elsewhere, http_exception and json_exception are handled by the exception handler added by add_api_finally_handler
             return details::extract_json(req, gate).then([&model, &validator, req, res, parameters, gate](value body) mutable
             {
-                // could start out as a shared/read lock, only upgraded to an exclusive/write lock when the resource is actually modified or inserted into resources
-                auto lock = model.write_lock();
-                auto& resources = model.registry_resources;
-
                 const nmos::api_version version = nmos::parse_api_version(parameters.at(nmos::patterns::version.name));
 
+                const bool allow_invalid_resources = with_read_lock(model.mutex, [&model] { return nmos::experimental::fields::allow_invalid_resources(model.settings); });
+
                 // Validate JSON syntax according to the schema
+                // this is by far the most expensive part of handling a registration, so is done before any lock is taken
 
-                const bool allow_invalid_resources = nmos::experimental::fields::allow_invalid_resources(model.settings);
                 if (!allow_invalid_resources)
                 {
                     validator.validate(body, experimental::make_registrationapi_resource_post_request_schema_uri(version));
@@ -239,166 +508,44 @@ namespace nmos
                 const value data = nmos::fields::data(body);
                 const std::pair<nmos::id, nmos::type> id_type{ nmos::fields::id(data), nmos::type{ nmos::fields::type(body) } };
                 const auto& id = id_type.first;
-                const auto& type = id_type.second;
+                const auto super_id_type = nmos::get_super_resource(version, id_type.second, data);
 
                 // Validate request semantics, including referential integrity
                 // such as the requested super-resource
+                // this only requires a shared/read lock, so doesn't block the Query API, or other registrations being validated
 
-                bool valid = true;
-
-                // a modification request must not change the existing type
-                auto resource = nmos::find_resource(resources, id);
-                const bool creating = resources.end() == resource;
-                const bool valid_type = creating || resource->type == type;
-                valid = valid && valid_type;
-
-                // a modification request must not change the API version
-                const bool valid_api_version = creating || resource->version == version;
-                valid = valid && valid_api_version;
-
-                // it must not change the super-resource either
-                const std::pair<nmos::id, nmos::type> no_resource{};
-                const auto super_id_type = nmos::get_super_resource(version, type, data);
-                const bool valid_super_id_type = creating || nmos::get_super_resource(*resource) == super_id_type;
-                valid = valid && valid_super_id_type;
-
-                // the super-resource should exist in this registry (and must be of the right type)
-                const auto super_resource = nmos::find_resource(resources, super_id_type.first);
-                const bool no_super_resource = resources.end() == super_resource;
-                const bool valid_super_resource = no_resource == super_id_type || !no_super_resource;
-                valid = valid && valid_super_resource;
-
-                const bool valid_super_type = no_resource == super_id_type || no_super_resource || super_resource->type == super_id_type.second;
-                valid = valid && valid_super_type;
-
-                // all the sub-resources of each node must have the same version
-                const bool valid_super_api_version = no_resource == super_id_type || no_super_resource || super_resource->version == version;
-                valid = valid && valid_super_api_version;
-
-                // registration of an unchanged resource is considered as an acceptable "update" even though it's a no-op, but seems worth logging?
-                const bool unchanged = !creating && data == resource->data;
-
-                // each modification of a resource should update the version timestamp
-                const bool valid_version = creating || unchanged || nmos::fields::version(data) > nmos::fields::version(resource->data);
-                valid = valid && valid_version;
-
-                if (!valid_type)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " would modify type from " << resource->type.name;
-                else if (!valid_api_version)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " would modify API version from " << nmos::make_api_version(resource->version);
-                else if (!valid_super_id_type)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on " << super_id_type << " would modify super-resource from " << nmos::get_super_resource(*resource);
-                else if (!valid_super_resource)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on unknown " << super_id_type;
-                else if (!valid_super_type)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " on " << super_id_type << " with inconsistent type of " << super_resource->type.name;
-                else if (!valid_super_api_version)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with API version inconsistent with super-resource " << nmos::make_api_version(super_resource->version);
-                else if (!valid_version)
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with invalid version";
-                else if (no_resource == super_id_type) // i.e. just nodes, basically
-                    slog::log<slog::severities::info>(gate, SLOG_FLF) << "Registration requested for " << (unchanged ? "unchanged " : "") << id_type;
-                else
-                    slog::log<slog::severities::info>(gate, SLOG_FLF) << "Registration requested for " << (unchanged ? "unchanged " : "") << id_type << " on " << super_id_type;
-
-                if (nmos::types::node == type)
-                {
-                    // no extra validation yet
-                }
-                else if (nmos::types::device == type)
+                bool valid_references = true;
                 {
-                    // "The 'senders' and 'receivers' arrays in a Device have been deprecated, but will continue to be present until v2.0."
-                    // Therefore, issue warnings rather than errors here
-                    // See https://specs.amwa.tv/is-04/releases/v1.2.1/docs/4.2._Behaviour_-_Querying.html#referential-integrity
+                    auto lock = model.read_lock();
+                    const auto& resources = model.registry_resources;
 
-                    for (auto& element : nmos::fields::senders(data))
-                    {
-                        const auto& sender_id = element.as_string();
-                        const bool valid_sender = nmos::has_resource(resources, { sender_id, nmos::types::sender });
-                        if (!valid_sender) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown sender: " << sender_id;
-                    }
+                    const details::registration_checks checks(resources, version, id_type, super_id_type, data);
+                    details::log_registration_checks(gate, checks, id_type, super_id_type);
 
-                    for (auto& element : nmos::fields::receivers(data))
-                    {
-                        const auto& receiver_id = element.as_string();
-                        const bool valid_receiver = nmos::has_resource(resources, { receiver_id, nmos::types::receiver });
-                        if (!valid_receiver) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown receiver: " << receiver_id;
-                    }
-                }
-                else if (nmos::types::source == type)
-                {
-                    // the parent sources might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
-                    for (auto& element : nmos::fields::parents(data))
-                    {
-                        const auto& source_id = element.as_string();
-                        const bool valid_parent = nmos::has_resource(resources, { source_id, nmos::types::source });
-                        if (!valid_parent) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown parent source: " << source_id;
-                    }
-                }
-                else if (nmos::types::flow == type)
-                {
-                    // v1.1 introduced device_id for flow, and uses it for referential integrity rather than source_id
-                    // so if the source is not (yet) registered, issue a warning not an error, and don't treat this as invalid?
-                    // see https://specs.amwa.tv/is-04/releases/v1.2.1/docs/4.1._Behaviour_-_Registration.html#referential-integrity
-                    if (nmos::is04_versions::v1_1 <= version)
-                    {
-                        const auto& source_id = nmos::fields::source_id(data);
-                        const bool valid_source = nmos::has_resource(resources, { source_id, nmos::types::source });
-                        if (!valid_source) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " from unknown source: " << source_id;
-                    }
+                    valid_references = details::check_registration_references(gate, resources, version, id_type, data);
 
-                    // the parent flows might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
-                    for (auto& element : nmos::fields::parents(data))
+                    if (!checks.accepted(valid_references, allow_invalid_resources))
                     {
-                        const auto& flow_id = element.as_string();
-                        const bool valid_parent = nmos::has_resource(resources, { flow_id, nmos::types::flow });
-                        if (!valid_parent) slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " with unknown parent flow: " << flow_id;
+                        details::set_registration_error_reply(res, checks, version, id_type, super_id_type, data);
+                        return true;
                     }
                 }
-                else if (nmos::types::sender == type)
-                {
-                    // v1.1 introduced null for flow_id to "permit Senders without attached Flows to model a Device before internal routing has been performed"
-                    const auto& flow_id = nmos::fields::flow_id(data);
-                    const bool valid_flow = flow_id.is_null() || nmos::has_resource(resources, { flow_id.as_string(), nmos::types::flow });
-                    if (!valid_flow)
-                        slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " of unknown flow: " << flow_id.as_string();
-                    else
-                        slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " of flow: " << details::as_string_or_null(flow_id);
 
-                    // v1.2 introduced subscription for sender
-                    if (nmos::is04_versions::v1_2 <= version)
-                    {
-                        // the receiver might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
-                        const value& receiver_id = nmos::fields::receiver_id(nmos::fields::subscription(data));
-                        const bool valid_receiver = receiver_id.is_null() || nmos::has_resource(resources, { receiver_id.as_string(), nmos::types::receiver });
-                        if (!valid_receiver)
-                            slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to unknown receiver: " << receiver_id.as_string();
-                        else
-                            slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to receiver: " << details::as_string_or_null(receiver_id);
-                    }
-                }
-                else if (nmos::types::receiver == type)
-                {
-                    // the sender might not be registered in this registry, so issue a warning not an error, and don't treat this as invalid?
-                    const value& sender_id = nmos::fields::sender_id(nmos::fields::subscription(data));
-                    const bool valid_sender = sender_id.is_null() || nmos::has_resource(resources, { sender_id.as_string(), nmos::types::sender });
-                    if (!valid_sender)
-                        slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to unknown sender: " << sender_id.as_string();
-                    else
-                        slog::log<slog::severities::more_info>(gate, SLOG_FLF) << "Registration requested for " << id_type << " subscribed to sender: " << details::as_string_or_null(sender_id);
-                }
-                else // bad type
-                {
-                    slog::log<slog::severities::error>(gate, SLOG_FLF) << "Registration requested for unrecognised resource type: " << type.name;
-                    valid = false;
-                }
+                // an exclusive/write lock is only taken when the resource is actually modified or inserted into resources
+                // but since the registry may have been modified in the meantime, the checks which determine whether the request
+                // is accepted must be repeated, which is cheap (the referential integrity warnings are not repeated)
+                auto lock = model.write_lock();
+                auto& resources = model.registry_resources;
 
-                // always reject updates that would modify resource type or super-resource
-                if (valid_type && valid_super_id_type && (valid || allow_invalid_resources))
+                const details::registration_checks checks(resources, version, id_type, super_id_type, data);
+
+                if (checks.accepted(valid_references, allow_invalid_resources))
                 {
-                    if (creating)
+                    auto resource = checks.resource;
+
+                    if (checks.creating)
                     {
-                        nmos::resource created_resource{ version, type, data, false };
+                        nmos::resource created_resource{ version, id_type.second, data, false };
 
                         set_reply(res, status_codes::Created, data);
                         res.headers().add(web::http::header_names::location, make_registration_api_resource_location(created_resource));
@@ -424,56 +571,12 @@ namespace nmos
                     slog::log<slog::severities::too_much_info>(gate, SLOG_FLF) << "Notifying query websockets thread"; // and anyone else who cares...
                     model.notify();
                 }
-                else if (!valid_api_version)
-                {
-                    // experimental extension, proposed for v1.3, using a more specific status code to distinguish conflicts from validation errors
-                    // when that conflict may be resolvable automatically by the Node
-                    // see https://github.com/AMWA-TV/is-04/pull/85
-                    set_error_reply(res, status_codes::Conflict, U("Conflict; ") + details::make_valid_api_version_error(version, resource->version));
-
-                    // the Location header would enable an HTTP DELETE to be performed to explicitly clear the registry of the conflicting registration
-                    // (assert !creating, i.e. resources.end() != resource in all these cases)
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
-                }
-                else if (!valid_type)
-                {
-                    // the following errors are more likely to require a human to investigate so result in a simple 400 response
-                    // but provide additional information in the error body, and as an experimental extension, via the Location header
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_type_error(id_type, resource->type));
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
-                }
-                else if (!valid_super_id_type)
-                {
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_super_id_type_error(super_id_type, nmos::get_super_resource(*resource)));
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
-                }
-                else if (!valid_version)
-                {
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_version_error(nmos::fields::version(data), nmos::fields::version(resource->data)));
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
-                }
-                else if (!valid_super_type)
-                {
-                    // the difference here is that it's the super-resource that conflicts
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_super_type_error(super_id_type, super_resource->type));
-
-                    // since the conflict is with the super-resource, a single HTTP DELETE cannot be enough to resolve the issue in this case...
-                    // (assert !no_super_resource, i.e. resources.end() != super_resource in all these cases)
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*super_resource));
-                }
-                else if (!valid_super_api_version)
-                {
-                    // another super-resource conflict
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_super_api_version_error(version, super_resource->version));
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*super_resource));
-                }
-                else if (!valid_super_resource)
-                {
-                    set_error_reply(res, status_codes::BadRequest, U("Bad Request; ") + details::make_valid_super_resource_error(super_id_type));
-                }
                 else
                 {
-                    set_reply(res, status_codes::BadRequest);
+                    slog::log<slog::severities::warning>(gate, SLOG_FLF) << "Registration requested for " << id_type << " conflicts with a concurrent registration";
+                    details::log_registration_checks(gate, checks, id_type, super_id_type);
+
+                    details::set_registration_error_reply(res, checks, version, id_type, super_id_type, data);
                 }
 
                 return true;
@@ -577,57 +680,59 @@ namespace nmos
         {
             nmos::api_gate gate(gate_, req, parameters);
 
-            // could start out as a shared/read lock, only upgraded to an exclusive/write lock when the resource is actually deleted from resources
-            auto lock = model.write_lock();
-            auto& resources = model.registry_resources;
-
             const nmos::api_version version = nmos::parse_api_version(parameters.at(nmos::patterns::version.name));
             const string_t resourceType = parameters.at(nmos::patterns::resourceType.name);
             const string_t resourceId = parameters.at(nmos::patterns::resourceId.name);
+            const std::pair<nmos::id, nmos::type> id_type{ resourceId, nmos::type_from_resourceType(resourceType) };
 
-            auto resource = find_resource(resources, { resourceId, nmos::type_from_resourceType(resourceType) });
-            if (resources.end() != resource)
+            // requests which cannot be satisfied only require a shared/read lock, so don't block the Query API, or other registrations
             {
-                if (resource->version == version)
-                {
-                    slog::log<slog::severities::info>(gate, SLOG_FLF) << "Deleting resource: " << resourceId;
+                auto lock = model.read_lock();
+                const auto& resources = model.registry_resources;
 
-                    // remove this resource from its super-resource's sub-resources
-                    auto super_resource = nmos::find_resource(resources, nmos::get_super_resource(*resource));
-                    if (super_resource != resources.end())
-                    {
-                        // this isn't modifying the visible data of the super_resouce though, so no resource events need to be generated
-                        // hence resources.modify(...) rather than modify_resource(resources, ...)
-                        resources.modify(super_resource, [&resource](nmos::resource& super_resource)
-                        {
-                            super_resource.sub_resources.erase(resource->id);
-                        });
-                    }
+                auto resource = find_resource(resources, id_type);
+                if (resources.end() == resource || resource->version != version)
+                {
+                    details::set_deletion_error_reply(res, resources, version, id_type);
+                    return pplx::task_from_result(true);
+                }
+            }
 
-                    // "If a Node unregisters a resource in the incorrect order, the Registration API MUST clean up related child resources
-                    // on the Node's behalf in order to prevent stale entries remaining in the registry."
-                    // See https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.1._Behaviour_-_Registration.html#controlled-unregistration
-                    erase_resource(resources, resource->id, false);
+            // an exclusive/write lock is only taken when the resource is actually deleted from resources
+            // but since the registry may have been modified in the meantime, the resource must be found again
+            auto lock = model.write_lock();
+            auto& resources = model.registry_resources;
 
-                    slog::log<slog::severities::too_much_info>(gate, SLOG_FLF) << "Notifying query websockets thread"; // and anyone else who cares...
-                    model.notify();
+            auto resource = find_resource(resources, id_type);
+            if (resources.end() != resource && resource->version == version)
+            {
+                slog::log<slog::severities::info>(gate, SLOG_FLF) << "Deleting resource: " << resourceId;
 
-                    set_reply(res, status_codes::NoContent);
-                }
-                else
+                // remove this resource from its super-resource's sub-resources
+                auto super_resource = nmos::find_resource(resources, nmos::get_super_resource(*resource));
+                if (super_resource != resources.end())
                 {
-                    // experimental extension, proposed for v1.3, to distinguish from Not Found
-                    set_error_reply(res, status_codes::Conflict, U("Conflict; ") + details::make_valid_api_version_error(version, resource->version));
-                    res.headers().add(web::http::header_names::location, make_registration_api_resource_location(*resource));
+                    // this isn't modifying the visible data of the super_resouce though, so no resource events need to be generated
+                    // hence resources.modify(...) rather than modify_resource(resources, ...)
+                    resources.modify(super_resource, [&resource](nmos::resource& super_resource)
+                    {
+                        super_resource.sub_resources.erase(resource->id);
+                    });
                 }
-            }
-            else if (details::is_erased_resource(resources, { resourceId, nmos::type_from_resourceType(resourceType) }))
-            {
-                set_error_reply(res, status_codes::NotFound, U("Not Found; ") + details::make_erased_resource_error());
+
+                // "If a Node unregisters a resource in the incorrect order, the Registration API MUST clean up related child resources
+                // on the Node's behalf in order to prevent stale entries remaining in the registry."
+                // See https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.1._Behaviour_-_Registration.html#controlled-unregistration
+                erase_resource(resources, resource->id, false);
+
+                slog::log<slog::severities::too_much_info>(gate, SLOG_FLF) << "Notifying query websockets thread"; // and anyone else who cares...
+                model.notify();
+
+                set_reply(res, status_codes::NoContent);
             }
             else
             {
-                set_reply(res, status_codes::NotFound);
+                details::set_deletion_error_reply(res, resources, version, id_type);
             }
 
             return pplx::task_from_result(true);
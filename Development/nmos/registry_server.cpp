@@ -37,6 +37,11 @@ namespace nmos
             slog::log<slog::severities::info>(gate, SLOG_FLF) << "Configuring nmos-cpp registry with its primary Registration API at: " << nmos::get_host(registry_model.settings) << ":" << nmos::fields::registration_port(registry_model.settings);
             slog::log<slog::severities::info>(gate, SLOG_FLF) << "Configuring nmos-cpp registry with its primary Query API at: " << nmos::get_host(registry_model.settings) << ":" << nmos::fields::query_port(registry_model.settings);
 
+            // Make sure the typed snapshots reflect the settings
+
+            registry_model.update_settings_snapshot();
+            log_model.update_settings_snapshot();
+
             nmos::server registry_server{ registry_model };
 
             // Set up the APIs, assigning them to the configured ports
@@ -1,7 +1,11 @@
 #ifndef NMOS_RESOURCE_H
 #define NMOS_RESOURCE_H
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <tuple>
 #include "nmos/api_version.h"
 #include "nmos/copyable_atomic.h"
 #include "nmos/json_fields.h"
@@ -13,12 +17,25 @@
 
 namespace nmos
 {
+    struct resource_query;
+
+    namespace details
+    {
+        // the serialized representation of a resource's data, for each query API version and downgrade version, and whether higher-versioned keys were stripped
+        // this is populated on demand by readers, i.e. while holding only a read lock on the resources, hence its own mutex
+        struct serialized_cache
+        {
+            std::mutex mutex;
+            std::map<std::tuple<api_version, api_version, bool>, utility::string_t> serialized;
+        };
+    }
+
     // Resources have an API version, resource type and representation as json data
     // Everything else is (internal) registry information: their id, references to their sub-resources, creation and update timestamps,
     // and health which is usually propagated from a node, because only nodes get heartbeats and keep all their sub-resources alive
     struct resource
     {
-        resource() {}
+        resource() : serialized(std::make_shared<details::serialized_cache>()) {}
 
         // the API version, type, id and creation timestamp are logically const after construction*, other data may be modified
         // when any data is modified, the update timestamp must be set, and resource events should be generated
@@ -33,6 +50,7 @@ namespace nmos
             , created(tai_now())
             , updated(created)
             , health(never_expire ? health_forever : created.seconds)
+            , serialized(std::make_shared<details::serialized_cache>())
         {}
 
         resource(api_version version, type type, web::json::value data, bool never_expire)
@@ -69,6 +87,16 @@ namespace nmos
 
         // see https://specs.amwa.tv/is-04/releases/v1.2.0/docs/4.1._Behaviour_-_Registration.html#heartbeating
         mutable details::copyable_atomic<nmos::health> health;
+
+        // for a subscription, the query made from its resource_path and params, to be reused for every resource event
+        // this is reset if the subscription data is modified
+        // see nmos::insert_resource_events
+        std::shared_ptr<const resource_query> subscription_query;
+
+        // the serialized data, cached for each downgrade query API version (and query.strip flag)
+        // this is replaced whenever the resource is inserted or its data is modified, so is never shared by resources with different data
+        // see nmos::resource_query::serialize
+        std::shared_ptr<details::serialized_cache> serialized;
     };
 
     namespace details
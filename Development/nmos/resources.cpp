@@ -1,6 +1,6 @@
 #include "nmos/resources.h"
 
-#include <boost/range/adaptor/reversed.hpp>
+#include <algorithm>
 #include "nmos/is04_versions.h"
 #include "nmos/query_utils.h"
 
@@ -15,30 +15,126 @@ namespace nmos
         return (by_updated.empty() ? tai{} : by_updated.begin()->updated);
     }
 
-    // returns the least health of extant and non-extant resources
-    // note, this is now O(N), not O(1), since resource health is mutable and therefore unindexed
-    std::pair<health, health> least_health(const resources& resources)
+    namespace details
     {
-        const auto now = health_now();
-        std::pair<health, health> results{ now, now };
-        for (const auto& resource : resources)
+        health_index::health_index(const health_index& other)
         {
-            auto& result = resource.has_data() ? results.first : results.second;
+            std::lock_guard<std::mutex> other_lock(other.mutex);
+            extant = other.extant;
+            non_extant = other.non_extant;
+        }
 
-            // since health is mutable, the snapshot may be immediately out of date
-            // but it is reasonable to rely on it not being modified to be *less*
-            const auto health_snapshot = resource.health.load();
-            if (health_snapshot < result)
+        health_index& health_index::operator=(const health_index& other)
+        {
+            if (this != &other)
             {
-                result = health_snapshot;
+                std::unique_lock<std::mutex> lock(mutex, std::defer_lock), other_lock(other.mutex, std::defer_lock);
+                std::lock(lock, other_lock);
+                extant = other.extant;
+                non_extant = other.non_extant;
+            }
+            return *this;
+        }
+
+        // track the resource at its current health, in the buckets for extant or non-extant resources as appropriate
+        static void track_resource_health(const resources& resources, const resource& resource)
+        {
+            auto& index = resources.health_index;
+            std::lock_guard<std::mutex> lock(index.mutex);
+            (resource.has_data() ? index.extant : index.non_extant)[resource.health.load()].insert(resource.id);
+        }
+
+        // stop tracking the resource, before it is forgotten
+        // if it has had heartbeats, it will remain in the bucket for a previous health until that reaches the front
+        static void untrack_resource_health(const resources& resources, const resource& resource)
+        {
+            auto& index = resources.health_index;
+            std::lock_guard<std::mutex> lock(index.mutex);
+            auto& buckets = resource.has_data() ? index.extant : index.non_extant;
+            auto bucket = buckets.find(resource.health.load());
+            if (buckets.end() != bucket && 0 != bucket->second.erase(resource.id) && bucket->second.empty())
+            {
+                buckets.erase(bucket);
+            }
+        }
+
+        // move the resources in the buckets before the specified health which have had heartbeats to the buckets for their actual health,
+        // and drop those which have since been forgotten, or erased or reinserted, so that every resource which remains in those buckets
+        // is tracked at its actual health; if least_only, stop as soon as the front bucket is known to be accurate
+        // the health index mutex must be held by the caller
+        static void refresh_health_buckets(const resources& resources, health_index::buckets& buckets, bool extant, health until, bool least_only)
+        {
+            auto bucket = buckets.begin();
+            while (buckets.end() != bucket && bucket->first < until)
+            {
+                auto& ids = bucket->second;
+                for (auto id = ids.begin(); ids.end() != id;)
+                {
+                    auto found = resources.find(*id);
+                    if (resources.end() == found || extant != found->has_data())
+                    {
+                        id = ids.erase(id);
+                        continue;
+                    }
+
+                    // since health is mutable, the snapshot may be immediately out of date
+                    // but it is reasonable to rely on it not being modified to be *less* without the resource being tracked again
+                    // so if it is less, the resource is already in an earlier bucket
+                    const auto health_snapshot = found->health.load();
+                    if (bucket->first != health_snapshot)
+                    {
+                        if (bucket->first < health_snapshot) buckets[health_snapshot].insert(*id);
+                        id = ids.erase(id);
+                        continue;
+                    }
+
+                    ++id;
+                }
+
+                if (ids.empty())
+                {
+                    bucket = buckets.erase(bucket);
+                }
+                else if (least_only)
+                {
+                    break;
+                }
+                else
+                {
+                    ++bucket;
+                }
             }
         }
-        return results;
+    }
+
+    // returns the least health of extant and non-extant resources
+    // note, this is amortized O(1), since each resource is only moved between buckets of the health index when its bucket reaches the front
+    std::pair<health, health> least_health(const resources& resources)
+    {
+        const auto now = health_now();
+
+        auto& index = resources.health_index;
+        std::lock_guard<std::mutex> lock(index.mutex);
+
+        details::refresh_health_buckets(resources, index.extant, true, health_forever, true);
+        details::refresh_health_buckets(resources, index.non_extant, false, health_forever, true);
+
+        return{
+            index.extant.empty() ? now : (std::min)(index.extant.begin()->first, now),
+            index.non_extant.empty() ? now : (std::min)(index.non_extant.begin()->first, now)
+        };
     }
 
     // insert a resource
     std::pair<resources::iterator, bool> insert_resource(resources& resources, resource&& resource, bool join_sub_resources)
     {
+        if (nmos::types::subscription == resource.type && !resource.subscription_query)
+        {
+            // make the subscription query, which is also used to index the subscription
+            // this may throw if the query parameters are not supported, before anything has been modified
+            resource.subscription_query = details::make_subscription_query(resources, resource);
+        }
+
         if (join_sub_resources)
         {
             // join this resource to any sub-resources which were inserted out-of-order
@@ -48,6 +144,9 @@ namespace nmos
         // set the creation and update timestamps, before inserting the resource
         resource.updated = resource.created = nmos::strictly_increasing_update(resources);
 
+        // discard any serialized data cached for a copy of this resource
+        resource.serialized = std::make_shared<details::serialized_cache>();
+
         // all types (other than nodes, and subscriptions) must* be a sub-resource of an existing resource
         // (*assuming not out-of-order insertion by the allow_invalid_resources setting)
         auto super_resource = find_resource(resources, get_super_resource(resource));
@@ -80,6 +179,8 @@ namespace nmos
             auto inserted_health = nmos::health_forever != inserted.health
                 ? super_resource != resources.end() ? super_resource->health.load() : inserted.created.seconds
                 : nmos::health_forever;
+            inserted.health = inserted_health;
+            details::track_resource_health(resources, inserted);
             set_resource_health(resources, inserted.id, inserted_health);
         }
         // else logic error?
@@ -94,6 +195,7 @@ namespace nmos
         if (resources.end() == found || !found->has_data()) return false;
 
         auto pre = found->data;
+        const auto pre_health = found->health.load();
 
         // "If an exception is thrown by some user-provided operation, then the element pointed to by position is erased."
         // This seems too surprising, despite the fact that it means that a modification may have been partially completed,
@@ -102,7 +204,7 @@ namespace nmos
         std::exception_ptr modifier_exception;
 
         auto resource_updated = nmos::strictly_increasing_update(resources);
-        auto result = resources.modify(found, [&resource_updated, &modifier, &modifier_exception](resource& resource)
+        auto result = resources.modify(found, [&resources, &resource_updated, &modifier, &modifier_exception, &pre](resource& resource)
         {
             try
             {
@@ -113,6 +215,23 @@ namespace nmos
                 modifier_exception = std::current_exception();
             }
 
+            // a subscription query must be made again if the subscription data has been modified
+            if (resource.subscription_query && pre != resource.data)
+            {
+                try
+                {
+                    resource.subscription_query = resource.has_data() ? details::make_subscription_query(resources, resource) : nullptr;
+                }
+                catch (...)
+                {
+                    resource.subscription_query.reset();
+                    if (!modifier_exception) modifier_exception = std::current_exception();
+                }
+            }
+
+            // discard the serialized data cached for the previous data
+            resource.serialized = std::make_shared<details::serialized_cache>();
+
             // set the update timestamp
             resource.updated = resource_updated;
         });
@@ -120,6 +239,13 @@ namespace nmos
         if (result)
         {
             auto& modified = *found;
+
+            // a resource whose health has been decreased, e.g. a subscription which should now expire, must be tracked again
+            if (modified.health < pre_health)
+            {
+                details::track_resource_health(resources, modified);
+            }
+
             insert_resource_events(resources, modified.version, modified.downgrade_version, modified.type, pre, modified.data);
         }
 
@@ -156,6 +282,7 @@ namespace nmos
             resources.modify(found, [&resource_updated](resource& resource)
             {
                 resource.data = web::json::value::null();
+                resource.serialized = std::make_shared<details::serialized_cache>();
 
                 // set the update timestamp when a resource is deleted
                 resource.updated = resource_updated;
@@ -166,8 +293,13 @@ namespace nmos
 
             if (forget_now)
             {
+                details::untrack_resource_health(resources, erased);
                 resources.erase(found);
             }
+            else
+            {
+                details::track_resource_health(resources, erased);
+            }
 
             ++count;
         }
@@ -179,88 +311,108 @@ namespace nmos
     // resources may optionally be initially "erased" by setting data to null, and remain in this non-extant state until they are explicitly forgotten (or reinserted)
     resources::size_type forget_erased_resources(resources& resources, const health& forget_health)
     {
-        resources::size_type count = 0;
-        auto& by_type = resources.get<tags::type>();
-        const auto range = by_type.equal_range(false);
-        auto found = range.first;
-        while (range.second != found)
+        // find the non-extant resources from the front buckets of the health index, and those which never expire
+        std::vector<id> forgotten;
         {
-            if (found->health < forget_health || found->health == health_forever)
+            auto& index = resources.health_index;
+            std::lock_guard<std::mutex> lock(index.mutex);
+            auto& buckets = index.non_extant;
+
+            details::refresh_health_buckets(resources, buckets, false, forget_health, false);
+
+            auto bucket = buckets.begin();
+            while (buckets.end() != bucket && (bucket->first < forget_health || bucket->first == health_forever))
             {
-                found = by_type.erase(found);
-                ++count;
+                forgotten.insert(forgotten.end(), bucket->second.begin(), bucket->second.end());
+                bucket = buckets.erase(bucket);
             }
-            else
+        }
+
+        resources::size_type count = 0;
+        for (const auto& id : forgotten)
+        {
+            // the buckets which never expire are not refreshed, so check the resource has not been reinserted
+            auto found = resources.find(id);
+            if (resources.end() != found && !found->has_data() && (found->health < forget_health || found->health == health_forever))
             {
-                ++found;
+                resources.erase(found);
+                ++count;
             }
         }
         return count;
     }
 
-    // erase all resources of the specified type which expired *before* the specified time from the specified resources
+    // erase all resources which expired *before* the specified time from the specified resources
     // and return the count of the number of resources erased; sub-resources are *not* erased
     // resources may optionally be initially "erased" by setting data to null, and remain in this non-extant state until they are explicitly forgotten (or reinserted)
     // by default, the updated timestamp is not modified but this may be overridden
-    resources::size_type erase_expired_resources(resources& resources, const nmos::type& type, const health& expire_health, bool forget_now, bool set_updated)
+    resources::size_type erase_expired_resources(resources& resources, const health& expire_health, bool forget_now, bool set_updated)
     {
-        resources::size_type count = 0;
-        auto& by_type = resources.get<tags::type>();
-        const auto range = by_type.equal_range(details::has_data(type));
-        auto found = range.first;
-        while (range.second != found)
+        // find the expired resources from the front buckets of the health index, without visiting any which have had heartbeats since their previous expiry check
+        std::vector<resources::iterator> expired;
         {
-            if (expire_health <= found->health)
-            {
-                ++found;
-            }
-            else
-            {
-                // since modify reorders the resource in this index
-                const auto next = std::next(found);
+            auto& index = resources.health_index;
+            std::lock_guard<std::mutex> lock(index.mutex);
+            auto& buckets = index.extant;
 
-                const auto pre = found->data;
+            details::refresh_health_buckets(resources, buckets, true, expire_health, false);
 
-                auto resource_updated = nmos::strictly_increasing_update(resources);
-                by_type.modify(found, [&](resource& resource)
+            auto bucket = buckets.begin();
+            while (buckets.end() != bucket && bucket->first < expire_health)
+            {
+                for (const auto& id : bucket->second)
                 {
-                    resource.data = web::json::value::null();
+                    expired.push_back(resources.find(id));
+                }
+                bucket = buckets.erase(bucket);
+            }
+        }
 
-                    // optionally set the update timestamp when a resource is expired
-                    if (set_updated)
-                    {
-                        resource.updated = resource_updated;
-                    }
-                });
+        // erase sub-resources before super-resources
+        // (resources of other types are not expired)
+        const auto type_order = [](const resources::iterator& resource)
+        {
+            return std::find(nmos::types::all.begin(), nmos::types::all.end(), resource->type) - nmos::types::all.begin();
+        };
+        expired.erase(std::remove_if(expired.begin(), expired.end(), [&type_order](const resources::iterator& resource)
+        {
+            return (size_t)type_order(resource) == nmos::types::all.size();
+        }), expired.end());
+        std::stable_sort(expired.begin(), expired.end(), [&type_order](const resources::iterator& lhs, const resources::iterator& rhs)
+        {
+            return type_order(lhs) > type_order(rhs);
+        });
 
-                auto& erased = *found;
-                insert_resource_events(resources, erased.version, erased.downgrade_version, erased.type, pre, erased.data);
+        for (auto& found : expired)
+        {
+            const auto pre = found->data;
+
+            auto resource_updated = nmos::strictly_increasing_update(resources);
+            resources.modify(found, [&](resource& resource)
+            {
+                resource.data = web::json::value::null();
+                resource.serialized = std::make_shared<details::serialized_cache>();
 
-                if (forget_now)
+                // optionally set the update timestamp when a resource is expired
+                if (set_updated)
                 {
-                    by_type.erase(found);
+                    resource.updated = resource_updated;
                 }
+            });
 
-                found = next;
-                ++count;
-            }
-        }
-        return count;
-    }
+            auto& erased = *found;
+            insert_resource_events(resources, erased.version, erased.downgrade_version, erased.type, pre, erased.data);
 
-    // erase all resources which expired *before* the specified time from the specified resources
-    // and return the count of the number of resources erased
-    // resources may optionally be initially "erased" by setting data to null, and remain in this non-extant state until they are explicitly forgotten (or reinserted)
-    // by default, the updated timestamp is not modified but this may be overridden
-    resources::size_type erase_expired_resources(resources& resources, const health& expire_health, bool forget_now, bool set_updated)
-    {
-        resources::size_type count = 0;
-        // reverse order to ensure sub-resources are erased before super-resources
-        for (const auto& type : nmos::types::all | boost::adaptors::reversed)
-        {
-            count += erase_expired_resources(resources, type, expire_health, forget_now, set_updated);
+            if (forget_now)
+            {
+                resources.erase(found);
+            }
+            else
+            {
+                details::track_resource_health(resources, erased);
+            }
         }
-        return count;
+        return expired.size();
     }
 
     // find the resource with the specified id in the specified resources (if present) and
@@ -278,7 +430,11 @@ namespace nmos
 
             // since health is mutable, no need for:
             // resources.modify(found, [&health](nmos::resource& resource){ resource.health = health; });
-            found->health = health;
+            // but a resource whose health is decreased must be tracked again by the health index
+            if (health < found->health.exchange(health))
+            {
+                details::track_resource_health(resources, *found);
+            }
         }
     }
 
@@ -386,15 +542,61 @@ namespace nmos
         return nodes.second != nodes.first ? resources.project<0>(nodes.first) : resources.end();
     }
 
+    namespace details
+    {
+        template <typename Tag>
+        static void insert_property_resources(std::vector<const resource*>& results, const resources& resources, const type& type, property_value_kind kind, const utility::string_t& value)
+        {
+            auto& by_property = resources.get<Tag>();
+            const auto range = by_property.equal_range(boost::make_tuple(kind, value));
+            for (auto it = range.first; range.second != it; ++it)
+            {
+                if (it->has_data() && (type.name.empty() || type == it->type)) results.push_back(&*it);
+            }
+        }
+    }
+
+    // find the extant resources of the specified type (or all types if empty) which have the specified kind of value, and string value,
+    // for the indexed property identified by its key path, e.g. "subscription.sender_id", in no particular order
+    // returns false if the property is not indexed
+    bool find_property_resources(std::vector<const resource*>& results, const resources& resources, const type& type, const utility::string_t& property, details::property_value_kind kind, const utility::string_t& value)
+    {
+        const auto& key = details::string_property_value == kind ? value : utility::string_t{};
+
+        if (nmos::fields::node_id.key == property) details::insert_property_resources<tags::node_id>(results, resources, type, kind, key);
+        else if (nmos::fields::device_id.key == property) details::insert_property_resources<tags::device_id>(results, resources, type, kind, key);
+        else if (nmos::fields::source_id.key == property) details::insert_property_resources<tags::source_id>(results, resources, type, kind, key);
+        else if (nmos::fields::flow_id.key == property) details::insert_property_resources<tags::flow_id>(results, resources, type, kind, key);
+        else if (U("subscription.sender_id") == property) details::insert_property_resources<tags::subscription_sender_id>(results, resources, type, kind, key);
+        else if (nmos::fields::subscription_id.key == property) details::insert_property_resources<tags::subscription_id>(results, resources, type, kind, key);
+        else return false;
+
+        return true;
+    }
+
     // get the id of each resource with the specified super-resource
     std::set<nmos::id> get_sub_resources(const resources& resources, const std::pair<id, type>& id_type)
     {
         std::set<nmos::id> result;
-        for (const auto& sub_resource : resources)
+
+        // see get_super_resource for the property by which each type of sub-resource refers to its super-resource
+        // (resources of other types cannot have sub-resources)
+        const auto& property
+            = nmos::types::node == id_type.second ? nmos::fields::node_id.key
+            : nmos::types::device == id_type.second ? nmos::fields::device_id.key
+            : nmos::types::source == id_type.second ? nmos::fields::source_id.key
+            : nmos::types::subscription == id_type.second ? nmos::fields::subscription_id.key
+            : utility::string_t{};
+        if (property.empty() || id_type.first.empty()) return result;
+
+        std::vector<const resource*> candidates;
+        find_property_resources(candidates, resources, {}, property, details::string_property_value, id_type.first);
+        for (const auto& sub_resource : candidates)
         {
-            if (id_type == get_super_resource(sub_resource))
+            // e.g. a flow's source_id only refers to its super-resource for v1.0 flows
+            if (id_type == get_super_resource(*sub_resource))
             {
-                result.insert(sub_resource.id);
+                result.insert(sub_resource->id);
             }
         }
         return result;
@@ -402,6 +604,111 @@ namespace nmos
 
     namespace details
     {
+        // extant subscriptions are indexed by the resource type of their query (empty for all types), the property and value
+        // required by their query (both empty if none), and their API version
+        // other resources have an empty subscription key
+
+        bool is_subscription_key(const resource& resource)
+        {
+            return resource.has_data() && resource.subscription_query;
+        }
+
+        const type& subscription_key_type(const resource& resource)
+        {
+            static const type no_type;
+            return is_subscription_key(resource) ? resource.subscription_query->type : no_type;
+        }
+
+        const utility::string_t& subscription_key_property(const resource& resource)
+        {
+            static const utility::string_t no_property;
+            return is_subscription_key(resource) ? resource.subscription_query->key_property : no_property;
+        }
+
+        const utility::string_t& subscription_key_value(const resource& resource)
+        {
+            static const utility::string_t no_value;
+            return is_subscription_key(resource) ? resource.subscription_query->key_value : no_value;
+        }
+
+        const api_version& subscription_key_version(const resource& resource)
+        {
+            static const api_version no_version;
+            return is_subscription_key(resource) ? resource.subscription_query->version : no_version;
+        }
+
+        // the key path of each indexed property
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::node_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::node_id };
+            return key_path;
+        }
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::device_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::device_id };
+            return key_path;
+        }
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::source_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::source_id };
+            return key_path;
+        }
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::flow_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::flow_id };
+            return key_path;
+        }
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::subscription_sender_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::subscription, nmos::fields::sender_id };
+            return key_path;
+        }
+
+        template <> const std::vector<utility::string_t>& property_key_path<tags::subscription_id>()
+        {
+            static const std::vector<utility::string_t> key_path{ nmos::fields::subscription_id };
+            return key_path;
+        }
+
+        // the value of the property at the specified key path, or null if the resource doesn't have the property
+        // if an array is found part way along the key path, that is returned instead, since a Basic Query may match
+        // the property of any of its elements, so the resource must be found by the array kind of value
+        static const web::json::value* find_property_value(const resource& resource, const std::vector<utility::string_t>& key_path)
+        {
+            const web::json::value* value = &resource.data;
+            for (const auto& key : key_path)
+            {
+                if (value->is_array()) return value;
+                if (!value->is_object()) return nullptr;
+                auto& object = value->as_object();
+                auto found = object.find(key);
+                if (object.end() == found) return nullptr;
+                value = &found->second;
+            }
+            return value;
+        }
+
+        property_value_kind property_key_kind(const resource& resource, const std::vector<utility::string_t>& key_path)
+        {
+            const auto value = find_property_value(resource, key_path);
+            if (!value) return no_property_value;
+            if (value->is_string()) return string_property_value;
+            if (value->is_array()) return array_property_value;
+            return other_property_value;
+        }
+
+        const utility::string_t& property_key_value(const resource& resource, const std::vector<utility::string_t>& key_path)
+        {
+            static const utility::string_t no_value;
+            const auto value = find_property_value(resource, key_path);
+            return value && value->is_string() ? value->as_string() : no_value;
+        }
+
         // return true if the resource is "erased" but not forgotten
         bool is_erased_resource(const resources& resources, const std::pair<id, type>& id_type)
         {
@@ -2,8 +2,13 @@
 #define NMOS_RESOURCES_H
 
 #include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/global_fun.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -23,6 +28,15 @@ namespace nmos
         struct type;
         struct created;
         struct updated;
+        struct type_created;
+        struct type_updated;
+        struct subscription;
+        struct node_id;
+        struct device_id;
+        struct source_id;
+        struct flow_id;
+        struct subscription_sender_id;
+        struct subscription_id;
     }
 
     namespace details
@@ -32,24 +46,113 @@ namespace nmos
         typedef boost::tuple<bool, type> type_extractor_tuple;
         typedef boost::multi_index::member<resource, tai, &resource::created> created_extractor;
         typedef boost::multi_index::member<resource, tai, &resource::updated> updated_extractor;
+        typedef boost::multi_index::composite_key<resource, boost::multi_index::const_mem_fun<resource, bool, &resource::has_data>, boost::multi_index::member<resource, type, &resource::type>, boost::multi_index::member<resource, tai, &resource::created>> type_created_extractor;
+        typedef boost::multi_index::composite_key<resource, boost::multi_index::const_mem_fun<resource, bool, &resource::has_data>, boost::multi_index::member<resource, type, &resource::type>, boost::multi_index::member<resource, tai, &resource::updated>> type_updated_extractor;
+        typedef boost::multi_index::composite_key_compare<std::less<bool>, std::less<type>, std::greater<tai>> type_timestamp_compare;
 
         // extant resources have non-null data
         inline type_extractor_tuple has_data(const type& type) { return type_extractor_tuple{ true, type }; }
+
+        // extant subscriptions are indexed by the resource type of their query (empty for all types), the property and value
+        // required by their query (both empty if none), and their API version, so that each resource event need only be matched
+        // against the subscriptions which could match it, see nmos::insert_resource_events
+        // other resources have an empty subscription key
+        bool is_subscription_key(const resource& resource);
+        const type& subscription_key_type(const resource& resource);
+        const utility::string_t& subscription_key_property(const resource& resource);
+        const utility::string_t& subscription_key_value(const resource& resource);
+        const api_version& subscription_key_version(const resource& resource);
+
+        typedef boost::multi_index::composite_key<resource,
+            boost::multi_index::global_fun<const resource&, bool, &is_subscription_key>,
+            boost::multi_index::global_fun<const resource&, const type&, &subscription_key_type>,
+            boost::multi_index::global_fun<const resource&, const utility::string_t&, &subscription_key_property>,
+            boost::multi_index::global_fun<const resource&, const utility::string_t&, &subscription_key_value>,
+            boost::multi_index::global_fun<const resource&, const api_version&, &subscription_key_version>
+        > subscription_extractor;
+
+        // some properties which are frequently required by Basic Queries to have a specific value, i.e. the ids of related resources,
+        // are also indexed, so that e.g. the flows of one source, or the receivers subscribed to one sender, can be found without a full scan
+        // each property index is keyed by the kind of value the resource has for the property, and the value itself if it's a string
+        // see nmos::find_property_resources
+        enum property_value_kind { no_property_value, string_property_value, array_property_value, other_property_value };
+
+        // the key path of each indexed property, e.g. { "subscription", "sender_id" }
+        template <typename Tag> const std::vector<utility::string_t>& property_key_path();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::node_id>();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::device_id>();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::source_id>();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::flow_id>();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::subscription_sender_id>();
+        template <> const std::vector<utility::string_t>& property_key_path<tags::subscription_id>();
+
+        property_value_kind property_key_kind(const resource& resource, const std::vector<utility::string_t>& key_path);
+        const utility::string_t& property_key_value(const resource& resource, const std::vector<utility::string_t>& key_path);
+
+        template <typename Tag>
+        inline property_value_kind property_key_kind(const resource& resource) { return property_key_kind(resource, property_key_path<Tag>()); }
+        template <typename Tag>
+        inline const utility::string_t& property_key_value(const resource& resource) { return property_key_value(resource, property_key_path<Tag>()); }
+
+        template <typename Tag>
+        using property_extractor = boost::multi_index::composite_key<resource,
+            boost::multi_index::global_fun<const resource&, property_value_kind, &property_key_kind<Tag>>,
+            boost::multi_index::global_fun<const resource&, const utility::string_t&, &property_key_value<Tag>>
+        >;
+
+        // resource health is mutable, so that heartbeats only require a shared/read lock, and therefore cannot be indexed by the container
+        // instead, the ids of extant and non-extant resources are bucketed by health, one bucket per second like a timing wheel
+        // each resource is tracked at a health no greater than its actual health, since heartbeats don't update the buckets,
+        // and is only moved to the bucket for its actual health when its bucket reaches the front, at most once per expiry interval
+        // see nmos::least_health, nmos::erase_expired_resources and nmos::forget_erased_resources
+        struct health_index
+        {
+            health_index() {}
+            health_index(const health_index& other);
+            health_index& operator=(const health_index& other);
+
+            typedef std::map<health, std::unordered_set<id>> buckets;
+
+            mutable std::mutex mutex;
+            buckets extant;
+            buckets non_extant;
+        };
     }
 
     // the id index ensures resource id is unique
     // the type index is a composite index incorporating whether the resource has been deleted or expired
     // the created/updated indices ensure uniqueness to satisfy the requirements of Query API cursor-based paging
     // and are in descending order to simplify implementation
+    // the type_created/type_updated indices are composite indices in the same order within each type, so that
+    // cursor-based paging of resources of one type does not need to skip over all the resources of other types
+    // the subscription index is a composite index used to dispatch resource events to Query API subscriptions
+    // the property indices are hashed by the value of a frequently queried property, see nmos::find_property_resources
+    // and since they include all the references from sub-resources to super-resources, also see nmos::get_sub_resources
     typedef boost::multi_index_container<
         resource,
         boost::multi_index::indexed_by<
             boost::multi_index::hashed_unique<boost::multi_index::tag<tags::id>, details::id_extractor>,
             boost::multi_index::ordered_non_unique<boost::multi_index::tag<tags::type>, details::type_extractor>,
             boost::multi_index::ordered_unique<boost::multi_index::tag<tags::created>, details::created_extractor, std::greater<details::created_extractor::result_type>>,
-            boost::multi_index::ordered_unique<boost::multi_index::tag<tags::updated>, details::updated_extractor, std::greater<details::updated_extractor::result_type>>
+            boost::multi_index::ordered_unique<boost::multi_index::tag<tags::updated>, details::updated_extractor, std::greater<details::updated_extractor::result_type>>,
+            boost::multi_index::ordered_non_unique<boost::multi_index::tag<tags::type_created>, details::type_created_extractor, details::type_timestamp_compare>,
+            boost::multi_index::ordered_non_unique<boost::multi_index::tag<tags::type_updated>, details::type_updated_extractor, details::type_timestamp_compare>,
+            boost::multi_index::ordered_non_unique<boost::multi_index::tag<tags::subscription>, details::subscription_extractor>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::node_id>, details::property_extractor<tags::node_id>>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::device_id>, details::property_extractor<tags::device_id>>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::source_id>, details::property_extractor<tags::source_id>>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::flow_id>, details::property_extractor<tags::flow_id>>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::subscription_sender_id>, details::property_extractor<tags::subscription_sender_id>>,
+            boost::multi_index::hashed_non_unique<boost::multi_index::tag<tags::subscription_id>, details::property_extractor<tags::subscription_id>>
         >
-    > resources;
+    > resources_container;
+
+    // resources also has a health index, which is maintained by the resource creation/update/deletion operations below
+    // and is protected by its own mutex, so that resource health can be tracked while only holding a shared/read lock
+    struct resources : resources_container
+    {
+        mutable details::health_index health_index;
+    };
 
     // Resource creation/update/deletion operations
 
@@ -63,7 +166,7 @@ namespace nmos
     }
 
     // returns the least health of extant and non-extant resources
-    // note, this is now O(N), not O(1), since resource health is mutable and therefore unindexed
+    // note, this is amortized O(1), since each resource is only moved between buckets of the health index when its bucket reaches the front
     std::pair<health, health> least_health(const resources& resources);
 
     // insert a resource (join_sub_resources can be false if related resources are known to be inserted in order)
@@ -80,12 +183,14 @@ namespace nmos
     // forget all erased resources which expired *before* the specified time from the specified resources
     // and return the count of the number of resources forgotten
     // resources may optionally be initially "erased" by setting data to null, and remain in this non-extant state until they are explicitly forgotten (or reinserted)
+    // note, only resources which have been tracked by the health index are considered, i.e. those erased by the operations above
     resources::size_type forget_erased_resources(resources& resources, const health& forget_health = health_forever);
 
     // erase all resources which expired *before* the specified time from the specified resources
     // and return the count of the number of resources erased
     // resources may optionally be initially "erased" by setting data to null, and remain in this non-extant state until they are explicitly forgotten (or reinserted)
     // by default, the updated timestamp is not modified but this may be overridden
+    // note, only resources which have been tracked by the health index are considered, i.e. those inserted by insert_resource
     resources::size_type erase_expired_resources(resources& resources, const health& expire_health, bool forget_now = true, bool set_updated = false);
 
     // find the resource with the specified id in the specified resources (if present) and
@@ -128,7 +233,13 @@ namespace nmos
     resources::const_iterator find_self_resource(const resources& resources);
     resources::iterator find_self_resource(resources& resources);
 
+    // find the extant resources of the specified type (or all types if empty) which have the specified kind of value, and string value,
+    // for the indexed property identified by its key path, e.g. "subscription.sender_id", in no particular order
+    // returns false if the property is not indexed
+    bool find_property_resources(std::vector<const resource*>& results, const resources& resources, const type& type, const utility::string_t& property, details::property_value_kind kind, const utility::string_t& value = {});
+
     // get the id of each resource with the specified super-resource
+    // note, this is O(M) in the number of sub-resources, using the property index of the reference to the super-resource
     std::set<nmos::id> get_sub_resources(const resources& resources, const std::pair<id, type>& id_type);
 
     namespace details
@@ -118,6 +118,10 @@ namespace nmos
     {
         web::websockets::experimental::listener::websocket_listener_config config;
         config.set_backlog(nmos::fields::listen_backlog(settings));
+        config.set_threads(nmos::experimental::fields::websocket_listener_threads(settings));
+        config.set_compression(nmos::experimental::fields::websocket_compression(settings));
+        config.set_compression_level(nmos::experimental::fields::websocket_compression_level(settings));
+        config.set_compression_context_takeover(nmos::experimental::fields::websocket_compression_context_takeover(settings));
 #if !defined(_WIN32) || !defined(__cplusplus_winrt)
         config.set_ssl_context_callback(details::make_listener_ssl_context_callback<web::websockets::websocket_exception>(settings, load_server_certificates, load_dh_param, get_ocsp_response, gate));
 #endif
@@ -4,6 +4,7 @@
 #include <boost/range/algorithm/find_first_of.hpp>
 #include <boost/version.hpp>
 #include <openssl/opensslv.h>
+#include "cpprest/basic_utils.h" // for utility::us2s
 #include "cpprest/host_utils.h"
 #include "cpprest/http_utils.h"
 #include "cpprest/version.h"
@@ -221,4 +222,20 @@ namespace nmos
             ;
         return s.str();
     }
+
+    settings_snapshot::settings_snapshot(const settings& settings)
+        : logging_all_categories(!settings.has_field(nmos::fields::logging_categories))
+        , logging_limit((std::size_t)nmos::experimental::fields::logging_limit(settings))
+        , registration_expiry_interval(nmos::fields::registration_expiry_interval(settings))
+        , query_paging_default((std::size_t)nmos::fields::query_paging_default(settings))
+        , query_paging_limit((std::size_t)nmos::fields::query_paging_limit(settings))
+    {
+        if (!logging_all_categories)
+        {
+            for (const auto& category : nmos::fields::logging_categories(settings))
+            {
+                logging_categories.insert(utility::us2s(category.as_string()));
+            }
+        }
+    }
 }
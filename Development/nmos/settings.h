@@ -1,6 +1,8 @@
 #ifndef NMOS_SETTINGS_H
 #define NMOS_SETTINGS_H
 
+#include <memory>
+#include <set>
 #include "bst/optional.h"
 #include "cpprest/json_utils.h"
 
@@ -264,6 +266,10 @@ namespace nmos
             const web::json::field_as_integer_or query_ws_paging_default{ U("query_ws_paging_default"), 10 };
             const web::json::field_as_integer_or query_ws_paging_limit{ U("query_ws_paging_limit"), 100 };
 
+            // events_ws_max_update_rate_ms [node]: minimum interval between state messages for each source when using the IS-07 Events WebSocket API, or zero to send every change
+            // when non-zero, bursts of changes to a source are coalesced, so that only its latest state is sent; a source may override this with its own "max_update_rate_ms"
+            const web::json::field_as_integer_or events_ws_max_update_rate_ms{ U("events_ws_max_update_rate_ms"), 0 };
+
             // logging_limit [registry, node]: maximum number of log events cached for the Logging API
             const web::json::field_as_integer_or logging_limit{ U("logging_limit"), 1234 };
 
@@ -287,6 +293,31 @@ namespace nmos
             // discovery_mode [node]: whether the discovered host name (1) or resolved addresses (2) are used to construct request URLs for Registration APIs or System APIs
             const web::json::field_as_integer_or discovery_mode{ U("discovery_mode"), 0 }; // when omitted, a default heuristic is used
 
+            // registration_concurrency [node]: maximum number of concurrent requests to the Registration API /resource endpoint
+            // requests are only made concurrently for resources which do not depend on each other, i.e. respecting super-resource ordering
+            // 1 (the default) means requests are made one at a time
+            const web::json::field_as_integer_or registration_concurrency{ U("registration_concurrency"), 1 };
+
+            // connection_api_bulk_concurrency [node]: maximum number of threads used to validate the entries of a Connection API 'bulk' request, or zero for the number of hardware threads
+            // when greater than 1, the transport_file_parser and connection_resource_patch_validator callbacks may be called concurrently, with a read lock on the model
+            // 1 (the default) means the entries are validated one at a time, in order
+            const web::json::field_as_integer_or connection_api_bulk_concurrency{ U("connection_api_bulk_concurrency"), 1 };
+
+            // websocket_listener_threads [registry, node]: number of threads used by each WebSocket API server, e.g. for the Query WebSocket API or IS-07 Events WebSocket API,
+            // or zero for the number of hardware threads; messages for each connection are still handled in order
+            const web::json::field_as_integer_or websocket_listener_threads{ U("websocket_listener_threads"), 1 };
+
+            // websocket_compression [registry, node]: whether to accept a client's offer of the permessage-deflate extension (RFC 7692) to compress WebSocket API messages
+            // e.g. Query WebSocket API grains or IS-07 Events WebSocket API state messages, which may be large and are highly repetitive
+            const web::json::field_as_bool_or websocket_compression{ U("websocket_compression"), false };
+
+            // websocket_compression_level [registry, node]: zlib compression level used for WebSocket API messages, from 0 (no compression) to 9 (best compression), or -1 for the zlib default
+            const web::json::field_as_integer_or websocket_compression_level{ U("websocket_compression_level"), -1 };
+
+            // websocket_compression_context_takeover [registry, node]: whether the compression context is retained from one message to the next on each WebSocket API connection
+            // which generally improves the compression of repetitive messages, at the expense of memory per connection
+            const web::json::field_as_bool_or websocket_compression_context_takeover{ U("websocket_compression_context_takeover"), true };
+
             // href_mode [registry, node]: whether the host name (1), addresses (2) or both (3) are used to construct response headers, and host and URL fields in the data model
             const web::json::field_as_integer_or href_mode{ U("href_mode"), 0 }; // when omitted, a default heuristic is used
 
@@ -358,6 +389,34 @@ namespace nmos
             const web::json::field_as_integer_or ocsp_request_max{ U("ocsp_request_max"), 30 };
         }
     }
+
+    // A typed, immutable copy of the settings that are used very frequently, e.g. for every request or log message,
+    // so that these can be read without field lookups, and without locking the mutex that protects the settings
+    // (a new snapshot is made whenever the settings are modified, so every writer of the settings of a model, e.g. nmos::base_model
+    // or nmos::experimental::log_model, must call its update_settings_snapshot() afterwards, with the mutex still locked if the model is shared)
+    struct settings_snapshot
+    {
+        explicit settings_snapshot(const settings& settings);
+
+        // see nmos::fields::logging_categories, which are held as utf-8 to compare directly with each nmos::category
+        bool logging_all_categories;
+        std::set<std::string> logging_categories;
+
+        // see nmos::experimental::fields::logging_limit
+        std::size_t logging_limit;
+
+        // see nmos::fields::registration_expiry_interval
+        int registration_expiry_interval;
+
+        // see nmos::fields::query_paging_default and nmos::fields::query_paging_limit
+        std::size_t query_paging_default;
+        std::size_t query_paging_limit;
+    };
+
+    inline std::shared_ptr<const settings_snapshot> make_settings_snapshot(const settings& settings)
+    {
+        return std::make_shared<const settings_snapshot>(settings);
+    }
 }
 
 #endif
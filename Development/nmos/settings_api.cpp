@@ -57,6 +57,10 @@ namespace nmos
                     // that can be read by logging statements without locking the mutex protecting the settings
                     log_model.level = nmos::fields::logging_level(log_model.settings);
 
+                    // and the frequently used settings are copied into typed snapshots for the same reason
+                    model.update_settings_snapshot();
+                    log_model.update_settings_snapshot();
+
                     // notify anyone who cares...
                     model.notify();
 
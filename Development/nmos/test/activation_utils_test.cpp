@@ -0,0 +1,187 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/activation_utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include "bst/test/test.h"
+#include "nmos/activation_mode.h"
+#include "nmos/connection_activation.h"
+#include "nmos/connection_resources.h"
+#include "nmos/is04_versions.h"
+#include "nmos/model.h"
+#include "nmos/slog.h"
+
+namespace
+{
+    class nolog_gate : public slog::base_gate
+    {
+    public:
+        virtual bool pertinent(slog::severity) const { return false; }
+        virtual void log(const slog::log_message&) const {}
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testActivationSchedule)
+{
+    typedef nmos::details::activation_schedule::id_type id_type;
+    const id_type receiver{ U("c2a3c4b1-7ad0-4c5b-9b1e-2d2f1b3b5a31"), nmos::types::receiver };
+    const id_type sender{ U("d5b4e1a2-3c1f-4a6b-8e2d-7f9a0b1c2d3e"), nmos::types::sender };
+    const id_type other_sender{ U("a7ba0cd2-c1ba-4ee3-a4c5-d5cdc3ab5c77"), nmos::types::sender };
+
+    const auto t0 = nmos::tai_clock::now();
+    const auto ms = std::chrono::milliseconds(1);
+    const auto never = (nmos::tai_clock::time_point::max)();
+
+    nmos::details::activation_schedule schedule;
+    BST_REQUIRE(schedule.empty());
+    BST_REQUIRE(never == schedule.earliest());
+
+    schedule.insert(receiver, t0 + 30 * ms);
+    schedule.insert(sender, t0 + 10 * ms);
+    schedule.insert(other_sender, t0 + 20 * ms);
+    BST_REQUIRE_EQUAL(3, schedule.size());
+    BST_REQUIRE(t0 + 10 * ms == schedule.earliest());
+
+    // rescheduling and cancelling take effect immediately
+    schedule.insert(sender, t0 + 40 * ms);
+    BST_REQUIRE(t0 + 20 * ms == schedule.earliest());
+    schedule.erase(other_sender);
+    BST_REQUIRE(t0 + 30 * ms == schedule.earliest());
+    BST_REQUIRE_EQUAL(2, schedule.size());
+
+    // nothing is due yet
+    BST_REQUIRE(schedule.pop_due(t0 + 29 * ms).empty());
+
+    // activations are due in order of activation time, and only once
+    const auto due = schedule.pop_due(t0 + 40 * ms);
+    BST_REQUIRE_EQUAL(2, due.size());
+    BST_REQUIRE(receiver == due[0]);
+    BST_REQUIRE(sender == due[1]);
+    BST_REQUIRE(schedule.empty());
+    BST_REQUIRE(schedule.pop_due(t0 + 50 * ms).empty());
+    BST_REQUIRE(never == schedule.earliest());
+
+    // repeatedly rescheduling the same activation does not accumulate entries
+    for (int i = 0; i < 1000; ++i)
+    {
+        schedule.insert(receiver, t0 + (1000 - i) * ms);
+    }
+    BST_REQUIRE_EQUAL(1, schedule.size());
+    BST_REQUIRE(t0 + 1 * ms == schedule.earliest());
+    BST_REQUIRE_EQUAL(1, schedule.pop_due(t0 + 1000 * ms).size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// measure how late scheduled activations are processed by nmos::connection_activation_thread
+// with many receivers, while other receivers are being staged continuously, like frequent PATCH requests
+BST_TEST_CASE_PERFORMANCE(testScheduledActivationJitterPerformance)
+{
+    using web::json::value;
+    using web::json::value_of;
+
+    const size_t receiver_count = 2000;
+    const size_t activation_count = 200;
+    const auto activation_interval = std::chrono::milliseconds(2);
+
+    nolog_gate gate;
+    nmos::node_model model;
+
+    std::vector<nmos::id> receiver_ids;
+    for (size_t i = 0; i < receiver_count; ++i)
+    {
+        receiver_ids.push_back(nmos::make_id());
+        insert_resource(model.node_resources, { nmos::is04_versions::v1_3, nmos::types::receiver, value_of({
+            { nmos::fields::id, receiver_ids.back() },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, U("receiver") },
+            { nmos::fields::device_id, nmos::make_id() }
+        }), false });
+        insert_resource(model.connection_resources, nmos::make_connection_rtp_receiver(receiver_ids.back(), false));
+    }
+
+    // scheduled activation time of each receiver, and how late each activation actually was
+    std::map<nmos::id, nmos::tai_clock::time_point> scheduled;
+    std::vector<nmos::tai_clock::duration> lateness;
+
+    std::thread activation_thread([&]
+    {
+        nmos::connection_activation_thread(model,
+            [](const nmos::resource&, const nmos::resource&, value&) {},
+            [](const nmos::resource&, const nmos::resource&, value&) {},
+            [&](const nmos::resource& resource, const nmos::resource&)
+            {
+                // called with the model locked
+                const auto now = nmos::tai_clock::now();
+                auto found = scheduled.find(resource.id);
+                if (scheduled.end() != found) lateness.push_back(now - found->second);
+            },
+            gate);
+    });
+
+    // stage the scheduled activations of the first receivers
+    const auto start = nmos::tai_clock::now() + std::chrono::milliseconds(100);
+    {
+        auto lock = model.write_lock();
+        for (size_t i = 0; i < activation_count; ++i)
+        {
+            const auto activation_time = start + i * activation_interval;
+            scheduled[receiver_ids[i]] = activation_time;
+            const auto at = value::string(nmos::make_version(nmos::tai_from_time_point(activation_time)));
+            modify_resource(model.connection_resources, receiver_ids[i], [&at](nmos::resource& connection_receiver)
+            {
+                nmos::fields::endpoint_staged(connection_receiver.data)[nmos::fields::activation] = value_of({
+                    { nmos::fields::mode, nmos::activation_modes::activate_scheduled_absolute.name },
+                    { nmos::fields::requested_time, at },
+                    { nmos::fields::activation_time, at }
+                });
+            });
+        }
+        model.notify();
+    }
+
+    // meanwhile, keep staging the other receivers
+    std::atomic<bool> stop{ false };
+    std::thread staging_thread([&]
+    {
+        for (size_t i = activation_count; !stop; i = i + 1 < receiver_count ? i + 1 : activation_count)
+        {
+            {
+                auto lock = model.write_lock();
+                modify_resource(model.connection_resources, receiver_ids[i], [](nmos::resource& connection_receiver)
+                {
+                    auto& master_enable = nmos::fields::endpoint_staged(connection_receiver.data)[nmos::fields::master_enable];
+                    master_enable = value::boolean(!master_enable.as_bool());
+                });
+                model.notify();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    {
+        auto lock = model.read_lock();
+        BST_REQUIRE(model.wait_for(lock, std::chrono::seconds(5), [&] { return activation_count == lateness.size(); }));
+    }
+
+    stop = true;
+    staging_thread.join();
+    model.controlled_shutdown();
+    activation_thread.join();
+
+    // activations must never be early
+    BST_REQUIRE(std::all_of(lateness.begin(), lateness.end(), [](const nmos::tai_clock::duration& d) { return d >= nmos::tai_clock::duration::zero(); }));
+
+    std::sort(lateness.begin(), lateness.end());
+    const auto percentile = [&lateness](size_t p)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(lateness[(lateness.size() - 1) * p / 100]).count();
+    };
+    std::cout << activation_count << " scheduled activations, " << receiver_count << " receivers: lateness"
+        << " p50 " << percentile(50) << " us,"
+        << " p90 " << percentile(90) << " us,"
+        << " p99 " << percentile(99) << " us,"
+        << " max " << percentile(100) << " us" << std::endl;
+}
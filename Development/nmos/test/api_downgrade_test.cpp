@@ -0,0 +1,112 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/api_downgrade.h"
+
+#include <chrono>
+#include <iostream>
+#include "bst/test/test.h"
+#include "nmos/is04_versions.h"
+#include "nmos/query_utils.h"
+
+namespace
+{
+    nmos::resource make_sender(const nmos::api_version& version, const nmos::id& id)
+    {
+        using web::json::value;
+        using web::json::value_of;
+
+        return{ version, nmos::types::sender, value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, U("sender") },
+            { nmos::fields::description, U("sender") },
+            { nmos::fields::flow_id, nmos::make_id() },
+            { nmos::fields::transport, U("urn:x-nmos:transport:rtp.mcast") },
+            { nmos::fields::tags, value::object() },
+            { nmos::fields::device_id, nmos::make_id() },
+            { nmos::fields::manifest_href, U("http://localhost/x-nmos/connection/v1.1/single/senders/") + id + U("/transportfile") },
+            { nmos::fields::caps, value::object() },
+            { nmos::fields::interface_bindings, value_of({ U("eth0") }) },
+            { nmos::fields::subscription, value_of({ { nmos::fields::receiver_id, value::null() }, { nmos::fields::active, false } }) }
+        }), false };
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testDowngrade)
+{
+    const auto sender = make_sender(nmos::is04_versions::v1_3, nmos::make_id());
+
+    // no sender properties were added in v1.3, so downgrading to v1.2 doesn't change the resource
+    BST_REQUIRE(nmos::details::is_unchanged_by_downgrade(sender.version, sender.downgrade_version, sender.type, sender.data, nmos::is04_versions::v1_2, nmos::is04_versions::v1_2));
+    BST_REQUIRE_EQUAL(sender.data, nmos::downgrade(sender, nmos::is04_versions::v1_2));
+
+    // but downgrading to v1.1 removes the properties added in v1.2
+    BST_REQUIRE(!nmos::details::is_unchanged_by_downgrade(sender.version, sender.downgrade_version, sender.type, sender.data, nmos::is04_versions::v1_1, nmos::is04_versions::v1_1));
+    const auto downgraded = nmos::downgrade(sender, nmos::is04_versions::v1_1);
+    BST_REQUIRE_EQUAL(sender.data.size() - 3, downgraded.size());
+    BST_REQUIRE(!downgraded.has_field(nmos::fields::caps));
+    BST_REQUIRE(!downgraded.has_field(nmos::fields::interface_bindings));
+    BST_REQUIRE(!downgraded.has_field(nmos::fields::subscription));
+    BST_REQUIRE_EQUAL(sender.data.at(nmos::fields::manifest_href), downgraded.at(nmos::fields::manifest_href));
+
+    // downgrade between major versions, or to a version below the resource's minimum, is not permitted
+    const nmos::api_version v2_0{ 2, 0 };
+    BST_REQUIRE(!nmos::details::is_unchanged_by_downgrade(sender.version, sender.downgrade_version, sender.type, sender.data, v2_0, v2_0));
+    BST_REQUIRE(nmos::downgrade(sender, v2_0).is_null());
+    auto v1_2_only = sender;
+    v1_2_only.downgrade_version = nmos::is04_versions::v1_2;
+    BST_REQUIRE(nmos::downgrade(v1_2_only, nmos::is04_versions::v1_1).is_null());
+
+    // old-versioned resources are never upgraded
+    const auto old_sender = make_sender(nmos::is04_versions::v1_1, nmos::make_id());
+    BST_REQUIRE(nmos::details::is_unchanged_by_downgrade(old_sender.version, old_sender.downgrade_version, old_sender.type, old_sender.data, nmos::is04_versions::v1_3, nmos::is04_versions::v1_1));
+    BST_REQUIRE_EQUAL(old_sender.data, nmos::downgrade(old_sender, nmos::is04_versions::v1_3, nmos::is04_versions::v1_1));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// measure downgrading v1.3 resources for v1.2 and v1.1 clients, like a registry with older controllers
+BST_TEST_CASE_PERFORMANCE(testDowngradePerformance)
+{
+    const size_t resource_count = 10000;
+    const size_t repeat_count = 10;
+
+    std::vector<nmos::resource> senders;
+    for (size_t i = 0; i < resource_count; ++i)
+    {
+        senders.push_back(make_sender(nmos::is04_versions::v1_3, nmos::make_id()));
+    }
+
+    for (const auto& version : { nmos::is04_versions::v1_2, nmos::is04_versions::v1_1 })
+    {
+        size_t size = 0;
+        const auto downgrade_start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeat_count; ++i)
+        {
+            for (const auto& sender : senders)
+            {
+                size += nmos::downgrade(sender, version).size();
+            }
+        }
+        const auto downgrade_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - downgrade_start);
+        BST_REQUIRE_EQUAL(repeat_count * resource_count * (nmos::is04_versions::v1_2 == version ? 12 : 9), size);
+
+        // serializing for a query, which can avoid copying the resource data when the downgrade would not change it
+        // (a new query each time, and a fresh cache for each resource, so that nothing is reused)
+        size_t length = 0;
+        const auto serialize_start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeat_count; ++i)
+        {
+            const nmos::resource_query match(version, U("/senders"), web::json::value::object());
+            for (auto& sender : senders)
+            {
+                sender.serialized = std::make_shared<nmos::details::serialized_cache>();
+                length += match.serialize(sender).size();
+            }
+        }
+        const auto serialize_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - serialize_start);
+        BST_REQUIRE(0 != length);
+
+        std::cout << "downgrade v1.3 senders to " << nmos::make_api_version(version) << ": " << (size_t)(repeat_count * resource_count / downgrade_elapsed.count()) << " resources/s" << std::endl;
+        std::cout << "serialize v1.3 senders for " << nmos::make_api_version(version) << " query: " << (size_t)(repeat_count * resource_count / serialize_elapsed.count()) << " resources/s" << std::endl;
+    }
+}
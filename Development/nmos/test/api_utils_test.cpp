@@ -1,7 +1,51 @@
 // The first "test" is of course whether the header compiles standalone
 #include "nmos/api_utils.h"
 
+#include <chrono>
+#include <iostream>
 #include "bst/test/test.h"
+#include "nmos/connection_api.h"
+#include "nmos/model.h"
+#include "nmos/query_api.h"
+#include "nmos/registration_api.h"
+#include "nmos/slog.h"
+
+namespace
+{
+    class nolog_gate : public slog::base_gate
+    {
+    public:
+        virtual bool pertinent(slog::severity) const { return false; }
+        virtual void log(const slog::log_message&) const {}
+    };
+
+    // routes/s for an API, each request being matched against the route table and handled
+    // the handlers themselves have little to do, since the model is empty
+    void test_api_router_performance(const std::string& name, web::http::experimental::listener::api_router& api, const std::vector<utility::string_t>& paths)
+    {
+        const size_t repeat_count = 1000;
+
+        std::vector<web::http::http_request> requests;
+        for (const auto& path : paths)
+        {
+            requests.push_back(web::http::http_request(web::http::methods::GET));
+            requests.back().set_request_uri(web::uri(U("http://host:123") + path));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeat_count; ++i)
+        {
+            for (auto& req : requests)
+            {
+                web::http::http_response res;
+                api(req, res, {}, {}).wait();
+            }
+        }
+        const auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << name << ": " << (size_t)(repeat_count * requests.size() / seconds) << " routes/s" << std::endl;
+    }
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 BST_TEST_CASE(testAddCorsPreflightHeaders)
@@ -97,3 +141,48 @@ BST_TEST_CASE(testMakeErrorResponseBody)
     }
     // successful status code perhaps ought to throw?
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testApiRouterPerformance)
+{
+    nolog_gate gate;
+    const auto id = U("/") + nmos::make_id();
+
+    {
+        nmos::registry_model model;
+        auto api = nmos::make_query_api(model, gate);
+        test_api_router_performance("Query API", api, {
+            U("/"),
+            U("/x-nmos/query/"),
+            U("/x-nmos/query/v1.3/"),
+            U("/x-nmos/query/v1.3/senders"),
+            U("/x-nmos/query/v1.3/senders") + id,
+            U("/x-nmos/query/v1.3/subscriptions") + id
+        });
+    }
+
+    {
+        nmos::registry_model model;
+        auto api = nmos::make_registration_api(model, gate);
+        test_api_router_performance("Registration API", api, {
+            U("/"),
+            U("/x-nmos/registration/"),
+            U("/x-nmos/registration/v1.3/"),
+            U("/x-nmos/registration/v1.3/health/nodes") + id,
+            U("/x-nmos/registration/v1.3/resource/nodes") + id
+        });
+    }
+
+    {
+        nmos::node_model model;
+        auto api = nmos::make_connection_api(model, gate);
+        test_api_router_performance("Connection API", api, {
+            U("/"),
+            U("/x-nmos/connection/"),
+            U("/x-nmos/connection/v1.1/single/senders/"),
+            U("/x-nmos/connection/v1.1/single/senders") + id,
+            U("/x-nmos/connection/v1.1/single/senders") + id + U("/staged"),
+            U("/x-nmos/connection/v1.1/single/receivers") + id + U("/active")
+        });
+    }
+}
@@ -2,6 +2,7 @@
 #include "nmos/capabilities.h"
 
 #include "bst/test/test.h"
+#include "nmos/json_fields.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 BST_TEST_CASE(testMatchConstraint)
@@ -56,3 +57,63 @@ BST_TEST_CASE(testMatchConstraint)
     BST_REQUIRE(nmos::match_constraint(nmos::make_rational(nmos::rates::rate29_97), nmos::make_caps_rational_constraint({ nmos::rates::rate25, nmos::rates::rate29_97, nmos::rates::rate30 })));
     BST_REQUIRE(!nmos::match_constraint(nmos::make_rational(nmos::rates::rate29_97), nmos::make_caps_rational_constraint({ nmos::rates::rate25, nmos::rates::rate30 })));
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testCompiledConstraint)
+{
+    using web::json::value;
+    using web::json::value_of;
+
+    BST_REQUIRE(nmos::compiled_constraint().match(value(U("purr"))));
+    BST_REQUIRE(nmos::compiled_constraint(nmos::make_caps_integer_constraint({})).match_integer(42));
+
+    const nmos::compiled_constraint string_constraint(nmos::make_caps_string_constraint({ U("meow"), U("purr"), U("hiss"), U("bark") }, U("^(meow|purr|hiss)$")));
+    BST_REQUIRE(string_constraint.match_string(U("purr")));
+    BST_REQUIRE(!string_constraint.match_string(U("bark")));
+    BST_REQUIRE(!string_constraint.match_string(U("moo")));
+
+    const nmos::compiled_constraint integer_constraint(nmos::make_caps_integer_constraint({ 37, 42, 57 }, 37, 42));
+    BST_REQUIRE(integer_constraint.match_integer(42));
+    BST_REQUIRE(!integer_constraint.match_integer(57));
+    BST_REQUIRE(!integer_constraint.match_integer(38));
+    for (auto i : { 37, 42, 57 })
+        BST_REQUIRE(nmos::compiled_constraint(nmos::make_caps_integer_constraint({}, 37, 57)).match_integer(i));
+    for (auto i : { -100, 0, 100 })
+        BST_REQUIRE(!nmos::compiled_constraint(nmos::make_caps_integer_constraint({}, 37, 57)).match_integer(i));
+    BST_REQUIRE(nmos::compiled_constraint(nmos::make_caps_integer_constraint({}, INT64_C(0xC0FFEE), INT64_C(0xC01DC0FFEE))).match_integer(INT64_C(0xBADC0FFEE)));
+
+    const nmos::compiled_constraint number_constraint(nmos::make_caps_number_constraint({ 3.7, 4.2, 5.7 }, 3.7, 5.7));
+    BST_REQUIRE(number_constraint.match_number(4.2));
+    BST_REQUIRE(!number_constraint.match_number(4.3));
+    for (auto d : { -10.0, 0.0, 10.0 })
+        BST_REQUIRE(!nmos::compiled_constraint(nmos::make_caps_number_constraint({}, 3.7, 5.7)).match_number(d));
+
+    const nmos::compiled_constraint boolean_constraint(nmos::make_caps_boolean_constraint({ false }));
+    BST_REQUIRE(boolean_constraint.match_boolean(false));
+    BST_REQUIRE(!boolean_constraint.match_boolean(true));
+
+    const nmos::compiled_constraint rational_constraint(nmos::make_caps_rational_constraint({ nmos::rates::rate25, nmos::rates::rate29_97, nmos::rates::rate30 }));
+    BST_REQUIRE(rational_constraint.match_rational(nmos::rates::rate29_97));
+    BST_REQUIRE(rational_constraint.match(nmos::make_rational(nmos::rates::rate29_97)));
+    BST_REQUIRE(!rational_constraint.match_rational(nmos::rates::rate59_94));
+    for (auto r : { nmos::rational{}, nmos::rates::rate23_98, nmos::rates::rate59_94 })
+        BST_REQUIRE(!nmos::compiled_constraint(nmos::make_caps_rational_constraint({}, nmos::rates::rate25, nmos::rates::rate30)).match_rational(r));
+
+    // integers and numbers are compared exactly, like JSON Schema
+    const auto mixed_enum = value_of({ { nmos::fields::constraint_enum, value_of({ 5004, 5006.0, 2.5 }) } });
+    const nmos::compiled_constraint mixed_constraint(mixed_enum);
+    BST_REQUIRE(mixed_constraint.match(value(5004)));
+    BST_REQUIRE(mixed_constraint.match(value(5004.0)));
+    BST_REQUIRE(mixed_constraint.match(value(5006)));
+    BST_REQUIRE(!mixed_constraint.match(value(2)));
+    BST_REQUIRE(!mixed_constraint.match(value::null()));
+
+    const auto fractional_minimum = value_of({ { nmos::fields::constraint_minimum, 2.5 } });
+    BST_REQUIRE(!nmos::compiled_constraint(fractional_minimum).match(value(2)));
+    BST_REQUIRE(nmos::compiled_constraint(fractional_minimum).match(value(3)));
+
+    // values of other types only have to match the enum values
+    const auto null_enum = value_of({ { nmos::fields::constraint_enum, value_of({ U("auto"), value::null() }) }, { nmos::fields::constraint_pattern, U("^auto$") } });
+    BST_REQUIRE(nmos::compiled_constraint(null_enum).match(value::null()));
+    BST_REQUIRE(nmos::compiled_constraint(nmos::make_caps_integer_constraint({}, 37, 57)).match(value::null()));
+}
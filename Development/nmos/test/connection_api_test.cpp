@@ -0,0 +1,290 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/connection_api.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "bst/test/test.h"
+#include "nmos/connection_resources.h"
+#include "nmos/json_fields.h"
+#include "nmos/model.h"
+#include "nmos/node_resources.h"
+#include "nmos/slog.h"
+#include "nmos/transport.h"
+
+namespace
+{
+    nmos::resource make_rtp_sender(const web::json::value& leg_constraints, const nmos::id& id = nmos::make_id())
+    {
+        auto sender = nmos::make_connection_rtp_sender(id, false);
+        sender.data[nmos::fields::endpoint_constraints] = web::json::value_from_elements(std::vector<web::json::value>{ leg_constraints });
+        return sender;
+    }
+
+    web::json::value make_staged(const web::json::value& leg_params)
+    {
+        return web::json::value_of({
+            { nmos::fields::transport_params, web::json::value_from_elements(std::vector<web::json::value>{ leg_params }) }
+        });
+    }
+
+    std::shared_ptr<const nmos::details::compiled_connection_constraints> compile_constraints(const nmos::resource& connection_resource)
+    {
+        nmos::node_model model;
+        nmos::details::compiled_connection_constraints_table table;
+        return nmos::details::get_compiled_connection_constraints(table, model, connection_resource, nmos::transports::rtp);
+    }
+
+    void validate_staged(const nmos::resource& connection_resource, const web::json::value& leg_params)
+    {
+        nmos::details::validate_staged_constraints(*compile_constraints(connection_resource), make_staged(leg_params));
+    }
+
+    class nolog_gate : public slog::base_gate
+    {
+    public:
+        virtual bool pertinent(slog::severity) const { return false; }
+        virtual void log(const slog::log_message&) const {}
+    };
+
+    // insert the specified number of RTP senders, both the IS-04 and IS-05 resources, with constrained destination ports
+    std::vector<nmos::id> insert_rtp_senders(nmos::node_model& model, std::size_t count)
+    {
+        using web::json::value_of;
+
+        std::vector<nmos::id> ids;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto id = nmos::make_id();
+            nmos::insert_resource(model.node_resources, nmos::make_sender(id, nmos::make_id(), nmos::transports::rtp_mcast, nmos::make_id(), {}, { U("eth0") }, model.settings));
+            nmos::insert_resource(model.connection_resources, make_rtp_sender(value_of({
+                { nmos::fields::destination_port, value_of({ { U("minimum"), 5000 }, { U("maximum"), 5999 } }) }
+            }), id));
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    // POST the specified array of patches to the Connection API /bulk/senders endpoint and return the array of results
+    web::json::value post_bulk_senders(web::http::experimental::listener::api_router& api, const web::json::value& patches)
+    {
+        web::http::http_request req(web::http::methods::POST);
+        req.set_request_uri(web::uri(U("http://host:123/x-nmos/connection/v1.1/bulk/senders")));
+        req.set_body(patches);
+        web::http::http_response res;
+        api(req, res, {}, {}).wait();
+        BST_REQUIRE_EQUAL(web::http::status_codes::OK, res.status_code());
+        return res.extract_json().get();
+    }
+
+    web::json::value make_bulk_patch(const nmos::id& id, int destination_port)
+    {
+        using web::json::value_of;
+
+        return value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::params, make_staged(value_of({ { nmos::fields::destination_port, destination_port } })) }
+        });
+    }
+
+    int get_staged_destination_port(const nmos::node_model& model, const nmos::id& id)
+    {
+        const auto resource = nmos::find_resource(model.connection_resources, { id, nmos::types::sender });
+        BST_REQUIRE(model.connection_resources.end() != resource);
+        const auto& staged = nmos::fields::endpoint_staged(resource->data);
+        const auto& destination_port = nmos::fields::transport_params(staged).at(0).at(nmos::fields::destination_port);
+        return destination_port.is_integer() ? destination_port.as_integer() : -1;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testValidateStagedConstraints)
+{
+    using web::json::value_of;
+
+    const auto sender = make_rtp_sender(value_of({
+        { nmos::fields::destination_port, value_of({ { U("minimum"), 5000 }, { U("maximum"), 5999 } }) },
+        { nmos::fields::destination_ip, value_of({ { U("enum"), value_of({ U("232.1.1.1"), U("232.1.1.2") }) } }) },
+        { nmos::fields::source_ip, value_of({ { U("pattern"), U("^192\\.168\\.") } }) },
+        { nmos::fields::rtp_enabled, value_of({ { U("enum"), value_of({ true }) } }) }
+    }));
+
+    // values which satisfy the constraints
+    validate_staged(sender, value_of({ { nmos::fields::destination_port, 5004 } }));
+    validate_staged(sender, value_of({ { nmos::fields::destination_ip, U("232.1.1.2") } }));
+    validate_staged(sender, value_of({ { nmos::fields::source_ip, U("192.168.0.1") } }));
+    validate_staged(sender, value_of({ { nmos::fields::rtp_enabled, true } }));
+
+    // values which don't
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::destination_port, 6000 } })), web::json::json_exception);
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::destination_ip, U("232.1.1.3") } })), web::json::json_exception);
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::source_ip, U("10.0.0.1") } })), web::json::json_exception);
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::rtp_enabled, false } })), web::json::json_exception);
+
+    // "auto" is permitted for the transport parameters that support it, whatever the constraints
+    validate_staged(sender, value_of({ { nmos::fields::destination_port, U("auto") } }));
+    validate_staged(sender, value_of({ { nmos::fields::destination_ip, U("auto") } }));
+    validate_staged(sender, value_of({ { nmos::fields::source_ip, U("auto") } }));
+
+    // but not for others
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::rtp_enabled, U("auto") } })), web::json::json_exception);
+
+    // unconstrained transport parameters, and an absent transport_params, are not validated here
+    validate_staged(sender, value_of({ { nmos::fields::source_port, 1 } }));
+    nmos::details::validate_staged_constraints(*compile_constraints(sender), web::json::value::object());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testValidateStagedConstraintsValidatorFallback)
+{
+    using web::json::value_of;
+
+    // "multipleOf" isn't one of the constraint keywords defined by IS-05, so these constraints are validated as a JSON Schema
+    const auto sender = make_rtp_sender(value_of({
+        { nmos::fields::destination_port, value_of({ { U("multipleOf"), 2 } }) },
+        { nmos::fields::rtp_enabled, value_of({ { U("enum"), value_of({ true }) } }) }
+    }));
+
+    validate_staged(sender, value_of({ { nmos::fields::destination_port, 5004 } }));
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::destination_port, 5005 } })), web::json::json_exception);
+
+    validate_staged(sender, value_of({ { nmos::fields::destination_port, U("auto") } }));
+    BST_REQUIRE_THROW(validate_staged(sender, value_of({ { nmos::fields::rtp_enabled, U("auto") } })), web::json::json_exception);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testCompiledConnectionConstraintsTable)
+{
+    using web::json::value_of;
+
+    nmos::node_model model;
+    nmos::details::compiled_connection_constraints_table table;
+
+    const auto id = nmos::make_id();
+    nmos::insert_resource(model.connection_resources, make_rtp_sender(value_of({
+        { nmos::fields::destination_port, value_of({ { U("minimum"), 5000 }, { U("maximum"), 5999 } }) }
+    }), id));
+
+    const auto get_compiled = [&](const nmos::transport& transport_base) -> std::shared_ptr<const nmos::details::compiled_connection_constraints>
+    {
+        const auto resource = nmos::find_resource(model.connection_resources, id);
+        BST_REQUIRE(model.connection_resources.end() != resource);
+        return nmos::details::get_compiled_connection_constraints(table, model, *resource, transport_base);
+    };
+
+    // the constraints are only compiled once
+    const auto compiled = get_compiled(nmos::transports::rtp);
+    BST_REQUIRE(compiled == get_compiled(nmos::transports::rtp));
+
+    // but they are recompiled when the resource is updated
+    nmos::modify_resource(model.connection_resources, id, [](nmos::resource& resource)
+    {
+        resource.data[nmos::fields::endpoint_constraints] = web::json::value_from_elements(std::vector<web::json::value>{ value_of({
+            { nmos::fields::destination_port, value_of({ { U("minimum"), 6000 }, { U("maximum"), 6999 } }) }
+        }) });
+    });
+    const auto recompiled = get_compiled(nmos::transports::rtp);
+    BST_REQUIRE(compiled != recompiled);
+    BST_REQUIRE(recompiled == get_compiled(nmos::transports::rtp));
+
+    nmos::details::validate_staged_constraints(*recompiled, make_staged(value_of({ { nmos::fields::destination_port, 6000 } })));
+    BST_REQUIRE_THROW(nmos::details::validate_staged_constraints(*recompiled, make_staged(value_of({ { nmos::fields::destination_port, 5004 } }))), web::json::json_exception);
+
+    // or when the transport changes, since that determines which transport parameters support "auto"
+    BST_REQUIRE(recompiled != get_compiled(nmos::transports::websocket));
+    BST_REQUIRE_EQUAL(1, table.compiled.size());
+
+    // the entries of deleted resources are removed when another entry is added
+    nmos::erase_resource(model.connection_resources, id);
+    const auto other = make_rtp_sender(value_of({
+        { nmos::fields::destination_port, value_of({ { U("minimum"), 5000 }, { U("maximum"), 5999 } }) }
+    }));
+    nmos::details::get_compiled_connection_constraints(table, model, other, nmos::transports::rtp);
+    BST_REQUIRE_EQUAL(1, table.compiled.size());
+    BST_REQUIRE(table.compiled.end() != table.compiled.find(other.id));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testBulkSendersPatch)
+{
+    nolog_gate gate;
+    nmos::node_model model;
+    model.settings = web::json::value::object();
+
+    const std::size_t sender_count = 8;
+    const auto ids = insert_rtp_senders(model, sender_count);
+
+    // record the calls of the connection_resource_patch_validator callback
+    std::mutex mutex;
+    std::vector<nmos::id> validated;
+    std::atomic<int> calls_in_progress{ 0 };
+    int max_calls_in_progress = 0;
+    const auto validate_merged = [&](const nmos::resource& resource, const nmos::resource&, const web::json::value&, slog::base_gate&)
+    {
+        const int in_progress = ++calls_in_progress;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            validated.push_back(resource.id);
+            max_calls_in_progress = (std::max)(max_calls_in_progress, in_progress);
+        }
+        --calls_in_progress;
+    };
+
+    auto api = nmos::make_connection_api(model, &nmos::parse_rtp_transport_file, validate_merged, gate);
+
+    // one of the patches doesn't satisfy the constraints
+    const std::size_t invalid_index = 3;
+    auto patches = web::json::value::array();
+    for (std::size_t i = 0; i < sender_count; ++i)
+    {
+        web::json::push_back(patches, make_bulk_patch(ids[i], invalid_index == i ? 6000 : 5000 + (int)i));
+    }
+
+    const auto results = post_bulk_senders(api, patches);
+
+    // the results are in the order of the patches
+    BST_REQUIRE_EQUAL(sender_count, results.size());
+    for (std::size_t i = 0; i < sender_count; ++i)
+    {
+        BST_REQUIRE_EQUAL(ids[i], nmos::fields::id(results.at(i)));
+        BST_REQUIRE_EQUAL(invalid_index == i ? 400 : 200, results.at(i).at(U("code")).as_integer());
+    }
+
+    // and only the valid patches have been applied
+    for (std::size_t i = 0; i < sender_count; ++i)
+    {
+        BST_REQUIRE_EQUAL(invalid_index == i ? -1 : 5000 + (int)i, get_staged_destination_port(model, ids[i]));
+    }
+
+    // by default, the callback is called one patch at a time, in order, and only for those which satisfy the constraints
+    auto expected = ids;
+    expected.erase(expected.begin() + invalid_index);
+    BST_REQUIRE(expected == validated);
+    BST_REQUIRE_EQUAL(1, max_calls_in_progress);
+
+    // concurrent calls must be enabled explicitly, and are then limited as configured
+    model.settings[nmos::experimental::fields::connection_api_bulk_concurrency] = web::json::value::number(4);
+    validated.clear();
+    max_calls_in_progress = 0;
+
+    patches = web::json::value::array();
+    for (std::size_t i = 0; i < sender_count; ++i)
+    {
+        web::json::push_back(patches, make_bulk_patch(ids[i], 5500 + (int)i));
+    }
+
+    const auto concurrent_results = post_bulk_senders(api, patches);
+
+    BST_REQUIRE_EQUAL(sender_count, concurrent_results.size());
+    for (std::size_t i = 0; i < sender_count; ++i)
+    {
+        BST_REQUIRE_EQUAL(ids[i], nmos::fields::id(concurrent_results.at(i)));
+        BST_REQUIRE_EQUAL(200, concurrent_results.at(i).at(U("code")).as_integer());
+        BST_REQUIRE_EQUAL(5500 + (int)i, get_staged_destination_port(model, ids[i]));
+    }
+    BST_REQUIRE_EQUAL(sender_count, validated.size());
+    BST_REQUIRE(4 >= max_calls_in_progress);
+}
@@ -0,0 +1,39 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/connection_events_activation.h"
+
+#include "bst/test/test.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testEventsWsReceiverRoutes)
+{
+    using nmos::experimental::erase_events_ws_receiver_route;
+    using nmos::experimental::insert_events_ws_receiver_route;
+
+    nmos::experimental::events_ws_receiver_routes routes;
+
+    const utility::string_t connection_uri{ U("ws://api.example.com/x-nmos/events/v1.0/") };
+    const nmos::id source_id{ U("a7ba0cd2-c1ba-4ee3-a4c5-d5cdc3ab5c77") };
+    const nmos::id other_source_id{ U("f1ba4f0b-6f2b-4b48-b5b1-5c3b1e5aa8c4") };
+    const nmos::experimental::events_ws_receiver_routes::route route{ connection_uri, source_id };
+    const nmos::experimental::events_ws_receiver_routes::route other_route{ connection_uri, other_source_id };
+    const nmos::id receiver_id{ U("c2a3c4b1-7ad0-4c5b-9b1e-2d2f1b3b5a31") };
+    const nmos::id other_receiver_id{ U("d5b4e1a2-3c1f-4a6b-8e2d-7f9a0b1c2d3e") };
+
+    insert_events_ws_receiver_route(routes, receiver_id, connection_uri, source_id);
+    insert_events_ws_receiver_route(routes, other_receiver_id, connection_uri, source_id);
+    BST_REQUIRE_EQUAL(1, routes.receivers.size());
+    BST_REQUIRE_EQUAL(2, routes.receivers[route].size());
+
+    // re-activating a receiver with a different source id moves its route
+    insert_events_ws_receiver_route(routes, other_receiver_id, connection_uri, other_source_id);
+    BST_REQUIRE_EQUAL(2, routes.receivers.size());
+    BST_REQUIRE_EQUAL(1, routes.receivers[route].count(receiver_id));
+    BST_REQUIRE_EQUAL(1, routes.receivers[other_route].count(other_receiver_id));
+
+    // deactivating the receivers removes their routes entirely
+    erase_events_ws_receiver_route(routes, receiver_id);
+    erase_events_ws_receiver_route(routes, other_receiver_id);
+    erase_events_ws_receiver_route(routes, other_receiver_id);
+    BST_REQUIRE(routes.receivers.empty());
+    BST_REQUIRE(routes.routes.empty());
+}
@@ -0,0 +1,108 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/events_ws_api.h"
+
+#include "bst/test/test.h"
+#include "nmos/query_utils.h"
+#include "nmos/resource.h"
+
+namespace
+{
+    // like the state event inserted into the grain by nmos::insert_resource_events when a source is modified
+    web::json::value make_state_event(const nmos::id& source_id, double value, const web::json::value& max_update_rate_ms = {})
+    {
+        auto source = nmos::make_events_source(source_id, nmos::make_events_number_state({ source_id }, value), nmos::make_events_number_type(-1000.0, 1000.0));
+        if (!max_update_rate_ms.is_null()) source.data[nmos::fields::max_update_rate_ms] = max_update_rate_ms;
+        return nmos::details::make_resource_event(U("/sources"), nmos::types::source, source.data, source.data);
+    }
+
+    double get_state_value(const web::json::value& message)
+    {
+        return message.at(U("payload")).at(U("value")).as_double();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testPrepareEventsWsMessages)
+{
+    using web::json::value;
+    using nmos::details::prepare_events_ws_messages;
+
+    const nmos::id source_id{ U("a7ba0cd2-c1ba-4ee3-a4c5-d5cdc3ab5c77") };
+    const nmos::id other_source_id{ U("f1ba4f0b-6f2b-4b48-b5b1-5c3b1e5aa8c4") };
+    const nmos::tai_clock::time_point now = nmos::tai_clock::now();
+    const auto never = (nmos::tai_clock::time_point::max)();
+
+    // with no minimum interval, every state message is sent, in order
+    {
+        auto events = value::array();
+        web::json::push_back(events, make_state_event(source_id, 1.0));
+        web::json::push_back(events, make_state_event(source_id, 2.0));
+        web::json::push_back(events, nmos::make_events_health_message({}));
+
+        std::vector<value> messages;
+        nmos::details::events_ws_sent_states sent_states;
+        BST_REQUIRE(never == prepare_events_ws_messages(messages, events, sent_states, std::chrono::milliseconds::zero(), now));
+        BST_REQUIRE_EQUAL(3, messages.size());
+        BST_REQUIRE_EQUAL(1.0, get_state_value(messages[0]));
+        BST_REQUIRE_EQUAL(2.0, get_state_value(messages[1]));
+        BST_REQUIRE_EQUAL(0, events.size());
+    }
+
+    // with a minimum interval, a burst of changes to each source is coalesced to the latest state
+    {
+        const auto interval = std::chrono::milliseconds(100);
+
+        auto events = value::array();
+        for (int i = 0; i < 1000; ++i)
+        {
+            web::json::push_back(events, make_state_event(source_id, i));
+            web::json::push_back(events, make_state_event(other_source_id, -i));
+        }
+        web::json::push_back(events, nmos::make_events_health_message({}));
+
+        std::vector<value> messages;
+        nmos::details::events_ws_sent_states sent_states;
+        BST_REQUIRE(never == prepare_events_ws_messages(messages, events, sent_states, interval, now));
+        BST_REQUIRE_EQUAL(3, messages.size());
+        // health messages are not delayed
+        BST_REQUIRE_EQUAL(U("health"), messages[0].at(U("message_type")).as_string());
+        BST_REQUIRE_EQUAL(999.0, get_state_value(messages[1]));
+        BST_REQUIRE_EQUAL(-999.0, get_state_value(messages[2]));
+        BST_REQUIRE_EQUAL(0, events.size());
+
+        // further changes within the interval are delayed until the interval has passed, and still coalesced
+        messages.clear();
+        web::json::push_back(events, make_state_event(source_id, 1000.0));
+        web::json::push_back(events, make_state_event(source_id, 1001.0));
+        const auto later = now + interval / 2;
+        BST_REQUIRE(now + interval == prepare_events_ws_messages(messages, events, sent_states, interval, later));
+        BST_REQUIRE(messages.empty());
+        BST_REQUIRE_EQUAL(1, events.size());
+
+        web::json::push_back(events, make_state_event(source_id, 1002.0));
+        BST_REQUIRE(never == prepare_events_ws_messages(messages, events, sent_states, interval, now + interval));
+        BST_REQUIRE_EQUAL(1, messages.size());
+        BST_REQUIRE_EQUAL(1002.0, get_state_value(messages[0]));
+        BST_REQUIRE_EQUAL(0, events.size());
+    }
+
+    // a source may override the subscription's minimum interval
+    {
+        auto events = value::array();
+        web::json::push_back(events, make_state_event(source_id, 1.0, value::number(0)));
+        web::json::push_back(events, make_state_event(source_id, 2.0, value::number(0)));
+        web::json::push_back(events, make_state_event(other_source_id, 1.0, value::number(100)));
+        web::json::push_back(events, make_state_event(other_source_id, 2.0, value::number(100)));
+
+        std::vector<value> messages;
+        nmos::details::events_ws_sent_states sent_states;
+        BST_REQUIRE(never == prepare_events_ws_messages(messages, events, sent_states, std::chrono::milliseconds(1000), now));
+        BST_REQUIRE_EQUAL(3, messages.size());
+        BST_REQUIRE_EQUAL(2.0, get_state_value(messages[2]));
+
+        web::json::push_back(events, make_state_event(other_source_id, 3.0, value::number(100)));
+        messages.clear();
+        BST_REQUIRE(now + std::chrono::milliseconds(100) == prepare_events_ws_messages(messages, events, sent_states, std::chrono::milliseconds(1000), now));
+        BST_REQUIRE(messages.empty());
+    }
+}
@@ -1,9 +1,14 @@
 // The first "test" is of course whether the header compiles standalone
 #include "cpprest/json_validator.h"
 
+#include <chrono>
+#include <iostream>
 #include "bst/test/test.h"
 #include "cpprest/basic_utils.h" // for utility::us2s, utility::s2us
 #include "cpprest/json_utils.h"
+#include "nmos/id.h"
+#include "nmos/is04_versions.h"
+#include "nmos/json_schema.h"
 
 namespace
 {
@@ -86,3 +91,109 @@ BST_TEST_CASE(testEnumSchema)
     validator.validate(value_of({ { U("foo"), U("good") } }), id);
     BST_REQUIRE(true);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testNumberTypes)
+{
+    using web::json::value_of;
+
+    const auto schema = value_of({
+        { U("$schema"), U("http://json-schema.org/draft-04/schema#")},
+        { U("type"), U("object")},
+        { U("properties"), value_of({
+            { U("foo"), value_of({
+                { U("type"), U("integer") },
+                { U("minimum"), -1 }
+            }) },
+            { U("bar"), value_of({
+                { U("type"), U("number") }
+            }) },
+            { U("baz"), value_of({
+                { U("enum"), value_of({ 0, 42 }) }
+            }) }
+        }) }
+    });
+
+    auto validator = make_validator(schema, id);
+
+    validator.validate(value_of({ { U("foo"), 1 } }), id);
+    validator.validate(value_of({ { U("foo"), -1 } }), id);
+    // a double with an integral value is still an integer
+    validator.validate(value_of({ { U("foo"), 1.0 } }), id);
+    BST_REQUIRE_THROW(validator.validate(value_of({ { U("foo"), 1.5 } }), id), web::json::json_exception);
+    BST_REQUIRE_THROW(validator.validate(value_of({ { U("foo"), -2 } }), id), web::json::json_exception);
+    BST_REQUIRE_THROW(validator.validate(value_of({ { U("foo"), U("1") } }), id), web::json::json_exception);
+
+    validator.validate(value_of({ { U("bar"), 1.5 } }), id);
+    validator.validate(value_of({ { U("bar"), 42 } }), id);
+    validator.validate(value_of({ { U("bar"), -42 } }), id);
+
+    validator.validate(value_of({ { U("baz"), 42 } }), id);
+    validator.validate(value_of({ { U("baz"), 42.0 } }), id);
+    BST_REQUIRE_THROW(validator.validate(value_of({ { U("baz"), 42.5 } }), id), web::json::json_exception);
+    BST_REQUIRE_THROW(validator.validate(value_of({ { U("baz"), -42 } }), id), web::json::json_exception);
+    BST_REQUIRE(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testValidatePerformance)
+{
+    using web::json::value;
+    using web::json::value_of;
+
+    // validations/s of a typical Registration API request
+    const auto version = nmos::is04_versions::v1_3;
+    const auto schema_id = nmos::experimental::make_registrationapi_resource_post_request_schema_uri(version);
+    const web::json::experimental::json_validator validator{ nmos::experimental::load_json_schema, { schema_id } };
+
+    auto senders = value::array();
+    auto receivers = value::array();
+    for (int i = 0; i < 8; ++i)
+    {
+        web::json::push_back(senders, value::string(nmos::make_id()));
+        web::json::push_back(receivers, value::string(nmos::make_id()));
+    }
+
+    const auto body = value_of({
+        { U("type"), U("device") },
+        { U("data"), value_of({
+            { U("id"), nmos::make_id() },
+            { U("version"), U("1234567890:0") },
+            { U("label"), U("device") },
+            { U("description"), U("a device with some senders and receivers") },
+            { U("tags"), value_of({ { U("urn:x-nmos:tag:grouphint/v1.0"), value_of({ U("group:member") }) } }) },
+            { U("type"), U("urn:x-nmos:device:generic") },
+            { U("node_id"), nmos::make_id() },
+            { U("senders"), senders },
+            { U("receivers"), receivers },
+            { U("controls"), value_of({
+                value_of({
+                    { U("href"), U("http://127.0.0.1:3215/x-nmos/connection/v1.1") },
+                    { U("type"), U("urn:x-nmos:control:sr-ctrl/v1.1") }
+                })
+            }) }
+        }) }
+    });
+
+    const size_t validation_count = 1000;
+
+    const auto measure = [&]
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < validation_count; ++i)
+        {
+            validator.validate(body, schema_id);
+        }
+        return std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start);
+    };
+
+    // for comparison, the previous implementation serialized every instance and parsed the result
+    web::json::experimental::details::set_json_validator_serialize_and_parse(true);
+    const auto serialize_and_parse_elapsed = measure();
+    web::json::experimental::details::set_json_validator_serialize_and_parse(false);
+
+    const auto elapsed = measure();
+
+    std::cout << "json_validator with serialize and parse: " << (size_t)(validation_count / serialize_and_parse_elapsed.count()) << " validations/s" << std::endl;
+    std::cout << "json_validator: " << (size_t)(validation_count / elapsed.count()) << " validations/s" << std::endl;
+}
@@ -0,0 +1,119 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/model.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <boost/range/distance.hpp>
+#include "bst/test/test.h"
+#include "cpprest/basic_utils.h" // for utility::ostringstreamed
+#include "nmos/is04_versions.h"
+#include "nmos/query_utils.h"
+
+namespace
+{
+    const auto version = nmos::is04_versions::v1_3;
+
+    nmos::resource make_resource(const nmos::type& type, const nmos::id& id, const nmos::id& super_id)
+    {
+        using web::json::value_of;
+
+        return{ version, type, value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, type.name },
+            { nmos::fields::node_id, super_id }
+        }), false };
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testRegistryModelContentionPerformance)
+{
+    using web::json::value_of;
+
+    // registrations/s and queries/s with N writer threads, each updating the devices of its own nodes,
+    // like the Registration API, and M reader threads, each getting a page of devices, like the Query API
+    // all contending on the single registry model mutex
+    const size_t node_count = 1000;
+    const size_t devices_per_node = 4;
+    const auto duration = std::chrono::milliseconds(250);
+
+    for (size_t writer_count : { 1, 2, 4 })
+    {
+        for (size_t reader_count : { 0, 1, 4 })
+        {
+            nmos::registry_model model;
+
+            std::vector<nmos::id> device_ids;
+            for (size_t i = 0; i < node_count; ++i)
+            {
+                const auto node_id = nmos::make_id();
+                insert_resource(model.registry_resources, make_resource(nmos::types::node, node_id, {}));
+                for (size_t j = 0; j < devices_per_node; ++j)
+                {
+                    device_ids.push_back(nmos::make_id());
+                    insert_resource(model.registry_resources, make_resource(nmos::types::device, device_ids.back(), node_id));
+                }
+            }
+
+            std::atomic<bool> stop{ false };
+            std::atomic<size_t> write_count{ 0 }, read_count{ 0 }, short_page_count{ 0 };
+
+            std::vector<std::thread> threads;
+            for (size_t w = 0; w < writer_count; ++w)
+            {
+                threads.emplace_back([&, w]
+                {
+                    // each writer owns a distinct subset of the nodes, and updates each of their devices in turn
+                    // (the devices of each node are contiguous in device_ids)
+                    size_t count = 0;
+                    for (size_t n = w; !stop; n = n + writer_count < node_count ? n + writer_count : w)
+                    {
+                        for (size_t j = 0; j < devices_per_node && !stop; ++j, ++count)
+                        {
+                            auto lock = model.write_lock();
+                            modify_resource(model.registry_resources, device_ids[n * devices_per_node + j], [&count](nmos::resource& device)
+                            {
+                                device.data[nmos::fields::label] = web::json::value::string(U("device ") + utility::ostringstreamed(count));
+                            });
+                            model.notify();
+                        }
+                    }
+                    write_count += count;
+                });
+            }
+            for (size_t r = 0; r < reader_count; ++r)
+            {
+                threads.emplace_back([&]
+                {
+                    const auto query_params = value_of({ { U("paging.limit"), 10 } });
+                    size_t count = 0;
+                    for (; !stop; ++count)
+                    {
+                        auto lock = model.read_lock();
+                        const auto& resources = model.registry_resources;
+                        const nmos::resource_query match(version, U("/devices"), web::json::value::object(), resources);
+                        nmos::resource_paging paging(query_params);
+                        const auto page = paging.page(resources, match.type, [&match, &resources](const nmos::resource& resource) { return match(resource, resources); });
+                        if (10 != boost::distance(page)) ++short_page_count;
+                    }
+                    read_count += count;
+                });
+            }
+
+            std::this_thread::sleep_for(duration);
+            stop = true;
+            for (auto& thread : threads) thread.join();
+
+            const auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+            std::cout << writer_count << " writers, " << reader_count << " readers: "
+                << (size_t)(write_count / seconds) << " registrations/s, "
+                << (size_t)(read_count / seconds) << " queries/s" << std::endl;
+
+            BST_REQUIRE(0 != write_count);
+            BST_REQUIRE_EQUAL(0, short_page_count.load());
+        }
+    }
+}
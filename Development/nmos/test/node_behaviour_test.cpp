@@ -0,0 +1,44 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/node_behaviour.h"
+
+#include "bst/test/test.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testIsDependentRequest)
+{
+    using nmos::details::is_dependent_request;
+
+    // a node has no super-resource
+    const std::pair<nmos::id, nmos::type> no_super{};
+
+    const std::pair<nmos::id, nmos::type> node{ U("node"), nmos::types::node };
+    const std::pair<nmos::id, nmos::type> device{ U("device"), nmos::types::device };
+    const std::pair<nmos::id, nmos::type> other_device{ U("other_device"), nmos::types::device };
+    const std::pair<nmos::id, nmos::type> source{ U("source"), nmos::types::source };
+    const std::pair<nmos::id, nmos::type> other_source{ U("other_source"), nmos::types::source };
+
+    // requests for the same resource are dependent
+    BST_REQUIRE(is_dependent_request(node, no_super, node, no_super));
+    BST_REQUIRE(is_dependent_request(source, device, source, device));
+
+    // a request for a sub-resource depends on an in-flight request for its super-resource
+    BST_REQUIRE(is_dependent_request(node, no_super, device, node));
+    BST_REQUIRE(is_dependent_request(device, node, source, device));
+
+    // and a request for a super-resource depends on an in-flight request for one of its sub-resources
+    BST_REQUIRE(is_dependent_request(device, node, node, no_super));
+    BST_REQUIRE(is_dependent_request(source, device, device, node));
+
+    // requests for sibling resources are independent
+    BST_REQUIRE(!is_dependent_request(device, node, other_device, node));
+    BST_REQUIRE(!is_dependent_request(source, device, other_source, device));
+
+    // as are requests for unrelated resources, including ones that are only indirectly related
+    BST_REQUIRE(!is_dependent_request(source, device, other_device, node));
+    BST_REQUIRE(!is_dependent_request(node, no_super, source, device));
+    BST_REQUIRE(!is_dependent_request(source, device, node, no_super));
+
+    // in particular, resources that have no super-resource are not related to one another by that
+    const std::pair<nmos::id, nmos::type> other_node{ U("other_node"), nmos::types::node };
+    BST_REQUIRE(!is_dependent_request(node, no_super, other_node, no_super));
+}
@@ -0,0 +1,696 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/query_utils.h"
+
+#include <chrono>
+#include <iostream>
+#include "bst/test/test.h"
+#include "cpprest/basic_utils.h" // for utility::ostringstreamed
+#include "nmos/is04_versions.h"
+
+namespace
+{
+    const auto version = nmos::is04_versions::v1_3;
+
+    nmos::resource make_sender(const nmos::id& id, const nmos::id& device_id, const utility::string_t& label)
+    {
+        using web::json::value_of;
+
+        return{ version, nmos::types::sender, value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, label },
+            { nmos::fields::device_id, device_id }
+        }), false };
+    }
+
+    // insert a subscription and a grain for one websocket connection to it
+    nmos::id insert_subscription(nmos::resources& resources, const utility::string_t& resource_path, const web::json::value& params)
+    {
+        using web::json::value_of;
+
+        const auto subscription_id = nmos::make_id();
+        nmos::resource subscription{ version, nmos::types::subscription, value_of({
+            { nmos::fields::id, subscription_id },
+            { nmos::fields::max_update_rate_ms, 100 },
+            { nmos::fields::persist, true },
+            { nmos::fields::resource_path, resource_path },
+            { nmos::fields::params, params },
+            { nmos::fields::ws_href, U("ws://localhost/x-nmos/query/v1.3/subscriptions/") + subscription_id }
+        }), true };
+        insert_resource(resources, std::move(subscription));
+
+        const auto grain_id = nmos::make_id();
+        nmos::resource grain{ version, nmos::types::grain, value_of({
+            { nmos::fields::id, grain_id },
+            { nmos::fields::subscription_id, subscription_id },
+            { nmos::fields::message, nmos::details::make_grain(nmos::make_id(), subscription_id, resource_path + U('/')) }
+        }), true };
+        insert_resource(resources, std::move(grain));
+
+        return grain_id;
+    }
+
+    // make a minimal resource of the specified type, with enough data to identify its super-resource
+    nmos::resource make_resource(const nmos::type& type, const nmos::id& id, const nmos::id& super_id)
+    {
+        using web::json::value_of;
+
+        return{ version, type, value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, type.name },
+            { nmos::fields::node_id, super_id },
+            { nmos::fields::device_id, super_id }
+        }), false };
+    }
+
+    struct resource_query_predicate
+    {
+        const nmos::resource_query* rq;
+        const nmos::resources* rs;
+        bool operator()(const nmos::resource& r) const { return (*rq)(r, *rs); }
+    };
+
+    std::vector<nmos::id> page_ids(boost::any_range<const nmos::resource, boost::bidirectional_traversal_tag, const nmos::resource&, std::ptrdiff_t> page)
+    {
+        std::vector<nmos::id> ids;
+        for (const auto& resource : page) ids.push_back(resource.id);
+        return ids;
+    }
+
+    size_t count_grain_events(const nmos::resources& resources, const nmos::id& grain_id)
+    {
+        return nmos::fields::message_grain_data(nmos::find_resource(resources, grain_id)->data).size();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testInsertResourceEvents)
+{
+    using web::json::value_of;
+
+    nmos::resources resources;
+
+    const auto device_id = nmos::make_id();
+    const auto all_senders = insert_subscription(resources, U("/senders"), web::json::value::object());
+    const auto this_device = insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), device_id } }));
+    const auto other_device = insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), nmos::make_id() } }));
+    const auto rql_label = insert_subscription(resources, U("/senders"), value_of({ { U("query.rql"), U("eq(label,meow)") } }));
+    const auto all_receivers = insert_subscription(resources, U("/receivers"), web::json::value::object());
+    const auto all_resources = insert_subscription(resources, U(""), web::json::value::object());
+
+    const auto sender_id = nmos::make_id();
+    insert_resource(resources, make_sender(sender_id, device_id, U("purr")));
+
+    BST_REQUIRE_EQUAL(1, count_grain_events(resources, all_senders));
+    BST_REQUIRE_EQUAL(1, count_grain_events(resources, this_device));
+    BST_REQUIRE_EQUAL(0, count_grain_events(resources, other_device));
+    BST_REQUIRE_EQUAL(0, count_grain_events(resources, rql_label));
+    BST_REQUIRE_EQUAL(0, count_grain_events(resources, all_receivers));
+    BST_REQUIRE_EQUAL(1, count_grain_events(resources, all_resources));
+
+    modify_resource(resources, sender_id, [](nmos::resource& sender)
+    {
+        sender.data[nmos::fields::label] = web::json::value::string(U("meow"));
+    });
+
+    BST_REQUIRE_EQUAL(2, count_grain_events(resources, all_senders));
+    BST_REQUIRE_EQUAL(2, count_grain_events(resources, this_device));
+    BST_REQUIRE_EQUAL(0, count_grain_events(resources, other_device));
+    BST_REQUIRE_EQUAL(1, count_grain_events(resources, rql_label));
+    BST_REQUIRE_EQUAL(0, count_grain_events(resources, all_receivers));
+    BST_REQUIRE_EQUAL(2, count_grain_events(resources, all_resources));
+
+    // each subscription query has been made once, and is reused
+    auto& by_type = resources.get<nmos::tags::type>();
+    const auto subscriptions = by_type.equal_range(nmos::details::has_data(nmos::types::subscription));
+    for (auto it = subscriptions.first; subscriptions.second != it; ++it)
+    {
+        BST_REQUIRE(!!it->subscription_query);
+    }
+}
+
+namespace
+{
+    web::json::value make_event(const nmos::type& type, const nmos::id& id, const utility::string_t& pre_label, const utility::string_t& post_label)
+    {
+        using web::json::value;
+        using web::json::value_of;
+        const auto pre = pre_label.empty() ? value::null() : value_of({ { U("id"), id }, { U("label"), pre_label } });
+        const auto post = post_label.empty() ? value::null() : value_of({ { U("id"), id }, { U("label"), post_label } });
+        return nmos::details::make_resource_event(U(""), type, pre, post);
+    }
+
+    // summarise the coalesced events as e.g. "device:-/a source:a/b node:b/-"
+    utility::string_t summarise_events(const web::json::value& events)
+    {
+        utility::string_t result;
+        for (const auto& event : events.as_array())
+        {
+            const auto id_type = nmos::details::get_resource_event_resource(U("/"), event);
+            if (!result.empty()) result += U(' ');
+            result += id_type.first + U(':');
+            result += event.has_field(U("pre")) ? nmos::fields::label(event.at(U("pre"))) : U("-");
+            result += U('/');
+            result += event.has_field(U("post")) ? nmos::fields::label(event.at(U("post"))) : U("-");
+        }
+        return result;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testCoalesceResourceEvents)
+{
+    using web::json::value_from_elements;
+    using nmos::details::coalesce_resource_events;
+    const auto& node = nmos::types::node;
+    const auto& device = nmos::types::device;
+    const auto& source = nmos::types::source;
+
+    // 'added' followed by 'modified'
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{ make_event(device, U("device"), U(""), U("a")), make_event(device, U("device"), U("a"), U("b")) });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("device:-/b"), summarise_events(events));
+    }
+
+    // 'modified' followed by 'modified'
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{ make_event(device, U("device"), U("a"), U("b")), make_event(device, U("device"), U("b"), U("c")) });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("device:a/c"), summarise_events(events));
+    }
+
+    // 'modified' followed by 'removed'
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{ make_event(device, U("device"), U("a"), U("b")), make_event(device, U("device"), U("b"), U("")) });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("device:a/-"), summarise_events(events));
+    }
+
+    // 'added' followed by 'removed'
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{ make_event(device, U("device"), U(""), U("a")), make_event(device, U("device"), U("a"), U("b")), make_event(device, U("device"), U("b"), U("")) });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(0, events.size());
+    }
+
+    // 'removed' followed by 'added' are kept separate
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{ make_event(device, U("device"), U("a"), U("")), make_event(device, U("device"), U(""), U("b")), make_event(device, U("device"), U("b"), U("c")) });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("device:a/- device:-/c"), summarise_events(events));
+    }
+
+    // a super-resource is still added before its sub-resources, taking the position of the earlier event
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{
+            make_event(node, U("node"), U(""), U("a")),
+            make_event(device, U("device"), U(""), U("a")),
+            make_event(source, U("source"), U(""), U("a")),
+            make_event(node, U("node"), U("a"), U("b")),
+            make_event(source, U("source"), U("a"), U("b")),
+            make_event(device, U("device"), U("a"), U("b"))
+        });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("node:-/b device:-/b source:-/b"), summarise_events(events));
+    }
+
+    // and removed after them, taking the position of the later event
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{
+            make_event(node, U("node"), U("a"), U("b")),
+            make_event(device, U("device"), U("a"), U("b")),
+            make_event(source, U("source"), U("a"), U("b")),
+            make_event(source, U("source"), U("b"), U("")),
+            make_event(device, U("device"), U("b"), U("")),
+            make_event(node, U("node"), U("b"), U(""))
+        });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("source:a/- device:a/- node:a/-"), summarise_events(events));
+    }
+
+    // events for other resources are unaffected, and keep their relative order
+    {
+        auto events = value_from_elements(std::vector<web::json::value>{
+            make_event(source, U("source1"), U(""), U("a")),
+            make_event(source, U("source2"), U("a"), U("b")),
+            make_event(source, U("source1"), U("a"), U("b")),
+            make_event(source, U("source3"), U("a"), U("")),
+            make_event(source, U("source2"), U("b"), U("c"))
+        });
+        coalesce_resource_events(U("/"), events);
+        BST_REQUIRE_EQUAL(U("source1:-/b source2:a/c source3:a/-"), summarise_events(events));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testFindSubscriptions)
+{
+    using web::json::value_of;
+
+    nmos::resources resources;
+
+    const auto device_id = nmos::make_id();
+    const auto other_device_id = nmos::make_id();
+    insert_subscription(resources, U("/senders"), web::json::value::object());
+    insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), device_id } }));
+    insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), other_device_id } }));
+    insert_subscription(resources, U("/senders"), value_of({ { U("query.rql"), U("eq(label,meow)") } }));
+    insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), device_id }, { U("query.match_type"), U("icase") } }));
+    insert_subscription(resources, U("/receivers"), value_of({ { U("device_id"), device_id } }));
+    insert_subscription(resources, U(""), web::json::value::object());
+    insert_subscription(resources, U(""), value_of({ { U("format"), U("urn:x-nmos:format:video") } }));
+
+    const auto sender = make_sender(nmos::make_id(), device_id, U("purr"));
+
+    // all senders, this device, RQL, case-insensitive this device, and all resources
+    BST_REQUIRE_EQUAL(5, nmos::details::find_subscriptions(resources, nmos::types::sender, web::json::value::null(), sender.data).size());
+
+    // and other device too
+    auto moved = sender.data;
+    moved[nmos::fields::device_id] = web::json::value::string(other_device_id);
+    BST_REQUIRE_EQUAL(6, nmos::details::find_subscriptions(resources, nmos::types::sender, sender.data, moved).size());
+
+    // when the property value isn't a string, any value might match
+    auto weird = sender.data;
+    weird[nmos::fields::device_id] = value_of({ device_id });
+    BST_REQUIRE_EQUAL(6, nmos::details::find_subscriptions(resources, nmos::types::sender, web::json::value::null(), weird).size());
+
+    // erased subscriptions aren't found
+    auto& by_type = resources.get<nmos::tags::type>();
+    const auto subscriptions = by_type.equal_range(nmos::details::has_data(nmos::types::subscription));
+    std::vector<nmos::id> subscription_ids;
+    for (auto it = subscriptions.first; subscriptions.second != it; ++it) subscription_ids.push_back(it->id);
+    for (const auto& id : subscription_ids) nmos::erase_resource(resources, id, false);
+    BST_REQUIRE(nmos::details::find_subscriptions(resources, nmos::types::sender, sender.data, moved).empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testInsertResourceEventsPerformance)
+{
+    using web::json::value_of;
+
+    // events/s as the number of subscriptions increases
+    // most subscriptions are per-device, as is typical for control systems
+    const size_t event_count = 1000;
+    for (size_t subscription_count : { 1, 10, 100, 1000 })
+    {
+        nmos::resources resources;
+
+        std::vector<nmos::id> device_ids;
+        for (size_t i = 0; i < subscription_count; ++i)
+        {
+            device_ids.push_back(nmos::make_id());
+            if (0 == i % 10)
+            {
+                insert_subscription(resources, U("/senders"), value_of({ { U("query.rql"), U("matches(label,cam.*)") } }));
+            }
+            else
+            {
+                insert_subscription(resources, U("/senders"), value_of({ { U("device_id"), device_ids.back() } }));
+            }
+        }
+
+        const auto sender_id = nmos::make_id();
+        insert_resource(resources, make_sender(sender_id, device_ids.front(), U("cam")));
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < event_count; ++i)
+        {
+            modify_resource(resources, sender_id, [&i](nmos::resource& sender)
+            {
+                sender.data[nmos::fields::label] = web::json::value::string(U("cam ") + utility::ostringstreamed(i));
+            });
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start);
+
+        std::cout << "insert_resource_events with " << subscription_count << " subscriptions: " << (size_t)(event_count / elapsed.count()) << " events/s" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testResourceQuerySerialize)
+{
+    nmos::resources resources;
+
+    const auto sender_id = nmos::make_id();
+    insert_resource(resources, make_sender(sender_id, nmos::make_id(), U("purr")));
+
+    const nmos::resource_query match(version, U("/senders"), web::json::value::object());
+    const nmos::resource_query downgrade(version, U("/senders"), web::json::value_of({ { U("query.downgrade"), U("v1.0") } }));
+
+    const auto& sender = *nmos::find_resource(resources, sender_id);
+    const auto& serialized = match.serialize(sender);
+    BST_REQUIRE_EQUAL(match.downgrade(sender).serialize(), serialized);
+    BST_REQUIRE_EQUAL(downgrade.downgrade(sender).serialize(), downgrade.serialize(sender));
+    BST_REQUIRE(&serialized != &downgrade.serialize(sender));
+
+    // the serialized data is cached
+    BST_REQUIRE_EQUAL(&serialized, &match.serialize(sender));
+
+    // until the resource is modified
+    modify_resource(resources, sender_id, [](nmos::resource& sender)
+    {
+        sender.data[nmos::fields::label] = web::json::value::string(U("meow"));
+    });
+
+    const auto& modified = *nmos::find_resource(resources, sender_id);
+    BST_REQUIRE_EQUAL(match.downgrade(modified).serialize(), match.serialize(modified));
+    BST_REQUIRE_EQUAL(U("meow"), nmos::fields::label(web::json::value::parse(match.serialize(modified))));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testResourceQuerySerializeStrip)
+{
+    using web::json::value_of;
+
+    nmos::resources resources;
+
+    // a v1.3 source has a property which was added in v1.3
+    const utility::string_t event_type{ U("event_type") };
+    const auto source_id = nmos::make_id();
+    insert_resource(resources, { version, nmos::types::source, value_of({
+        { nmos::fields::id, source_id },
+        { nmos::fields::version, nmos::make_version() },
+        { nmos::fields::label, U("purr") },
+        { nmos::fields::device_id, nmos::make_id() },
+        { event_type, U("boolean") }
+    }), false });
+    const auto& source = *nmos::find_resource(resources, source_id);
+
+    const nmos::resource_query stripped(nmos::is04_versions::v1_2, U("/sources"), web::json::value::object());
+    const nmos::resource_query unstripped(nmos::is04_versions::v1_2, U("/sources"), value_of({ { U("query.strip"), false } }));
+
+    // whichever query is serialized first, each gets the right result
+    BST_REQUIRE(!web::json::value::parse(stripped.serialize(source)).has_field(event_type));
+    BST_REQUIRE(web::json::value::parse(unstripped.serialize(source)).has_field(event_type));
+    BST_REQUIRE(!web::json::value::parse(stripped.serialize(source)).has_field(event_type));
+
+    BST_REQUIRE_EQUAL(stripped.downgrade(source).serialize(), stripped.serialize(source));
+    BST_REQUIRE_EQUAL(unstripped.downgrade(source).serialize(), unstripped.serialize(source));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testResourcePagingByType)
+{
+    using web::json::value_of;
+
+    nmos::resources resources;
+
+    const std::vector<nmos::type> types{ nmos::types::node, nmos::types::device, nmos::types::source, nmos::types::flow, nmos::types::sender, nmos::types::receiver };
+    std::vector<nmos::id> ids;
+    for (size_t i = 0; i < 60; ++i)
+    {
+        ids.push_back(nmos::make_id());
+        insert_resource(resources, make_resource(types[i % types.size()], ids.back(), nmos::make_id()));
+    }
+    // modify some resources so that created and updated orders differ
+    for (size_t i = 0; i < ids.size(); i += 7)
+    {
+        modify_resource(resources, ids[i], [](nmos::resource& resource) { resource.data[nmos::fields::description] = web::json::value::string(U("modified")); });
+    }
+    // and erase some, which must be skipped
+    for (size_t i = 3; i < ids.size(); i += 11)
+    {
+        erase_resource(resources, ids[i], false);
+    }
+
+    // paging through resources of one type gives the same results whichever index is used
+    for (const auto& type : types)
+    {
+        const nmos::resource_query match(version, U('/') + nmos::resourceType_from_type(type), web::json::value::object(), resources);
+        const resource_query_predicate pred{ &match, &resources };
+
+        for (const auto& order : { U("create"), U("update") })
+        {
+            nmos::resource_paging all(value_of({ { U("paging.order"), order }, { U("paging.limit"), 3 } }), most_recent_update(resources));
+            nmos::resource_paging one(all);
+
+            size_t count = 0;
+            for (;;)
+            {
+                const auto expected = page_ids(all.page(resources, pred));
+                const auto actual = page_ids(one.page(resources, type, pred));
+                BST_REQUIRE(expected == actual);
+                BST_REQUIRE(all.since == one.since);
+                BST_REQUIRE(all.until == one.until);
+                if (expected.empty()) break;
+                count += expected.size();
+
+                // next (older) page
+                all.until = one.until = all.since;
+                all.since = one.since = nmos::tai_min();
+                all.since_specified = one.since_specified = false;
+            }
+            BST_REQUIRE(0 != count);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testResourcePagingByProperty)
+{
+    using web::json::value;
+    using web::json::value_of;
+
+    nmos::resources resources;
+
+    const std::vector<nmos::id> device_ids{ nmos::make_id(), nmos::make_id(), nmos::make_id() };
+    const std::vector<nmos::id> sender_ids{ nmos::make_id(), nmos::make_id() };
+    std::vector<nmos::id> ids;
+    for (size_t i = 0; i < 60; ++i)
+    {
+        ids.push_back(nmos::make_id());
+        auto receiver = make_resource(nmos::types::receiver, ids.back(), device_ids[i % device_ids.size()]);
+        // subscriptions to one of the senders, or inactive, or (invalid, but queryable) an array
+        const auto subscription = 0 == i % 5 ? value::null() : 0 == i % 7 ? value_of({ sender_ids[0], sender_ids[1] }) : value::string(sender_ids[i % sender_ids.size()]);
+        receiver.data[nmos::fields::subscription] = value_of({ { nmos::fields::sender_id, subscription } });
+        // or even (also invalid, but queryable) an array of subscriptions
+        if (0 == i % 13) receiver.data[nmos::fields::subscription] = value_of({ receiver.data[nmos::fields::subscription] });
+        insert_resource(resources, std::move(receiver));
+        insert_resource(resources, make_resource(nmos::types::sender, nmos::make_id(), device_ids[i % device_ids.size()]));
+    }
+    // modify some resources so that created and updated orders differ, and the index must be updated
+    for (size_t i = 0; i < ids.size(); i += 3)
+    {
+        modify_resource(resources, ids[i], [&](nmos::resource& resource) { resource.data[nmos::fields::device_id] = value::string(device_ids[(i + 1) % device_ids.size()]); });
+    }
+    // and erase some, which must be skipped
+    for (size_t i = 1; i < ids.size(); i += 11)
+    {
+        erase_resource(resources, ids[i], false);
+    }
+
+    const std::vector<value> queries
+    {
+        value_of({ { U("device_id"), device_ids[0] } }),
+        value_of({ { U("subscription.sender_id"), sender_ids[1] } }),
+        value_of({ { U("subscription.sender_id"), U("null") } }),
+        value_of({ { U("subscription.sender_id"), sender_ids[0] }, { U("device_id"), device_ids[2] } })
+    };
+
+    // paging through the resources found using a property index gives the same results as the type index
+    for (const auto& query : queries)
+    {
+        const nmos::resource_query match(version, U("/receivers"), query, resources);
+        BST_REQUIRE(!match.index_property.empty());
+        const resource_query_predicate pred{ &match, &resources };
+
+        for (const auto& order : { U("create"), U("update") })
+        {
+            auto paging_params = query;
+            paging_params[U("paging.order")] = value::string(order);
+            paging_params[U("paging.limit")] = value::number(3);
+            nmos::resource_paging by_type(paging_params, most_recent_update(resources));
+            nmos::resource_paging by_property(by_type);
+            const nmos::property_index_range indexed(resources, match, by_property.order_by_created);
+
+            size_t count = 0;
+            for (;;)
+            {
+                const auto expected = page_ids(by_type.page(resources, nmos::types::receiver, pred));
+                const auto actual = page_ids(by_property.page(indexed, pred));
+                BST_REQUIRE(expected == actual);
+                BST_REQUIRE(by_type.since == by_property.since);
+                BST_REQUIRE(by_type.until == by_property.until);
+                if (expected.empty()) break;
+                count += expected.size();
+
+                // next (older) page
+                by_type.until = by_property.until = by_type.since;
+                by_type.since = by_property.since = nmos::tai_min();
+                by_type.since_specified = by_property.since_specified = false;
+            }
+            BST_REQUIRE(0 != count);
+        }
+    }
+
+    // a query for a property which is not indexed, or which requires inexact matching, does not use an index
+    BST_REQUIRE(nmos::resource_query(version, U("/receivers"), value_of({ { U("label"), U("receiver") } })).index_property.empty());
+    BST_REQUIRE(nmos::resource_query(version, U("/flows"), value_of({ { U("format"), U("urn:x-nmos:format:video") } })).index_property.empty());
+    BST_REQUIRE(nmos::resource_query(version, U("/receivers"), value_of({ { U("device_id"), device_ids[0] }, { U("query.match_type"), U("substr") } })).index_property.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testResourcePagingByTypePerformance)
+{
+    using web::json::value_of;
+
+    // 100k mixed resources, with few receivers, all registered before all the other resources
+    // so the most recently updated resources are not receivers
+    const size_t resource_count = 100000;
+    const size_t receiver_count = 100;
+
+    nmos::resources resources;
+
+    const std::vector<nmos::type> types{ nmos::types::node, nmos::types::device, nmos::types::source, nmos::types::flow, nmos::types::sender };
+    for (size_t i = 0; i < resource_count; ++i)
+    {
+        const auto& type = i < receiver_count ? nmos::types::receiver : types[i % types.size()];
+        insert_resource(resources, make_resource(type, nmos::make_id(), nmos::make_id()));
+    }
+
+    const nmos::resource_query match(version, U("/receivers"), web::json::value::object(), resources);
+    const resource_query_predicate pred{ &match, &resources };
+    const auto query_params = value_of({ { U("paging.limit"), 10 } });
+
+    const size_t page_count = 100;
+    size_t all_count = 0, one_count = 0;
+
+    const auto all_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < page_count; ++i)
+    {
+        nmos::resource_paging paging(query_params, most_recent_update(resources));
+        all_count += page_ids(paging.page(resources, pred)).size();
+    }
+    const auto all_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - all_start);
+
+    const auto one_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < page_count; ++i)
+    {
+        nmos::resource_paging paging(query_params, most_recent_update(resources));
+        one_count += page_ids(paging.page(resources, nmos::types::receiver, pred)).size();
+    }
+    const auto one_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - one_start);
+
+    BST_REQUIRE_EQUAL(10 * page_count, all_count);
+    BST_REQUIRE_EQUAL(all_count, one_count);
+
+    std::cout << "resource_paging with " << resource_count << " resources, using the updated index: " << (size_t)(page_count / all_elapsed.count()) << " pages/s" << std::endl;
+    std::cout << "resource_paging with " << resource_count << " resources, using the type_updated index: " << (size_t)(page_count / one_elapsed.count()) << " pages/s" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// compare evaluating a compiled RQL query against interpreting it, for many senders
+BST_TEST_CASE_PERFORMANCE(testResourceQueryRqlPerformance)
+{
+    using web::json::value_of;
+
+    const size_t sender_count = 10000;
+
+    nmos::resources resources;
+
+    const std::vector<utility::string_t> formats{ U("urn:x-nmos:format:video"), U("urn:x-nmos:format:audio"), U("urn:x-nmos:format:data") };
+    for (size_t i = 0; i < sender_count; ++i)
+    {
+        const auto flow_id = nmos::make_id();
+        insert_resource(resources, { version, nmos::types::flow, value_of({
+            { nmos::fields::id, flow_id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, U("flow") },
+            { nmos::fields::format, formats[i % formats.size()] }
+        }), false });
+
+        auto sender = make_sender(nmos::make_id(), nmos::make_id(), 0 == i % 2 ? U("purr") : U("hiss"));
+        sender.data[nmos::fields::flow_id] = web::json::value::string(flow_id);
+        insert_resource(resources, std::move(sender));
+    }
+
+    const auto query_params = value_of({
+        { U("query.rql"), U("and(matches(label,^P,i),or(eq(version,meow),ne(label,woof)),rel(flow_id,eq(format,urn%3Ax-nmos%3Aformat%3Avideo)))") }
+    });
+
+    const nmos::resource_query compiled(version, U("/senders"), query_params, resources);
+    BST_REQUIRE(!!compiled.rql_plan);
+    auto interpreted = compiled;
+    interpreted.rql_plan.reset();
+
+    const size_t repeat_count = 10;
+    size_t compiled_count = 0, interpreted_count = 0;
+
+    const auto compiled_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat_count; ++i)
+    {
+        for (const auto& resource : resources) if (compiled(resource, resources)) ++compiled_count;
+    }
+    const auto compiled_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - compiled_start);
+
+    const auto interpreted_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat_count; ++i)
+    {
+        for (const auto& resource : resources) if (interpreted(resource, resources)) ++interpreted_count;
+    }
+    const auto interpreted_elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - interpreted_start);
+
+    // every other sender is "purr", and every third flow is video, so one in six senders match
+    BST_REQUIRE_EQUAL(repeat_count * ((sender_count + 5) / 6), compiled_count);
+    BST_REQUIRE_EQUAL(compiled_count, interpreted_count);
+
+    const auto resource_count = repeat_count * resources.size();
+    std::cout << "resource_query with RQL, compiled: " << (size_t)(resource_count / compiled_elapsed.count()) << " resources/s" << std::endl;
+    std::cout << "resource_query with RQL, interpreted: " << (size_t)(resource_count / interpreted_elapsed.count()) << " resources/s" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testResourcePagingByPropertyPerformance)
+{
+    using web::json::value_of;
+
+    // 100k flows, from 10k sources, where each query matches only a few
+    const size_t resource_count = 100000;
+    const size_t source_count = 10000;
+
+    nmos::resources resources;
+
+    std::vector<nmos::id> source_ids;
+    for (size_t i = 0; i < source_count; ++i) source_ids.push_back(nmos::make_id());
+    for (size_t i = 0; i < resource_count; ++i)
+    {
+        auto flow = make_resource(nmos::types::flow, nmos::make_id(), nmos::make_id());
+        flow.data[nmos::fields::source_id] = web::json::value::string(source_ids[i % source_count]);
+        insert_resource(resources, std::move(flow));
+    }
+
+    const size_t query_count = 100;
+    size_t type_count = 0, property_count = 0;
+    double type_elapsed = 0, property_elapsed = 0;
+
+    for (size_t i = 0; i < query_count; ++i)
+    {
+        const auto query_params = value_of({ { U("source_id"), source_ids[i * source_count / query_count] } });
+        const nmos::resource_query match(version, U("/flows"), query_params, resources);
+        const resource_query_predicate pred{ &match, &resources };
+
+        const auto type_start = std::chrono::steady_clock::now();
+        {
+            nmos::resource_paging paging(query_params, most_recent_update(resources));
+            type_count += page_ids(paging.page(resources, nmos::types::flow, pred)).size();
+        }
+        type_elapsed += std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - type_start).count();
+
+        const auto property_start = std::chrono::steady_clock::now();
+        {
+            nmos::resource_paging paging(query_params, most_recent_update(resources));
+            const nmos::property_index_range indexed(resources, match, paging.order_by_created);
+            property_count += page_ids(paging.page(indexed, pred)).size();
+        }
+        property_elapsed += std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - property_start).count();
+    }
+
+    BST_REQUIRE_EQUAL(query_count * resource_count / source_count, type_count);
+    BST_REQUIRE_EQUAL(type_count, property_count);
+
+    std::cout << "resource_query for source_id with " << resource_count << " flows, using the type_updated index: " << (size_t)(query_count / type_elapsed) << " queries/s" << std::endl;
+    std::cout << "resource_query for source_id with " << resource_count << " flows, using the source_id index: " << (size_t)(query_count / property_elapsed) << " queries/s" << std::endl;
+}
@@ -0,0 +1,175 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/query_ws_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "bst/test/test.h"
+#include "cpprest/basic_utils.h" // for utility::ostringstreamed
+#include "cpprest/ws_client.h"
+#include "nmos/is04_versions.h"
+#include "nmos/model.h"
+#include "nmos/slog.h"
+
+namespace
+{
+    class nolog_gate : public slog::base_gate
+    {
+    public:
+        virtual bool pertinent(slog::severity) const { return false; }
+        virtual void log(const slog::log_message&) const {}
+    };
+
+    const auto version = nmos::is04_versions::v1_3;
+
+    typedef std::chrono::steady_clock steady_clock;
+
+    // the label of each sender is the time it was modified, so that the latency of each event can be measured by the client
+    utility::string_t make_label(steady_clock::time_point modified)
+    {
+        return utility::ostringstreamed(modified.time_since_epoch().count());
+    }
+
+    steady_clock::time_point parse_label(const utility::string_t& label)
+    {
+        return steady_clock::time_point(steady_clock::duration(utility::istringstreamed<steady_clock::rep>(label)));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// load test of the Query WebSocket API, with many connections to one subscription
+// measuring the latency from each registration update to each websocket message
+// note, each connection requires two file descriptors in this process, so a higher
+// connection_count may require the limit on open files (e.g. ulimit -n) to be raised
+BST_TEST_CASE_PERFORMANCE(testQueryWebSocketLatencyPerformance)
+{
+    using web::json::value_of;
+
+    const size_t connection_count = 200;
+    const size_t update_count = 100;
+    const auto update_interval = std::chrono::milliseconds(5);
+
+    for (int threads : { 1, 4 })
+    {
+        nolog_gate gate;
+        nmos::registry_model model;
+        nmos::websockets websockets;
+
+        web::websockets::experimental::listener::websocket_listener_config config;
+        config.set_threads(threads);
+
+        for (auto port = 49152; port <= 65535; ++port)
+        {
+            const auto uri = web::uri_builder(U("ws://localhost")).set_port(port).to_uri();
+            web::websockets::experimental::listener::websocket_listener listener(uri, config);
+            listener.set_handlers(nmos::make_query_ws_api(nmos::make_id(), model, websockets, gate));
+            try
+            {
+                listener.open().wait();
+            }
+            catch (const web::websockets::websocket_exception&)
+            {
+                // could well be that port is already in use, so just try the next one
+                continue;
+            }
+
+            const auto subscription_id = nmos::make_id();
+            const auto ws_href = web::uri_builder(uri).set_path(U("/x-nmos/query/v1.3/subscriptions/") + subscription_id).to_uri();
+            {
+                auto lock = model.write_lock();
+                insert_resource(model.registry_resources, { version, nmos::types::subscription, value_of({
+                    { nmos::fields::id, subscription_id },
+                    { nmos::fields::max_update_rate_ms, 0 },
+                    { nmos::fields::persist, true },
+                    { nmos::fields::resource_path, U("/senders") },
+                    { nmos::fields::params, web::json::value::object() },
+                    { nmos::fields::ws_href, ws_href.to_string() }
+                }), true });
+            }
+
+            std::thread send_thread([&] { nmos::send_query_ws_events_thread(listener, model, websockets, gate); });
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::vector<steady_clock::duration> latencies;
+
+            std::vector<web::websockets::client::websocket_callback_client> clients(connection_count);
+            for (auto& client : clients)
+            {
+                client.set_message_handler([&](const web::websockets::client::websocket_incoming_message& message)
+                {
+                    const auto received = steady_clock::now();
+                    const auto body = web::json::value::parse(utility::s2us(message.extract_string().get()));
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (const auto& event : nmos::fields::grain_data(body).as_array())
+                    {
+                        if (event.has_field(U("post")))
+                        {
+                            latencies.push_back(received - parse_label(nmos::fields::label(event.at(U("post")))));
+                        }
+                    }
+                    condition.notify_all();
+                });
+                client.connect(ws_href).wait();
+            }
+            {
+                auto lock = model.read_lock();
+                BST_REQUIRE(model.wait_for(lock, std::chrono::seconds(5), [&] { return connection_count == websockets.size(); }));
+            }
+
+            // insert a sender, and then update it like repeated registrations
+            const auto sender_id = nmos::make_id();
+            {
+                auto lock = model.write_lock();
+                insert_resource(model.registry_resources, { version, nmos::types::sender, value_of({
+                    { nmos::fields::id, sender_id },
+                    { nmos::fields::version, nmos::make_version() },
+                    { nmos::fields::label, make_label(steady_clock::now()) },
+                    { nmos::fields::device_id, nmos::make_id() }
+                }), false });
+                model.notify();
+            }
+            for (size_t i = 0; i < update_count; ++i)
+            {
+                std::this_thread::sleep_for(update_interval);
+
+                auto lock = model.write_lock();
+                modify_resource(model.registry_resources, sender_id, [](nmos::resource& sender)
+                {
+                    sender.data[nmos::fields::label] = web::json::value::string(make_label(steady_clock::now()));
+                });
+                model.notify();
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                BST_REQUIRE(condition.wait_for(lock, std::chrono::seconds(30), [&] { return connection_count * (1 + update_count) <= latencies.size(); }));
+            }
+
+            model.controlled_shutdown();
+            send_thread.join();
+
+            for (auto& client : clients)
+            {
+                client.close().wait();
+            }
+            listener.close().wait();
+
+            std::sort(latencies.begin(), latencies.end());
+            const auto percentile = [&latencies](size_t p)
+            {
+                return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(latencies[(latencies.size() - 1) * p / 100]).count();
+            };
+            std::cout << threads << " threads, " << connection_count << " connections: latency"
+                << " p50 " << percentile(50) << " ms,"
+                << " p90 " << percentile(90) << " ms,"
+                << " p99 " << percentile(99) << " ms,"
+                << " max " << percentile(100) << " ms" << std::endl;
+            break;
+        }
+    }
+}
@@ -0,0 +1,254 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/resources.h"
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include "bst/test/test.h"
+#include "nmos/is04_versions.h"
+
+namespace
+{
+    const auto version = nmos::is04_versions::v1_3;
+
+    nmos::resource make_resource(const nmos::type& type, const nmos::id& id, const nmos::id& super_id)
+    {
+        using web::json::value_of;
+
+        return{ version, type, value_of({
+            { nmos::fields::id, id },
+            { nmos::fields::version, nmos::make_version() },
+            { nmos::fields::label, type.name },
+            { nmos::fields::node_id, super_id }
+        }), false };
+    }
+
+    // make a minimal sub-resource of a device, e.g. a source, sender or receiver
+    nmos::resource make_device_sub_resource(const nmos::type& type, const nmos::id& id, const nmos::id& device_id)
+    {
+        auto resource = make_resource(type, id, {});
+        resource.data.erase(nmos::fields::node_id);
+        resource.data[nmos::fields::device_id] = web::json::value::string(device_id);
+        return resource;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testLeastHealth)
+{
+    nmos::resources resources;
+
+    // least health is no greater than now
+    const auto now = nmos::health_now();
+    BST_REQUIRE(now <= nmos::least_health(resources).first);
+
+    const auto node_id = nmos::make_id();
+    const auto device_id = nmos::make_id();
+    insert_resource(resources, make_resource(nmos::types::node, node_id, {}));
+    insert_resource(resources, make_resource(nmos::types::device, device_id, node_id));
+
+    // decreasing the health of a resource is tracked immediately
+    nmos::set_resource_health(resources, node_id, 100);
+    BST_REQUIRE_EQUAL(100, nmos::least_health(resources).first);
+
+    // increasing the health of a resource, e.g. by a heartbeat, is tracked when it is next the least health
+    nmos::set_resource_health(resources, node_id, 200);
+    BST_REQUIRE_EQUAL(200, nmos::least_health(resources).first);
+
+    nmos::set_resource_health(resources, device_id, 300);
+    BST_REQUIRE_EQUAL(200, nmos::least_health(resources).first);
+
+    // nothing has expired
+    BST_REQUIRE_EQUAL(0, nmos::erase_expired_resources(resources, 200, false));
+    BST_REQUIRE_EQUAL(2, resources.size());
+
+    // just the node has expired, although that would be unusual
+    BST_REQUIRE_EQUAL(1, nmos::erase_expired_resources(resources, 250, false));
+    BST_REQUIRE(!nmos::find_resource(resources, node_id)->has_data());
+    BST_REQUIRE(nmos::find_resource(resources, device_id)->has_data());
+    BST_REQUIRE(std::make_pair(nmos::health{ 300 }, nmos::health{ 200 }) == nmos::least_health(resources));
+
+    // the device has now also expired
+    BST_REQUIRE_EQUAL(1, nmos::erase_expired_resources(resources, now, false));
+    BST_REQUIRE(now <= nmos::least_health(resources).first);
+    BST_REQUIRE_EQUAL(200, nmos::least_health(resources).second);
+
+    // the node was erased in the previous interval, the device in this one
+    BST_REQUIRE_EQUAL(1, nmos::forget_erased_resources(resources, 250));
+    BST_REQUIRE_EQUAL(1, resources.size());
+    BST_REQUIRE_EQUAL(300, nmos::least_health(resources).second);
+
+    BST_REQUIRE_EQUAL(1, nmos::forget_erased_resources(resources, now));
+    BST_REQUIRE(resources.empty());
+    BST_REQUIRE(now <= nmos::least_health(resources).second);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testEraseExpiredResources)
+{
+    nmos::resources resources;
+
+    const auto node_id = nmos::make_id();
+    const auto device_id = nmos::make_id();
+    const auto other_node_id = nmos::make_id();
+    insert_resource(resources, make_resource(nmos::types::node, node_id, {}));
+    insert_resource(resources, make_resource(nmos::types::device, device_id, node_id));
+    insert_resource(resources, make_resource(nmos::types::node, other_node_id, {}));
+
+    nmos::set_resource_health(resources, node_id, 100);
+    nmos::set_resource_health(resources, other_node_id, 100);
+
+    // only the other node has a heartbeat
+    nmos::set_resource_health(resources, other_node_id, 200);
+    BST_REQUIRE_EQUAL(2, nmos::erase_expired_resources(resources, 150));
+    BST_REQUIRE_EQUAL(1, resources.size());
+    BST_REQUIRE(resources.end() != nmos::find_resource(resources, other_node_id));
+
+    // erased and reinserted resources are tracked again
+    BST_REQUIRE_EQUAL(1, nmos::erase_resource(resources, other_node_id, false));
+    insert_resource(resources, make_resource(nmos::types::node, other_node_id, {}));
+    nmos::set_resource_health(resources, other_node_id, 300);
+    BST_REQUIRE_EQUAL(300, nmos::least_health(resources).first);
+    BST_REQUIRE_EQUAL(0, nmos::forget_erased_resources(resources));
+    BST_REQUIRE_EQUAL(1, nmos::erase_expired_resources(resources, 400));
+    BST_REQUIRE(resources.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testGetSubResources)
+{
+    using web::json::value;
+
+    nmos::resources resources;
+
+    const auto node_id = nmos::make_id();
+    const auto device_id = nmos::make_id();
+    const auto source_id = nmos::make_id();
+    const auto sender_id = nmos::make_id();
+    const auto flow_id = nmos::make_id();
+    const auto v1_0_flow_id = nmos::make_id();
+
+    // insert sub-resources before their super-resources, like out-of-order registrations
+    auto flow = make_device_sub_resource(nmos::types::flow, flow_id, device_id);
+    flow.data[nmos::fields::source_id] = value::string(source_id);
+    insert_resource(resources, std::move(flow), true);
+    // "Version v1.0 Flows do not have a device_id and should be garbage collected based on their parent source_id."
+    auto v1_0_flow = make_device_sub_resource(nmos::types::flow, v1_0_flow_id, {});
+    v1_0_flow.version = nmos::is04_versions::v1_0;
+    v1_0_flow.data.erase(nmos::fields::device_id);
+    v1_0_flow.data[nmos::fields::source_id] = value::string(source_id);
+    insert_resource(resources, std::move(v1_0_flow), true);
+    insert_resource(resources, make_device_sub_resource(nmos::types::sender, sender_id, device_id), true);
+    insert_resource(resources, make_device_sub_resource(nmos::types::source, source_id, device_id), true);
+    insert_resource(resources, make_resource(nmos::types::device, device_id, node_id), true);
+    insert_resource(resources, make_resource(nmos::types::node, node_id, {}), true);
+
+    BST_REQUIRE(std::set<nmos::id>{ device_id } == nmos::find_resource(resources, node_id)->sub_resources);
+    BST_REQUIRE((std::set<nmos::id>{ source_id, flow_id, sender_id }) == nmos::find_resource(resources, device_id)->sub_resources);
+    BST_REQUIRE(std::set<nmos::id>{ v1_0_flow_id } == nmos::find_resource(resources, source_id)->sub_resources);
+
+    // erased resources are not sub-resources
+    erase_resource(resources, sender_id, false);
+    BST_REQUIRE((std::set<nmos::id>{ source_id, flow_id }) == nmos::get_sub_resources(resources, { device_id, nmos::types::device }));
+
+    // resources which are referred to by another type, or which cannot have sub-resources, have none
+    BST_REQUIRE(nmos::get_sub_resources(resources, { node_id, nmos::types::device }).empty());
+    BST_REQUIRE(nmos::get_sub_resources(resources, { flow_id, nmos::types::flow }).empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testInsertResourcesOutOfOrderPerformance)
+{
+    // 100k resources, i.e. 1k nodes each with 3 devices, each with 8 sources, 8 flows, 8 senders and 8 receivers
+    // all registered in reverse order, so that each super-resource must be joined to its sub-resources
+    const size_t node_count = 1000;
+    const size_t devices_per_node = 3;
+    const size_t resources_per_device = 32;
+
+    std::vector<nmos::resource> registrations;
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        const auto node_id = nmos::make_id();
+        registrations.push_back(make_resource(nmos::types::node, node_id, {}));
+        for (size_t j = 0; j < devices_per_node; ++j)
+        {
+            const auto device_id = nmos::make_id();
+            registrations.push_back(make_resource(nmos::types::device, device_id, node_id));
+            for (size_t k = 0; k < resources_per_device; ++k)
+            {
+                const auto& type = k < 8 ? nmos::types::source : k < 16 ? nmos::types::flow : k < 24 ? nmos::types::sender : nmos::types::receiver;
+                registrations.push_back(make_device_sub_resource(type, nmos::make_id(), device_id));
+            }
+        }
+    }
+
+    nmos::resources resources;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto it = registrations.rbegin(); registrations.rend() != it; ++it)
+    {
+        insert_resource(resources, std::move(*it), true);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start);
+
+    BST_REQUIRE_EQUAL(node_count * 100, resources.size());
+    size_t sub_resource_count = 0;
+    for (const auto& resource : resources) sub_resource_count += resource.sub_resources.size();
+    BST_REQUIRE_EQUAL(node_count * devices_per_node * (1 + resources_per_device), sub_resource_count);
+
+    std::cout << "insert_resource with join_sub_resources, " << resources.size() << " resources in reverse order: " << (size_t)(resources.size() / elapsed.count()) << " resources/s" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE_PERFORMANCE(testLeastHealthPerformance)
+{
+    // 50k resources, i.e. 10k nodes each with 4 devices, all of which have a heartbeat every second
+    const size_t node_count = 10000;
+    const size_t devices_per_node = 4;
+    const nmos::health expiry_interval = 12;
+
+    nmos::resources resources;
+
+    std::vector<nmos::id> node_ids;
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        node_ids.push_back(nmos::make_id());
+        insert_resource(resources, make_resource(nmos::types::node, node_ids.back(), {}));
+        for (size_t j = 0; j < devices_per_node; ++j)
+        {
+            insert_resource(resources, make_resource(nmos::types::device, nmos::make_id(), node_ids.back()));
+        }
+    }
+
+    const nmos::health start_health = 1000;
+    const size_t seconds = 60;
+
+    std::chrono::steady_clock::duration heartbeats{}, expiry{};
+    size_t least_health_count = 0;
+    for (nmos::health health = start_health; health < start_health + (nmos::health)seconds; ++health)
+    {
+        const auto heartbeats_start = std::chrono::steady_clock::now();
+        for (const auto& node_id : node_ids)
+        {
+            nmos::set_resource_health(resources, node_id, health);
+        }
+        heartbeats += std::chrono::steady_clock::now() - heartbeats_start;
+
+        // like erase_expired_resources_thread, which only takes the exclusive lock when something has actually expired
+        const auto expiry_start = std::chrono::steady_clock::now();
+        const auto least_health = nmos::least_health(resources);
+        ++least_health_count;
+        if (least_health.first < health - expiry_interval)
+        {
+            nmos::erase_expired_resources(resources, health - expiry_interval, false);
+        }
+        expiry += std::chrono::steady_clock::now() - expiry_start;
+    }
+
+    BST_REQUIRE_EQUAL(node_count * (1 + devices_per_node), resources.size());
+
+    using std::chrono::duration_cast;
+    using microseconds = std::chrono::duration<double, std::micro>;
+    std::cout << "heartbeats for " << resources.size() << " resources: " << (size_t)(seconds * node_count / duration_cast<std::chrono::duration<double>>(heartbeats).count()) << " heartbeats/s" << std::endl;
+    std::cout << "least_health for " << resources.size() << " resources: " << duration_cast<microseconds>(expiry).count() / least_health_count << " us/call" << std::endl;
+}
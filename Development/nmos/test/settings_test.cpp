@@ -0,0 +1,61 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/settings.h"
+
+#include "bst/test/test.h"
+#include "nmos/log_model.h"
+#include "nmos/model.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testSettingsSnapshot)
+{
+    using web::json::value_of;
+
+    // defaults
+    {
+        const nmos::settings_snapshot snapshot(web::json::value::object());
+        BST_REQUIRE(snapshot.logging_all_categories);
+        BST_REQUIRE_EQUAL(nmos::fields::registration_expiry_interval.default_value, snapshot.registration_expiry_interval);
+        BST_REQUIRE_EQUAL(nmos::fields::query_paging_default.default_value, (int)snapshot.query_paging_default);
+        BST_REQUIRE_EQUAL(nmos::fields::query_paging_limit.default_value, (int)snapshot.query_paging_limit);
+        BST_REQUIRE_EQUAL(nmos::experimental::fields::logging_limit.default_value, (int)snapshot.logging_limit);
+    }
+
+    // specified values
+    {
+        const nmos::settings_snapshot snapshot(value_of({
+            { nmos::fields::logging_categories, value_of({ U("access"), U("") }) },
+            { nmos::fields::registration_expiry_interval, 42 },
+            { nmos::fields::query_paging_default, 5 },
+            { nmos::fields::query_paging_limit, 50 },
+            { nmos::experimental::fields::logging_limit, 100 }
+        }));
+        BST_REQUIRE(!snapshot.logging_all_categories);
+        BST_REQUIRE_EQUAL(2, snapshot.logging_categories.size());
+        BST_REQUIRE_EQUAL(1, snapshot.logging_categories.count("access"));
+        BST_REQUIRE_EQUAL(1, snapshot.logging_categories.count(""));
+        BST_REQUIRE_EQUAL(42, snapshot.registration_expiry_interval);
+        BST_REQUIRE_EQUAL(5, snapshot.query_paging_default);
+        BST_REQUIRE_EQUAL(50, snapshot.query_paging_limit);
+        BST_REQUIRE_EQUAL(100, snapshot.logging_limit);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testUpdateSettingsSnapshot)
+{
+    nmos::registry_model model;
+    BST_REQUIRE_EQUAL(nmos::fields::registration_expiry_interval.default_value, model.settings_snapshot()->registration_expiry_interval);
+
+    model.settings = web::json::value_of({ { nmos::fields::registration_expiry_interval, 42 } });
+    const auto previous = model.settings_snapshot();
+    model.update_settings_snapshot();
+
+    // a previous snapshot is unaffected by the update
+    BST_REQUIRE_EQUAL(nmos::fields::registration_expiry_interval.default_value, previous->registration_expiry_interval);
+    BST_REQUIRE_EQUAL(42, model.settings_snapshot()->registration_expiry_interval);
+
+    nmos::experimental::log_model log_model;
+    log_model.settings = web::json::value_of({ { nmos::fields::logging_categories, web::json::value_of({ U("access") }) } });
+    log_model.update_settings_snapshot();
+    BST_REQUIRE(!log_model.settings_snapshot()->logging_all_categories);
+}
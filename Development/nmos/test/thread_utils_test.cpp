@@ -0,0 +1,29 @@
+// The first "test" is of course whether the header compiles standalone
+#include "nmos/thread_utils.h"
+
+#include <algorithm>
+#include <numeric>
+#include "bst/test/test.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testParallelFor)
+{
+    for (std::size_t concurrency : { 0, 1, 4, 64 })
+    {
+        const std::size_t count = 1000;
+        std::vector<std::size_t> calls(count, 0);
+        nmos::details::parallel_for(count, [&calls](std::size_t index)
+        {
+            ++calls[index];
+        }, concurrency);
+
+        // every index is visited exactly once
+        BST_REQUIRE_EQUAL(count, std::accumulate(calls.begin(), calls.end(), std::size_t(0)));
+        BST_REQUIRE(std::all_of(calls.begin(), calls.end(), [](std::size_t c) { return 1 == c; }));
+    }
+
+    // nothing to do
+    std::size_t calls = 0;
+    nmos::details::parallel_for(0, [&calls](std::size_t) { ++calls; });
+    BST_REQUIRE_EQUAL(0, calls);
+}
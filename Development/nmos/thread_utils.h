@@ -1,7 +1,10 @@
 #ifndef NMOS_THREAD_UTILS_H
 #define NMOS_THREAD_UTILS_H
 
+#include <algorithm>
+#include <atomic>
 #include <thread>
+#include <vector>
 
 namespace nmos
 {
@@ -84,6 +87,34 @@ namespace nmos
             }
         }
 
+        // call the specified function for each index from 0 to count - 1, concurrently on up to the specified number of threads, including the calling thread
+        // the function must be safe to call concurrently, and should not throw exceptions
+        template <typename Function>
+        inline void parallel_for(std::size_t count, Function f, std::size_t concurrency = std::thread::hardware_concurrency())
+        {
+            const auto thread_count = (std::min)(count, (std::max)(concurrency, std::size_t(1)));
+
+            std::atomic<std::size_t> next{ 0 };
+            const auto work = [&]
+            {
+                for (std::size_t index = next++; index < count; index = next++)
+                {
+                    f(index);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t t = 1; t < thread_count; ++t)
+            {
+                threads.emplace_back(work);
+            }
+            work();
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
         // RAII helper for starting and later joining threads which may require unblocking before join
         template <typename Function, typename PreJoin>
         class thread_guard
@@ -1,5 +1,6 @@
 #include "rql/rql.h"
 
+#include <exception>
 #include <stack>
 #include <stdexcept>
 #include "cpprest/base_uri.h" // for uri::decode
@@ -341,13 +342,22 @@ namespace rql
 
     evaluator::evaluator(extractor extract)
         : extract(extract)
-        , operators(default_operators())
+        , shared_operators(std::make_shared<const rql::operators>(default_operators()))
+        , operators(*shared_operators)
     {
     }
 
     evaluator::evaluator(extractor extract, rql::operators operators)
         : extract(extract)
-        , operators(operators)
+        , shared_operators(std::make_shared<const rql::operators>(std::move(operators)))
+        , operators(*shared_operators)
+    {
+    }
+
+    evaluator::evaluator(extractor extract, std::shared_ptr<const rql::operators> operators)
+        : extract(extract)
+        , shared_operators(std::move(operators))
+        , operators(*shared_operators)
     {
     }
 
@@ -382,6 +392,72 @@ namespace rql
         }
     }
 
+    key_path make_key_path(const web::json::value& key)
+    {
+        key_path result;
+        if (key.is_array())
+        {
+            for (const auto& element : key.as_array())
+            {
+                result.push_back(element.as_string());
+            }
+        }
+        else
+        {
+            const auto& keys = key.as_string();
+            utility::string_t::size_type first = 0;
+            for (auto last = keys.find(U('.')); utility::string_t::npos != last; first = last + 1, last = keys.find(U('.'), first))
+            {
+                result.push_back(keys.substr(first, last - first));
+            }
+            result.push_back(keys.substr(first));
+        }
+        return result;
+    }
+
+    compiler::compiler(std::shared_ptr<const rql::compiled_operators> operators)
+        : operators(std::move(operators))
+    {
+    }
+
+    plan compiler::operator()(const web::json::value& arg, bool extract_value) const
+    {
+        // arg is a call-operator
+        if (is_call_operator(arg))
+        {
+            const auto& name = arg.at(U("name")).as_string();
+            const auto& args = arg.at(U("args"));
+            // throws json_exception if not an array
+            args.as_array();
+
+            const auto found = operators->find(name);
+            if (found == operators->end())
+            {
+                throw details::unimplemented_operator(name);
+            }
+            return found->second(*this, args);
+        }
+        // arg is a value used as property key
+        else if (extract_value)
+        {
+            const auto key_path = make_key_path(arg);
+            return [key_path](const path_extractor& extract)
+            {
+                web::json::value extracted;
+                extract(extracted, key_path);
+                return extracted;
+            };
+        }
+        // arg is a value
+        else
+        {
+            return [arg](const path_extractor&)
+            {
+                return arg;
+            };
+        }
+    }
+
     // Helpers for json value comparison, implementing three-valued (tribool) logic
 
     web::json::value default_equal_to(const web::json::value& lhs, const web::json::value& rhs)
@@ -483,15 +559,44 @@ namespace rql
             }
             else
             {
-                // verbose conditional expression avoids compiler warnings on all platforms
-                const auto flags = icase ? utility::regex_t::flag_type(utility::regex_t::icase) : utility::regex_t::flag_type(0);
-
                 // throws bst::regex_error if the pattern is not valid
-                utility::regex_t regex(pattern, flags);
+                const auto regex = utility::make_cached_regex(pattern, icase);
 
-                return bst::regex_search(target.as_string(), regex) ? value_true : value_false;
+                return bst::regex_search(target.as_string(), *regex) ? value_true : value_false;
             }
         }
+
+        // a pattern for compiled matches, which if not valid reports the error when it's used, like matches
+        struct compiled_pattern
+        {
+            compiled_pattern(const utility::string_t& pattern, bool icase)
+            {
+                try
+                {
+                    regex = utility::make_cached_regex(pattern, icase);
+                }
+                catch (const bst::regex_error&)
+                {
+                    error = std::current_exception();
+                }
+            }
+
+            web::json::value operator()(const web::json::value& target) const
+            {
+                if (!target.is_string())
+                {
+                    return value_indeterminate;
+                }
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+                return bst::regex_search(target.as_string(), *regex) ? value_true : value_false;
+            }
+
+            std::shared_ptr<const utility::regex_t> regex;
+            std::exception_ptr error;
+        };
     }
 
     namespace functions
@@ -699,6 +804,354 @@ namespace rql
         }
     }
 
+    namespace compiled_functions
+    {
+        // Compiled equivalents of the functions above
+
+        // Logical operators (three-valued logic)
+
+        inline std::vector<plan> compile_args(const compiler& compile, const web::json::value& args)
+        {
+            std::vector<plan> operands;
+            for (const auto& arg : args.as_array())
+            {
+                operands.push_back(compile(arg));
+            }
+            return operands;
+        }
+
+        plan logical_and(const compiler& compile, const web::json::value& args)
+        {
+            const auto operands = compile_args(compile, args);
+            return [operands](const path_extractor& extract)
+            {
+                // cf. details::logical_and
+                bool indeterminate = false;
+                for (const auto& operand : operands)
+                {
+                    auto result = operand(extract);
+                    if (!result.is_boolean())
+                    {
+                        indeterminate = true;
+                    }
+                    else if (!result.as_bool())
+                    {
+                        return value_false;
+                    }
+                }
+                return indeterminate ? value_indeterminate : value_true;
+            };
+        }
+
+        plan logical_or(const compiler& compile, const web::json::value& args)
+        {
+            const auto operands = compile_args(compile, args);
+            return [operands](const path_extractor& extract)
+            {
+                // cf. details::logical_or
+                bool indeterminate = false;
+                for (const auto& operand : operands)
+                {
+                    auto result = operand(extract);
+                    if (!result.is_boolean())
+                    {
+                        indeterminate = true;
+                    }
+                    else if (result.as_bool())
+                    {
+                        return value_true;
+                    }
+                }
+                return indeterminate ? value_indeterminate : value_false;
+            };
+        }
+
+        plan logical_not(const compiler& compile, const web::json::value& args)
+        {
+            const auto arg = compile(args.at(0));
+            return [arg](const path_extractor& extract)
+            {
+                return details::logical_not(arg(extract));
+            };
+        }
+
+        // Relational operators
+
+        plan eq(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return equal_to(lhs(extract), rhs(extract));
+            };
+        }
+
+        plan ne(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return details::logical_not(equal_to(lhs(extract), rhs(extract)));
+            };
+        }
+
+        plan gt(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                return less(rhs(extract), lhs(extract));
+            };
+        }
+
+        plan ge(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                return details::logical_not(less(lhs(extract), rhs(extract)));
+            };
+        }
+
+        plan lt(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                return less(lhs(extract), rhs(extract));
+            };
+        }
+
+        plan le(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                return details::logical_not(less(rhs(extract), lhs(extract)));
+            };
+        }
+
+        // Array-friendly relational operators
+
+        plan any_eq(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return equal_to(element, value); });
+            };
+        }
+
+        plan any_ne(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return details::logical_not(equal_to(element, value)); });
+            };
+        }
+
+        plan any_gt(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return less(value, element); });
+            };
+        }
+
+        plan any_ge(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return details::logical_not(less(element, value)); });
+            };
+        }
+
+        plan any_lt(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return less(element, value); });
+            };
+        }
+
+        plan any_le(const compiler& compile, const web::json::value& args, comparator less)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, less](const path_extractor& extract)
+            {
+                const auto value = rhs(extract);
+                return details::logical_or(lhs(extract), [&](const web::json::value& element) { return details::logical_not(less(value, element)); });
+            };
+        }
+
+        // Set relation functions
+
+        plan in(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return details::includes(rhs(extract), lhs(extract), equal_to);
+            };
+        }
+
+        plan out(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return details::logical_not(details::includes(rhs(extract), lhs(extract), equal_to));
+            };
+        }
+
+        plan contains(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return details::includes(lhs(extract), rhs(extract), equal_to);
+            };
+        }
+
+        plan excludes(const compiler& compile, const web::json::value& args, comparator equal_to)
+        {
+            const auto lhs = compile(args.at(0), true);
+            const auto rhs = compile(args.at(1));
+            return [lhs, rhs, equal_to](const path_extractor& extract)
+            {
+                return details::logical_not(details::includes(lhs(extract), rhs(extract), equal_to));
+            };
+        }
+
+        // Additional filter functions
+
+        plan null(const compiler& compile, const web::json::value& args)
+        {
+            const auto& arg = args.at(0);
+
+            // arg is a call-operator
+            if (is_call_operator(arg))
+            {
+                const auto value = compile(arg);
+                return [value](const path_extractor& extract)
+                {
+                    return web::json::value::null() == value(extract) ? value_true : value_false;
+                };
+            }
+            else
+            {
+                const auto key_path = make_key_path(arg);
+                return [key_path](const path_extractor& extract)
+                {
+                    web::json::value extracted;
+                    if (!extract(extracted, key_path))
+                    {
+                        return value_indeterminate;
+                    }
+                    return web::json::value::null() == extracted ? value_true : value_false;
+                };
+            }
+        }
+
+        template <typename MatchTarget>
+        plan compile_matches(const compiler& compile, const web::json::value& args, MatchTarget match_target)
+        {
+            const auto target = compile(args.at(0), true);
+            const auto icase = args.size() > 2 ? args.at(2).as_string() == U("i") : false;
+
+            // when the pattern is a value, the regex can be constructed once
+            if (!is_call_operator(args.at(1)))
+            {
+                // throws web::json::json_exception if pattern is not a string
+                const details::compiled_pattern pattern(args.at(1).as_string(), icase);
+                return [target, pattern, match_target](const path_extractor& extract)
+                {
+                    return match_target(target(extract), pattern);
+                };
+            }
+
+            const auto pattern = compile(args.at(1));
+            return [target, pattern, icase, match_target](const path_extractor& extract)
+            {
+                const auto target_value = target(extract);
+                return match_target(target_value, details::compiled_pattern(pattern(extract).as_string(), icase));
+            };
+        }
+
+        plan matches(const compiler& compile, const web::json::value& args)
+        {
+            return compile_matches(compile, args, [](const web::json::value& target, const details::compiled_pattern& pattern)
+            {
+                return pattern(target);
+            });
+        }
+
+        plan any_matches(const compiler& compile, const web::json::value& args)
+        {
+            return compile_matches(compile, args, [](const web::json::value& target, const details::compiled_pattern& pattern)
+            {
+                return details::logical_or(target, std::cref(pattern));
+            });
+        }
+
+        // Other helpers
+
+        plan count(const compiler& compile, const web::json::value& args)
+        {
+            const auto value = compile(args.at(0), true);
+            return [value](const path_extractor& extract)
+            {
+                auto arg = value(extract);
+                if (!arg.is_object() && !arg.is_array())
+                {
+                    return value_indeterminate;
+                }
+                return web::json::value::number((uint64_t)arg.size());
+            };
+        }
+
+        plan get(const compiler& compile, const web::json::value& args)
+        {
+            const auto key = compile(args.at(0));
+            return [key](const path_extractor& extract)
+            {
+                // the key path can only be made when the key is known
+                web::json::value extracted;
+                extract(extracted, make_key_path(key(extract)));
+                return extracted;
+            };
+        }
+
+        plan value(const compiler& compile, const web::json::value& args)
+        {
+            return compile(args.at(0));
+        }
+    }
+
     namespace details
     {
         template <typename ThreeStateBinaryPredicate, typename ThreeStateCompare>
@@ -758,6 +1211,36 @@ namespace rql
         }
     }
 
+    namespace details
+    {
+        inline compiled_operators default_compiled_operators(comparator equal_to, comparator less, bool any)
+        {
+            using std::placeholders::_1;
+            using std::placeholders::_2;
+            return
+            {
+                { U("and"), compiled_functions::logical_and },
+                { U("or"), compiled_functions::logical_or },
+                { U("not"), compiled_functions::logical_not },
+                { U("eq"), std::bind(any ? compiled_functions::any_eq : compiled_functions::eq, _1, _2, equal_to) },
+                { U("ne"), std::bind(any ? compiled_functions::any_ne : compiled_functions::ne, _1, _2, equal_to) },
+                { U("gt"), std::bind(any ? compiled_functions::any_gt : compiled_functions::gt, _1, _2, less) },
+                { U("ge"), std::bind(any ? compiled_functions::any_ge : compiled_functions::ge, _1, _2, less) },
+                { U("lt"), std::bind(any ? compiled_functions::any_lt : compiled_functions::lt, _1, _2, less) },
+                { U("le"), std::bind(any ? compiled_functions::any_le : compiled_functions::le, _1, _2, less) },
+                { U("in"), std::bind(compiled_functions::in, _1, _2, equal_to) },
+                { U("out"), std::bind(compiled_functions::out, _1, _2, equal_to) },
+                { U("contains"), std::bind(compiled_functions::contains, _1, _2, equal_to) },
+                { U("excludes"), std::bind(compiled_functions::excludes, _1, _2, equal_to) },
+                { U("null"), compiled_functions::null },
+                { U("matches"), any ? compiled_functions::any_matches : compiled_functions::matches },
+                { U("count"), compiled_functions::count },
+                { U("get"), compiled_functions::get },
+                { U("value"), compiled_functions::value }
+            };
+        }
+    }
+
     operators default_operators()
     {
         return details::default_operators(default_equal_to, default_less);
@@ -777,4 +1260,34 @@ namespace rql
     {
         return details::default_any_operators(equal_to, less);
     }
+
+    compiled_operators default_compiled_operators()
+    {
+        return details::default_compiled_operators(default_equal_to, default_less, false);
+    }
+
+    compiled_operators default_compiled_operators(comparator equal_to, comparator less)
+    {
+        return details::default_compiled_operators(equal_to, less, false);
+    }
+
+    compiled_operators default_any_compiled_operators()
+    {
+        return details::default_compiled_operators(default_equal_to, default_less, true);
+    }
+
+    compiled_operators default_any_compiled_operators(comparator equal_to, comparator less)
+    {
+        return details::default_compiled_operators(equal_to, less, true);
+    }
+
+    plan compile_query(const web::json::value& query)
+    {
+        return compile_query(query, std::make_shared<const compiled_operators>(default_compiled_operators()));
+    }
+
+    plan compile_query(const web::json::value& query, std::shared_ptr<const compiled_operators> operators)
+    {
+        return compiler{ std::move(operators) }(query);
+    }
 }
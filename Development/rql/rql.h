@@ -2,7 +2,9 @@
 #define RQL_RQL_H
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include "cpprest/json.h"
 
 namespace rql
@@ -39,13 +41,49 @@ namespace rql
     {
         explicit evaluator(extractor extract); // with default call-operators
         evaluator(extractor extract, operators operators);
+        // share a set of call-operators which has been made once, e.g. for a query that is evaluated repeatedly
+        evaluator(extractor extract, std::shared_ptr<const rql::operators> operators);
 
         web::json::value operator()(const web::json::value& arg, bool extract_value = false) const;
 
         extractor extract;
-        rql::operators operators;
+
+        // call-operators are shared so that evaluators for sub-queries, etc. do not need to copy them
+        std::shared_ptr<const rql::operators> shared_operators;
+        const rql::operators& operators;
     };
 
+    // Compile an RQL query once, into a plan which can be evaluated repeatedly, e.g. against many resources
+    // The plan is a tree of closures, with each call-operator already resolved, each property key already split
+    // into a key path (at each '.' in a string, whereas each element of an array is one key), and each value prepared
+
+    typedef std::vector<utility::string_t> key_path;
+
+    key_path make_key_path(const web::json::value& key);
+
+    // a path_extractor is like an extractor, but is given the key path rather than the property key
+    typedef std::function<bool(web::json::value& results, const key_path& key_path)> path_extractor;
+
+    // a plan evaluates a compiled call-operator or value, using a resource property extractor function
+    typedef std::function<web::json::value(const path_extractor& extract)> plan;
+
+    struct compiler;
+
+    typedef std::unordered_map<utility::string_t, std::function<plan(const compiler& compile, const web::json::value& args)>> compiled_operators;
+
+    struct compiler
+    {
+        explicit compiler(std::shared_ptr<const rql::compiled_operators> operators);
+
+        // throws std::runtime_error for an unimplemented call-operator, or web::json::json_exception for invalid args
+        plan operator()(const web::json::value& arg, bool extract_value = false) const;
+
+        std::shared_ptr<const rql::compiled_operators> operators;
+    };
+
+    plan compile_query(const web::json::value& query); // with default call-operators
+    plan compile_query(const web::json::value& query, std::shared_ptr<const compiled_operators> operators);
+
     // Construct a set of RQL call-operators, using default json value comparison
 
     operators default_operators();
@@ -60,6 +98,14 @@ namespace rql
     operators default_operators(comparator equal_to, comparator less);
     operators default_any_operators(comparator equal_to, comparator less); // array-friendly variant
 
+    // Construct a set of compiled RQL call-operators, equivalent to those above
+
+    compiled_operators default_compiled_operators();
+    compiled_operators default_any_compiled_operators(); // array-friendly variant
+
+    compiled_operators default_compiled_operators(comparator equal_to, comparator less);
+    compiled_operators default_any_compiled_operators(comparator equal_to, comparator less); // array-friendly variant
+
     // Helpers for json value comparison, implementing three-valued (tribool) logic
 
     const web::json::value value_indeterminate = web::json::value::null();
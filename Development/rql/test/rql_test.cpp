@@ -1,7 +1,11 @@
 // The first "test" is of course whether the header compiles standalone
 #include "rql/rql.h"
 
+#include <chrono>
+#include <iostream>
 #include "bst/test/test.h"
+#include "cpprest/basic_utils.h" // for utility::ostringstreamed
+#include "cpprest/json_utils.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 BST_TEST_CASE(testRqlParseQuery)
@@ -72,3 +76,131 @@ BST_TEST_CASE(testRqlValidateQuery)
         BST_REQUIRE_THROW(rql::validate_query(rql_query, operators), std::runtime_error);
     }
 }
+
+namespace
+{
+    rql::extractor make_extractor(const web::json::value& value)
+    {
+        return [&value](web::json::value& results, const web::json::value& key)
+        {
+            return web::json::extract(value.as_object(), results, rql::make_key_path(key));
+        };
+    }
+
+    rql::path_extractor make_path_extractor(const web::json::value& value)
+    {
+        return [&value](web::json::value& results, const rql::key_path& key_path)
+        {
+            return web::json::extract(value.as_object(), results, key_path);
+        };
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testRqlMakeKeyPath)
+{
+    const rql::key_path expected{ U("foo"), U("bar"), U("baz") };
+    BST_REQUIRE(expected == rql::make_key_path(web::json::value::string(U("foo.bar.baz"))));
+    BST_REQUIRE(rql::key_path{ U("") } == rql::make_key_path(web::json::value::string(U(""))));
+
+    const auto key_path = rql::make_key_path(rql::parse_query(U("(foo,bar,baz.qux)")));
+    BST_REQUIRE_EQUAL(3, key_path.size());
+    BST_REQUIRE_STRING_EQUAL(U("baz.qux"), key_path.back());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+BST_TEST_CASE(testRqlCompileQuery)
+{
+    using web::json::value_of;
+
+    const auto data = value_of({
+        { U("foo"), 42 },
+        { U("bar"), U("meow") },
+        { U("baz"), value_of({ U("purr"), U("hiss") }) },
+        { U("qux"), value_of({ { U("quux"), value_of({ value_of({ { U("yowl"), 1 } }), value_of({ { U("yowl"), 2 } }) }) } }) },
+        { U("nul"), web::json::value::null() }
+    });
+
+    // each query must give the same result whether it is interpreted or compiled, with either set of call-operators
+    const std::vector<utility::string_t> queries
+    {
+        U("eq(foo,42)"),
+        U("ne(foo,42)"),
+        U("and(gt(foo,41),lt(foo,43),ge(foo,42),le(foo,42))"),
+        U("or(eq(bar,woof),eq(bar,meow))"),
+        U("not(eq(bar,meow))"),
+        U("eq(missing,42)"),
+        U("in(bar,(meow,purr))"),
+        U("out(bar,(meow,purr))"),
+        U("contains(baz,purr)"),
+        U("excludes(baz,purr)"),
+        U("eq(baz,hiss)"),
+        U("ne(baz,hiss)"),
+        U("eq(qux.quux.yowl,2)"),
+        U("gt(qux.quux.yowl,1)"),
+        U("null(nul)"),
+        U("null(missing)"),
+        U("null(get(value(nul)))"),
+        U("matches(bar,^ME,i)"),
+        U("matches(bar,^ME)"),
+        U("matches(baz,^h)"),
+        U("matches(bar,value(^m))"),
+        U("eq(count(baz),2)"),
+        U("eq(get(value(foo)),42)"),
+        U("and(eq(foo,42),or(matches(bar,eow$),null(nul)),not(contains(baz,woof)))"),
+        U("meow")
+    };
+
+    for (const auto& any : { false, true })
+    {
+        const auto operators = std::make_shared<const rql::operators>(any ? rql::default_any_operators() : rql::default_operators());
+        const auto compiled_operators = std::make_shared<const rql::compiled_operators>(any ? rql::default_any_compiled_operators() : rql::default_compiled_operators());
+
+        for (const auto& query_rql : queries)
+        {
+            const auto query = rql::parse_query(query_rql);
+            const auto expected = rql::evaluator{ make_extractor(data), operators }(query);
+            const auto actual = rql::compile_query(query, compiled_operators)(make_path_extractor(data));
+            BST_REQUIRE_EQUAL(expected, actual);
+        }
+    }
+
+    // an invalid pattern is only reported when it is used, like the interpreter
+    {
+        const auto plan = rql::compile_query(rql::parse_query(U("matches(bar,%28)")));
+        BST_REQUIRE_THROW(plan(make_path_extractor(data)), std::runtime_error);
+    }
+
+    // unimplemented call-operators are reported when the query is compiled
+    BST_REQUIRE_THROW(rql::compile_query(rql::parse_query(U("meow()"))), std::runtime_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// repeatedly evaluate a query which uses 'matches' against many values, as the interpreter does for a large registry
+BST_TEST_CASE_PERFORMANCE(testRqlMatchesPerformance)
+{
+    using web::json::value_of;
+
+    const size_t value_count = 10000;
+
+    std::vector<web::json::value> values;
+    for (size_t i = 0; i < value_count; ++i)
+    {
+        values.push_back(value_of({ { U("label"), (0 == i % 2 ? U("cam ") : U("mic ")) + utility::ostringstreamed(i) } }));
+    }
+
+    const auto query = rql::parse_query(U("matches(label,string:CAM.*,i)"));
+    const auto operators = std::make_shared<const rql::operators>(rql::default_any_operators());
+
+    size_t count = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& value : values)
+    {
+        if (rql::value_true == rql::evaluator{ make_extractor(value), operators }(query)) ++count;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - start);
+
+    BST_REQUIRE_EQUAL(value_count / 2, count);
+
+    std::cout << "rql matches, interpreted: " << (size_t)(value_count / elapsed.count()) << " values/s" << std::endl;
+}